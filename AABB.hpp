@@ -0,0 +1,186 @@
+#pragma once
+
+#include <array>
+#include <limits>
+
+#include "Rectangle.hpp"
+
+namespace MathsCPP {
+/**
+ * @brief Holds a N dimensional axis aligned bounding box.
+ * @tparam T The value type.
+ * @tparam N Number of dimensions.
+ */
+template<typename T, std::size_t N>
+class AABB {
+public:
+	constexpr AABB() = default;
+	constexpr AABB(const Vector<T, N> &min, const Vector<T, N> &max) : min(min), max(max) {}
+	template<typename T1>
+	constexpr AABB(const AABB<T1, N> &b) : min(b.min), max(b.max) {}
+	template<typename T1, std::size_t N1 = N, typename = std::enable_if_t<N1 == 2>>
+	constexpr explicit AABB(const Rectangle<T1> &r) : min(r.x, r.y), max(r.x + r.w, r.y + r.h) {}
+
+	/**
+	 * Gets if this box overlaps another box, boxes that only share a face do not overlap.
+	 * @param other The other box.
+	 * @return If the boxes overlap.
+	 */
+	constexpr bool Intersects(const AABB &other) const {
+		bool result = true;
+		for (std::size_t i = 0; i < N; i++)
+			result &= (min[i] < other.max[i]) & (other.min[i] < max[i]);
+		return result;
+	}
+
+	/**
+	 * Gets if a point is inside this box, faces are inclusive.
+	 * @param point The point.
+	 * @return If the point is inside.
+	 */
+	constexpr bool Contains(const Vector<T, N> &point) const {
+		bool result = true;
+		for (std::size_t i = 0; i < N; i++)
+			result &= (min[i] <= point[i]) & (point[i] <= max[i]);
+		return result;
+	}
+
+	/**
+	 * Gets if another box is fully inside this box, faces may touch.
+	 * @param other The other box.
+	 * @return If the other box is inside.
+	 */
+	constexpr bool Contains(const AABB &other) const {
+		bool result = true;
+		for (std::size_t i = 0; i < N; i++)
+			result &= (min[i] <= other.min[i]) & (other.max[i] <= max[i]);
+		return result;
+	}
+
+	/**
+	 * Gets the smallest box that contains this box and another box.
+	 * @param other The other box.
+	 * @return The union.
+	 */
+	constexpr AABB Union(const AABB &other) const {
+		return {min.Min(other.min), max.Max(other.max)};
+	}
+
+	/**
+	 * Gets the smallest box that contains this box and a point.
+	 * @param point The point.
+	 * @return The expanded box.
+	 */
+	constexpr AABB Union(const Vector<T, N> &point) const {
+		return {min.Min(point), max.Max(point)};
+	}
+
+	constexpr Vector<T, N> GetCenter() const { return (min + max) / 2; }
+	constexpr Vector<T, N> GetSize() const { return max - min; }
+
+	/**
+	 * Gets the surface area of this box, or the perimeter in two dimensions.
+	 * @return The surface area.
+	 */
+	template<std::size_t N1 = N, typename = std::enable_if_t<N1 == 2 || N1 == 3>>
+	constexpr T GetSurfaceArea() const {
+		auto size = GetSize();
+		if constexpr (N == 2) {
+			return 2 * (size[0] + size[1]);
+		} else {
+			return 2 * (size[0] * size[1] + size[1] * size[2] + size[2] * size[0]);
+		}
+	}
+
+	template<typename T1>
+	constexpr friend auto operator==(const AABB &lhs, const AABB<T1, N> &rhs) {
+		return lhs.min == rhs.min && lhs.max == rhs.max;
+	}
+
+	template<typename T1>
+	constexpr friend auto operator!=(const AABB &lhs, const AABB<T1, N> &rhs) {
+		return !(lhs == rhs);
+	}
+
+	friend std::ostream &operator<<(std::ostream &stream, const AABB &box) {
+		return stream << box.min << " -> " << box.max;
+	}
+
+	/// A box with min at the highest value and max at the lowest, any union with it gives the other value.
+	static const AABB Empty;
+
+	Vector<T, N> min;
+	Vector<T, N> max;
+};
+
+template<typename T, std::size_t N>
+const AABB<T, N> AABB<T, N>::Empty = AABB<T, N>(Vector<T, N>(std::numeric_limits<T>::max()), Vector<T, N>(std::numeric_limits<T>::lowest()));
+
+/**
+ * @brief Holds many N dimensional boxes with each bound on each axis in its own array, so tests across them vectorize.
+ * @tparam T The value type.
+ * @tparam N Number of dimensions.
+ */
+template<typename T, std::size_t N>
+class AABBArray {
+public:
+	AABBArray() = default;
+	explicit AABBArray(Span<const AABB<T, N>> boxes) {
+		Reserve(boxes.size());
+		for (const auto &box : boxes)
+			Add(box);
+	}
+
+	void Add(const AABB<T, N> &box) {
+		for (std::size_t i = 0; i < N; i++) {
+			min[i].emplace_back(box.min[i]);
+			max[i].emplace_back(box.max[i]);
+		}
+	}
+
+	void Set(std::size_t index, const AABB<T, N> &box) {
+		for (std::size_t i = 0; i < N; i++) {
+			min[i][index] = box.min[i];
+			max[i][index] = box.max[i];
+		}
+	}
+
+	AABB<T, N> Get(std::size_t index) const {
+		AABB<T, N> box;
+		for (std::size_t i = 0; i < N; i++) {
+			box.min[i] = min[i][index];
+			box.max[i] = max[i][index];
+		}
+		return box;
+	}
+
+	void Reserve(std::size_t size) {
+		for (std::size_t i = 0; i < N; i++)
+			min[i].reserve(size), max[i].reserve(size);
+	}
+
+	void Clear() {
+		for (std::size_t i = 0; i < N; i++)
+			min[i].clear(), max[i].clear();
+	}
+
+	std::size_t size() const { return min[0].size(); }
+	std::size_t GetMaskSize() const { return (size() + 63) / 64; }
+
+	/// The min and max bound of every box along each axis.
+	std::array<std::vector<T>, N> min;
+	std::array<std::vector<T>, N> max;
+};
+
+using AABB2f = AABB<float, 2>;
+using AABB2d = AABB<double, 2>;
+using AABB2i = AABB<int32_t, 2>;
+
+using AABB3f = AABB<float, 3>;
+using AABB3d = AABB<double, 3>;
+using AABB3i = AABB<int32_t, 3>;
+
+using AABBArray2f = AABBArray<float, 2>;
+using AABBArray3f = AABBArray<float, 3>;
+using AABBArray3d = AABBArray<double, 3>;
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "Quaternion.hpp"
+
+namespace MathsCPP {
+/**
+ * @brief An affine transform stored as the top three rows of a 4x4 matrix, the bottom row is always 0, 0, 0, 1 and is not stored.
+ * Rows are laid out as in Matrix<T, 4, 4> and transform column vectors, the translation is the last column.
+ * @tparam T The value type.
+ */
+template<typename T>
+class AffineMatrix {
+public:
+	constexpr AffineMatrix() = default;
+	constexpr AffineMatrix(const Vector<T, 4> &row0, const Vector<T, 4> &row1, const Vector<T, 4> &row2) : data{row0, row1, row2} {}
+	/**
+	 * Creates an affine transform from a 4x4 matrix, the bottom row is dropped and assumed to be 0, 0, 0, 1.
+	 * @param m The matrix.
+	 */
+	template<typename T1>
+	constexpr explicit AffineMatrix(const Matrix<T1, 4, 4> &m) : data{Vector<T, 4>(m[0]), Vector<T, 4>(m[1]), Vector<T, 4>(m[2])} {}
+	template<typename T1>
+	constexpr explicit AffineMatrix(const AffineMatrix<T1> &m) : data{Vector<T, 4>(m[0]), Vector<T, 4>(m[1]), Vector<T, 4>(m[2])} {}
+
+	constexpr const auto &at(std::size_t i) const { return data[i]; }
+	constexpr auto &at(std::size_t i) { return data[i]; }
+
+	constexpr const auto &operator[](std::size_t i) const { return at(i); }
+	constexpr auto &operator[](std::size_t i) { return at(i); }
+
+	auto begin() { return &at(0); }
+	auto begin() const { return &at(0); }
+
+	auto end() { return &at(0) + 3; }
+	auto end() const { return &at(0) + 3; }
+
+	/**
+	 * Creates the transform that scales, then rotates, then translates.
+	 * @param translation The translation.
+	 * @param rotation The rotation, must be normalized.
+	 * @param scale The scale.
+	 * @return The transform.
+	 */
+	static AffineMatrix FromTRS(const Vector<T, 3> &translation, const Quaternion<T> &rotation, const Vector<T, 3> &scale = Vector<T, 3>(1)) {
+		AffineMatrix result;
+		Detail::ComposeTRS(translation.x, translation.y, translation.z, rotation.x, rotation.y, rotation.z, rotation.w, scale.x, scale.y, scale.z,
+			&result[0][0], 1);
+		return result;
+	}
+
+	constexpr Vector<T, 3> GetTranslation() const { return {data[0][3], data[1][3], data[2][3]}; }
+	constexpr void SetTranslation(const Vector<T, 3> &translation) {
+		for (std::size_t j = 0; j < 3; j++)
+			data[j][3] = translation[j];
+	}
+
+	/**
+	 * Gets the rotation, scale and shear part of this transform.
+	 * @return The upper 3x3 matrix.
+	 */
+	constexpr Matrix<T, 3, 3> GetLinear() const {
+		Matrix<T, 3, 3> result;
+		for (std::size_t j = 0; j < 3; j++) {
+			for (std::size_t i = 0; i < 3; i++)
+				result[j][i] = data[j][i];
+		}
+		return result;
+	}
+
+	/**
+	 * Converts this transform to a 4x4 matrix, adding the bottom row.
+	 * @return The matrix.
+	 */
+	constexpr Matrix<T, 4, 4> ToMatrix() const {
+		return {data[0], data[1], data[2], Vector<T, 4>(0, 0, 0, 1)};
+	}
+
+	/**
+	 * Takes the determinant of this transform, which is that of the upper 3x3 matrix.
+	 * @return The determinant.
+	 */
+	constexpr T Determinant() const {
+		return data[0][0] * (data[1][1] * data[2][2] - data[1][2] * data[2][1]) +
+			data[0][1] * (data[1][2] * data[2][0] - data[1][0] * data[2][2]) +
+			data[0][2] * (data[1][0] * data[2][1] - data[1][1] * data[2][0]);
+	}
+
+	/**
+	 * Inverses this transform, the upper 3x3 matrix is inverted from its cofactors and the translation is moved back through it.
+	 * Like Matrix::Inverse the result is not finite when the determinant is zero.
+	 * @return The inverse transform.
+	 */
+	constexpr AffineMatrix Inverse() const {
+		// The columns of the inverse are the cross products of pairs of rows, over the determinant.
+		AffineMatrix result;
+		for (std::size_t i = 0; i < 3; i++) {
+			const auto &a = data[(i + 1) % 3], &b = data[(i + 2) % 3];
+			result[0][i] = a[1] * b[2] - a[2] * b[1];
+			result[1][i] = a[2] * b[0] - a[0] * b[2];
+			result[2][i] = a[0] * b[1] - a[1] * b[0];
+		}
+		auto inverseDeterminant = 1 / (data[0][0] * result[0][0] + data[0][1] * result[1][0] + data[0][2] * result[2][0]);
+		for (std::size_t j = 0; j < 3; j++) {
+			for (std::size_t i = 0; i < 3; i++)
+				result[j][i] *= inverseDeterminant;
+			result[j][3] = -(result[j][0] * data[0][3] + result[j][1] * data[1][3] + result[j][2] * data[2][3]);
+		}
+		return result;
+	}
+
+	/**
+	 * Inverses a rigid transform by transposing the rotation and moving the translation back through it.
+	 * @return The inverse transform, only correct when the upper 3x3 matrix is a rotation.
+	 */
+	constexpr AffineMatrix RigidInverse() const {
+		AffineMatrix result;
+		for (std::size_t j = 0; j < 3; j++) {
+			for (std::size_t i = 0; i < 3; i++)
+				result[j][i] = data[i][j];
+			result[j][3] = -(data[0][j] * data[0][3] + data[1][j] * data[1][3] + data[2][j] * data[2][3]);
+		}
+		return result;
+	}
+
+	/**
+	 * Transforms a direction, the translation is ignored.
+	 * @param direction The direction.
+	 * @return The transformed direction.
+	 */
+	template<typename T1>
+	constexpr auto TransformDirection(const Vector<T1, 3> &direction) const {
+		Vector<decltype(data[0][0] * direction[0]), 3> result;
+		for (std::size_t j = 0; j < 3; j++)
+			result[j] = data[j][0] * direction[0] + data[j][1] * direction[1] + data[j][2] * direction[2];
+		return result;
+	}
+
+	/**
+	 * Transforms many points, as operator* does for one.
+	 * @param points The points.
+	 * @param results The transformed points, the same size as points, it may be the same memory.
+	 */
+	void TransformPoints(Span<const Vector<T, 3>> points, Span<Vector<T, 3>> results) const {
+		// A local copy, the stores could otherwise alias this and force the matrix to be reloaded for every point.
+		Parallel::For(0, points.size(), BatchGrain, [&, matrix = *this](std::size_t begin, std::size_t end) {
+			for (auto i = begin; i < end; i++)
+				results[i] = matrix * points[i];
+		});
+	}
+
+	/**
+	 * Transforms many directions, as TransformDirection does for one.
+	 * @param directions The directions.
+	 * @param results The transformed directions, the same size as directions, it may be the same memory.
+	 */
+	void TransformDirections(Span<const Vector<T, 3>> directions, Span<Vector<T, 3>> results) const {
+		Parallel::For(0, directions.size(), BatchGrain, [&, matrix = *this](std::size_t begin, std::size_t end) {
+			for (auto i = begin; i < end; i++)
+				results[i] = matrix.TransformDirection(directions[i]);
+		});
+	}
+
+	/**
+	 * Inverses many transforms, as Inverse does for one.
+	 * @param matrices The transforms.
+	 * @param results The inverse transforms, the same size as matrices, it may be the same memory.
+	 */
+	static void Inverse(Span<const AffineMatrix> matrices, Span<AffineMatrix> results) {
+		Parallel::For(0, matrices.size(), BatchGrain, [&](std::size_t begin, std::size_t end) {
+			for (auto i = begin; i < end; i++)
+				results[i] = matrices[i].Inverse();
+		});
+	}
+
+	template<typename T1>
+	constexpr friend auto operator==(const AffineMatrix &lhs, const AffineMatrix<T1> &rhs) {
+		return lhs[0] == rhs[0] && lhs[1] == rhs[1] && lhs[2] == rhs[2];
+	}
+
+	template<typename T1>
+	constexpr friend auto operator!=(const AffineMatrix &lhs, const AffineMatrix<T1> &rhs) {
+		return !(lhs == rhs);
+	}
+
+	/// Composes two transforms, the right transform is applied first.
+	template<typename T1>
+	constexpr friend auto operator*(const AffineMatrix &lhs, const AffineMatrix<T1> &rhs) {
+		AffineMatrix<decltype(lhs[0][0] * rhs[0][0])> result;
+		for (std::size_t j = 0; j < 3; j++) {
+			for (std::size_t i = 0; i < 4; i++)
+				result[j][i] = lhs[j][0] * rhs[0][i] + lhs[j][1] * rhs[1][i] + lhs[j][2] * rhs[2][i];
+			result[j][3] += lhs[j][3];
+		}
+		return result;
+	}
+
+	/// Transforms a point, applying the translation.
+	template<typename T1>
+	constexpr friend auto operator*(const AffineMatrix &lhs, const Vector<T1, 3> &rhs) {
+		Vector<decltype(lhs[0][0] * rhs[0]), 3> result;
+		for (std::size_t j = 0; j < 3; j++)
+			result[j] = lhs[j][0] * rhs[0] + lhs[j][1] * rhs[1] + lhs[j][2] * rhs[2] + lhs[j][3];
+		return result;
+	}
+
+	template<typename T1>
+	constexpr friend auto operator*=(AffineMatrix &lhs, const AffineMatrix<T1> &rhs) {
+		return lhs = lhs * rhs;
+	}
+
+	friend std::ostream &operator<<(std::ostream &stream, const AffineMatrix &matrix) {
+		return stream << matrix[0] << "\n" << matrix[1] << "\n" << matrix[2];
+	}
+
+	static const AffineMatrix Identity;
+
+	Vector<T, 4> data[3] = {{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}};
+
+private:
+	static constexpr std::size_t BatchGrain = 1 << 14;
+};
+
+template<typename T>
+struct ArrayTraits<AffineMatrix<T>> {
+	using Value = T;
+	static constexpr std::size_t Count = 12;
+};
+
+template<typename T>
+const AffineMatrix<T> AffineMatrix<T>::Identity = AffineMatrix<T>();
+
+using AffineMatrixf = AffineMatrix<float>;
+using AffineMatrixd = AffineMatrix<double>;
+}
@@ -0,0 +1,618 @@
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+#include "Frustum.hpp"
+#include "Parallel.hpp"
+#include "Ray.hpp"
+
+namespace MathsCPP {
+template<typename T>
+class MeshBVH;
+
+/**
+ * @brief A bounding volume hierarchy over axis aligned boxes, for ray casts and overlap queries against many static primitives.
+ * The tree is built top down with a binned surface area heuristic and flattened into one array where the two children of a
+ * node sit next to each other, so a traversal step reads both child boxes from the same cache line.
+ * @tparam T The value type.
+ */
+template<typename T>
+class BVH {
+	static_assert(std::is_floating_point_v<T>, "BVH requires a floating point type");
+	template<typename> friend class MeshBVH;
+public:
+	struct Node {
+		AABB<T, 3> bounds;
+		/// For inner nodes the first of the two children, for leaves the first primitive in leaf order.
+		uint32_t first = 0;
+		/// The number of primitives in a leaf, zero for inner nodes.
+		uint16_t count = 0;
+		/// The axis an inner node was split on, packets use it to visit the nearer child first.
+		uint16_t axis = 0;
+
+		constexpr bool IsLeaf() const { return count != 0; }
+	};
+
+	BVH() = default;
+	explicit BVH(Span<const AABB<T, 3>> bounds, uint32_t maxLeafSize = 4) { Build(bounds, maxLeafSize); }
+
+	/**
+	 * Builds the tree, replacing any previous one. The top levels are split first, then the subtrees below them are built concurrently.
+	 * @param bounds The bounds of each primitive, primitives are reported by their index in this span.
+	 * @param maxLeafSize The most primitives in one leaf, from 1 to 255.
+	 */
+	void Build(Span<const AABB<T, 3>> bounds, uint32_t maxLeafSize = 4) {
+		nodes.clear();
+		boxes.clear();
+		primitives.resize(bounds.size());
+		std::iota(primitives.begin(), primitives.end(), 0);
+		if (bounds.empty())
+			return;
+
+		auto count = static_cast<uint32_t>(bounds.size());
+		Builder builder{bounds, std::vector<Vector<T, 3>>(count), std::clamp<uint32_t>(maxLeafSize, 1, 255), primitives.data()};
+		for (uint32_t i = 0; i < count; i++)
+			builder.centroids[i] = bounds[i].GetCenter();
+
+		auto taskSize = std::max<uint32_t>(count / static_cast<uint32_t>(Parallel::GetThreadCount() * 8), ParallelGrain);
+		std::vector<Task> tasks;
+		nodes.emplace_back();
+		builder.Split(nodes, 0, 0, count, 0, count > taskSize ? &tasks : nullptr, taskSize);
+
+		std::vector<std::vector<Node>> subtrees(tasks.size());
+		Parallel::For(0, tasks.size(), 1, [&](std::size_t begin, std::size_t end) {
+			for (auto i = begin; i < end; i++) {
+				subtrees[i].emplace_back();
+				builder.Split(subtrees[i], 0, tasks[i].begin, tasks[i].end, tasks[i].depth, nullptr, 0);
+			}
+		});
+		for (std::size_t i = 0; i < tasks.size(); i++) {
+			// A subtree root replaces its placeholder and the rest is appended, so child indices move by the appended offset.
+			auto offset = static_cast<uint32_t>(nodes.size() - 1);
+			auto &subtree = subtrees[i];
+			for (auto &node : subtree) {
+				if (!node.IsLeaf())
+					node.first += offset;
+			}
+			nodes[tasks[i].node] = subtree[0];
+			nodes.insert(nodes.end(), subtree.begin() + 1, subtree.end());
+		}
+
+		boxes.resize(count);
+		for (uint32_t i = 0; i < count; i++)
+			boxes[i] = bounds[primitives[i]];
+	}
+
+	/**
+	 * Calls a function for every primitive overlapping a box.
+	 * @tparam Func Invocable as func(primitive).
+	 * @param box The box.
+	 * @param func The function.
+	 */
+	template<typename Func>
+	void Query(const AABB<T, 3> &box, Func &&func) const {
+		if (nodes.empty())
+			return;
+		uint32_t stack[StackSize];
+		std::size_t size = 0;
+		stack[size++] = 0;
+		while (size > 0) {
+			const auto &node = nodes[stack[--size]];
+			if (!node.bounds.Intersects(box))
+				continue;
+			if (node.IsLeaf()) {
+				for (auto i = node.first; i < node.first + node.count; i++) {
+					if (boxes[i].Intersects(box))
+						func(primitives[i]);
+				}
+				continue;
+			}
+			stack[size++] = node.first + 1;
+			stack[size++] = node.first;
+		}
+	}
+
+	/**
+	 * Calls a function for every primitive that may be inside a frustum. Planes a node is fully inside are not tested again
+	 * below it, so subtrees fully inside the frustum are reported without any plane tests.
+	 * @tparam Func Invocable as func(primitive).
+	 * @param frustum The frustum.
+	 * @param func The function.
+	 */
+	template<typename Func>
+	void Query(const Frustum<T> &frustum, Func &&func) const {
+		if (nodes.empty())
+			return;
+		struct Entry {
+			uint32_t node, planes;
+		};
+		Entry stack[StackSize];
+		std::size_t size = 0;
+		stack[size++] = {0, AllPlanes};
+		while (size > 0) {
+			auto entry = stack[--size];
+			const auto &node = nodes[entry.node];
+			auto planes = Cull(frustum, node.bounds, entry.planes);
+			if (planes == Outside)
+				continue;
+			if (node.IsLeaf()) {
+				for (auto i = node.first; i < node.first + node.count; i++) {
+					if (Cull(frustum, boxes[i], planes) != Outside)
+						func(primitives[i]);
+				}
+				continue;
+			}
+			stack[size++] = {node.first + 1, planes};
+			stack[size++] = {node.first, planes};
+		}
+	}
+
+	/**
+	 * Casts a ray, visiting nodes nearest first and skipping any that start beyond the closest hit so far.
+	 * @tparam Func Invocable as func(primitive, ray) returning if the primitive was hit, a hit should lower ray.tMax to its distance.
+	 * @param ray The ray, tMax is left at whatever the function lowered it to.
+	 * @param func The function.
+	 * @return If any primitive was hit.
+	 */
+	template<typename Func>
+	bool Raycast(Ray<T> &ray, Func &&func) const {
+		return TraverseRay(ray, [&](uint32_t first, uint32_t count, Ray<T> &ray) {
+			auto hit = false;
+			for (auto i = first; i < first + count; i++)
+				hit |= func(primitives[i], ray);
+			return hit;
+		});
+	}
+
+	/**
+	 * Casts a packet of rays together, a node is visited when any ray in the packet hits it.
+	 * @tparam K Number of rays in the packet.
+	 * @tparam Func Invocable as func(primitive, packet, laneMask) where bit k of laneMask is set for rays that hit the leaf,
+	 * hits should lower the tMax of their lane.
+	 * @param packet The packet.
+	 * @param func The function.
+	 */
+	template<std::size_t K, typename Func>
+	void Raycast(RayPacket<T, K> &packet, Func &&func) const {
+		TraversePacket(packet, [&](uint32_t first, uint32_t count, RayPacket<T, K> &packet, uint32_t mask) {
+			for (auto i = first; i < first + count; i++)
+				func(primitives[i], packet, mask);
+		});
+	}
+
+	AABB<T, 3> GetBounds() const { return nodes.empty() ? AABB<T, 3>::Empty : nodes[0].bounds; }
+	const std::vector<Node> &GetNodes() const { return nodes; }
+	/// Primitive indices in leaf order, leaves index into this.
+	const std::vector<uint32_t> &GetPrimitives() const { return primitives; }
+
+private:
+	static constexpr uint32_t BinCount = 16;
+	/// The cost of visiting a node relative to testing one primitive.
+	static constexpr T TraversalCost = 1;
+	/// Past this depth splits fall back to the median, so the depth and stack size stay bounded on pathological inputs.
+	static constexpr uint32_t MaxSahDepth = 48;
+	static constexpr std::size_t StackSize = 128;
+	/// The fewest primitives worth building as a separate task.
+	static constexpr uint32_t ParallelGrain = 4096;
+	static constexpr uint32_t NoAxis = 3;
+	static constexpr uint32_t AllPlanes = 0x3f;
+	static constexpr uint32_t Outside = ~uint32_t(0);
+
+	struct Task {
+		uint32_t node, begin, end, depth;
+	};
+
+	struct Bin {
+		AABB<T, 3> bounds = AABB<T, 3>::Empty;
+		uint32_t count = 0;
+	};
+
+	struct SplitPlane {
+		uint32_t axis = NoAxis;
+		/// Primitives with centroids in bins below this go to the first child.
+		uint32_t bin = 0;
+		T cost = std::numeric_limits<T>::infinity();
+	};
+
+	struct Builder {
+		static uint32_t BinIndex(T centroid, T min, T scale) {
+			return std::min(BinCount - 1, static_cast<uint32_t>((centroid - min) * scale));
+		}
+
+		/**
+		 * Finds the cheapest bin boundary to split a node at, on any axis.
+		 */
+		SplitPlane FindSplit(uint32_t begin, uint32_t end, const AABB<T, 3> &nodeBounds, const AABB<T, 3> &centroidBounds) const {
+			SplitPlane best;
+			auto area = nodeBounds.GetSurfaceArea();
+			auto invArea = area > 0 ? 1 / area : T(0);
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				auto min = centroidBounds.min[axis], extent = centroidBounds.max[axis] - min;
+				if (!(extent > 0))
+					continue;
+				auto scale = BinCount / extent;
+
+				Bin bins[BinCount];
+				for (auto i = begin; i < end; i++) {
+					auto &bin = bins[BinIndex(centroids[primitives[i]][axis], min, scale)];
+					bin.bounds = bin.bounds.Union(bounds[primitives[i]]);
+					bin.count++;
+				}
+
+				// Sweep from the right for the cost above each boundary, then from the left to total each split.
+				T rightCost[BinCount];
+				auto box = AABB<T, 3>::Empty;
+				uint32_t count = 0;
+				for (auto b = BinCount - 1; b > 0; b--) {
+					box = box.Union(bins[b].bounds);
+					count += bins[b].count;
+					rightCost[b] = count > 0 ? box.GetSurfaceArea() * count : T(0);
+				}
+				box = AABB<T, 3>::Empty;
+				count = 0;
+				for (uint32_t b = 0; b + 1 < BinCount; b++) {
+					box = box.Union(bins[b].bounds);
+					count += bins[b].count;
+					if (count == 0 || count == end - begin)
+						continue;
+					auto cost = TraversalCost + (box.GetSurfaceArea() * count + rightCost[b + 1]) * invArea;
+					if (cost < best.cost)
+						best = {axis, b + 1, cost};
+				}
+			}
+			return best;
+		}
+
+		/**
+		 * Splits a node, recursing into its children or queueing them as tasks once they are small enough.
+		 */
+		void Split(std::vector<Node> &out, uint32_t index, uint32_t begin, uint32_t end, uint32_t depth, std::vector<Task> *tasks, uint32_t taskSize) const {
+			auto nodeBounds = AABB<T, 3>::Empty, centroidBounds = AABB<T, 3>::Empty;
+			for (auto i = begin; i < end; i++) {
+				nodeBounds = nodeBounds.Union(bounds[primitives[i]]);
+				centroidBounds = centroidBounds.Union(centroids[primitives[i]]);
+			}
+			out[index].bounds = nodeBounds;
+
+			// A leaf costs one test per primitive, a split costs a node visit plus each child weighted by its share of the area.
+			auto count = end - begin;
+			auto split = count > 1 ? FindSplit(begin, end, nodeBounds, centroidBounds) : SplitPlane();
+			if (count <= maxLeafSize && !(split.cost < static_cast<T>(count))) {
+				out[index].first = begin;
+				out[index].count = static_cast<uint16_t>(count);
+				return;
+			}
+
+			auto axis = split.axis;
+			auto middle = begin;
+			if (axis != NoAxis && depth < MaxSahDepth) {
+				auto min = centroidBounds.min[axis], scale = BinCount / (centroidBounds.max[axis] - min);
+				middle = static_cast<uint32_t>(std::partition(primitives + begin, primitives + end, [&](uint32_t primitive) {
+					return BinIndex(centroids[primitive][axis], min, scale) < split.bin;
+				}) - primitives);
+			}
+			if (middle == begin || middle == end) {
+				// No usable split, the centroids are all equal or the tree is already deep, so halve the primitives along the widest axis.
+				auto extent = centroidBounds.GetSize();
+				axis = extent[0] >= extent[1] && extent[0] >= extent[2] ? 0 : extent[1] >= extent[2] ? 1 : 2;
+				middle = begin + count / 2;
+				std::nth_element(primitives + begin, primitives + middle, primitives + end, [&](uint32_t a, uint32_t b) {
+					return centroids[a][axis] < centroids[b][axis];
+				});
+			}
+
+			auto child = static_cast<uint32_t>(out.size());
+			out.resize(out.size() + 2);
+			out[index].first = child;
+			out[index].axis = static_cast<uint16_t>(axis);
+			for (auto [node, first, last] : {std::make_tuple(child, begin, middle), std::make_tuple(child + 1, middle, end)}) {
+				if (tasks && last - first <= taskSize)
+					tasks->push_back({node, first, last, depth + 1});
+				else
+					Split(out, node, first, last, depth + 1, tasks, taskSize);
+			}
+		}
+
+		Span<const AABB<T, 3>> bounds;
+		std::vector<Vector<T, 3>> centroids;
+		uint32_t maxLeafSize;
+		uint32_t *primitives;
+	};
+
+	/**
+	 * Tests a box against the planes in a mask.
+	 * @return The planes the box straddles, or Outside if it is fully outside any of them.
+	 */
+	static uint32_t Cull(const Frustum<T> &frustum, const AABB<T, 3> &box, uint32_t planes) {
+		for (auto mask = planes; mask != 0; mask &= mask - 1) {
+			auto i = Maths::CountTrailingZeros(mask);
+			auto side = static_cast<typename Frustum<T>::Side>(i);
+			if (frustum.Distance(side, Frustum<T>::PositiveVertex(frustum.planes[i], box)) < 0)
+				return Outside;
+			if (frustum.Distance(side, Frustum<T>::NegativeVertex(frustum.planes[i], box)) >= 0)
+				planes &= ~(1u << i);
+		}
+		return planes;
+	}
+
+	/**
+	 * Slab test, a ray starting on a slab with no direction along its axis is treated as inside the slab.
+	 */
+	static bool IntersectBox(const AABB<T, 3> &box, const Ray<T> &ray, const Vector<T, 3> &invDirection, T &tNear) {
+		auto tMin = ray.tMin, tMax = ray.tMax;
+		for (std::size_t i = 0; i < 3; i++) {
+			auto t0 = (box.min[i] - ray.origin[i]) * invDirection[i];
+			auto t1 = (box.max[i] - ray.origin[i]) * invDirection[i];
+			tMin = std::max(tMin, std::min(t0, t1));
+			tMax = std::min(tMax, std::max(t0, t1));
+		}
+		tNear = tMin;
+		return tMin <= tMax;
+	}
+
+	template<std::size_t K>
+	static uint32_t IntersectBox(const AABB<T, 3> &box, const RayPacket<T, K> &packet, const T (&invDirection)[3][K]) {
+		bool hit[K];
+		for (std::size_t k = 0; k < K; k++) {
+			auto tMin = packet.tMin[k], tMax = packet.tMax[k];
+			for (std::size_t i = 0; i < 3; i++) {
+				auto t0 = (box.min[i] - packet.origin[i][k]) * invDirection[i][k];
+				auto t1 = (box.max[i] - packet.origin[i][k]) * invDirection[i][k];
+				tMin = std::max(tMin, std::min(t0, t1));
+				tMax = std::min(tMax, std::max(t0, t1));
+			}
+			hit[k] = tMin <= tMax;
+		}
+		uint32_t mask = 0;
+		for (std::size_t k = 0; k < K; k++)
+			mask |= static_cast<uint32_t>(hit[k]) << k;
+		return mask;
+	}
+
+	/**
+	 * Walks the leaves a ray hits nearest first.
+	 * @tparam Func Invocable as func(first, count, ray) returning if anything in the leaf was hit.
+	 */
+	template<typename Func>
+	bool TraverseRay(Ray<T> &ray, Func &&leaf) const {
+		if (nodes.empty())
+			return false;
+		auto invDirection = T(1) / ray.direction;
+		struct Entry {
+			uint32_t node;
+			T tNear;
+		};
+		Entry stack[StackSize];
+		std::size_t size = 0;
+		T tNear;
+		if (!IntersectBox(nodes[0].bounds, ray, invDirection, tNear))
+			return false;
+		stack[size++] = {0, tNear};
+
+		auto hit = false;
+		while (size > 0) {
+			auto entry = stack[--size];
+			if (entry.tNear > ray.tMax)
+				continue;
+			auto index = entry.node;
+			while (!nodes[index].IsLeaf()) {
+				auto a = nodes[index].first, b = a + 1;
+				T t0, t1;
+				auto hit0 = IntersectBox(nodes[a].bounds, ray, invDirection, t0);
+				auto hit1 = IntersectBox(nodes[b].bounds, ray, invDirection, t1);
+				if (hit0 && hit1) {
+					if (t1 < t0) {
+						std::swap(a, b);
+						std::swap(t0, t1);
+					}
+					stack[size++] = {b, t1};
+					index = a;
+				} else if (hit0 || hit1) {
+					index = hit0 ? a : b;
+				} else {
+					index = Outside;
+					break;
+				}
+			}
+			if (index != Outside)
+				hit |= leaf(nodes[index].first, nodes[index].count, ray);
+		}
+		return hit;
+	}
+
+	/**
+	 * Walks the leaves any ray in a packet hits, ordered by the direction of the first ray still hitting.
+	 * @tparam Func Invocable as func(first, count, packet, laneMask).
+	 */
+	template<std::size_t K, typename Func>
+	void TraversePacket(RayPacket<T, K> &packet, Func &&leaf) const {
+		static_assert(K <= 32, "Packets are limited to 32 rays");
+		if (nodes.empty())
+			return;
+		T invDirection[3][K];
+		for (std::size_t i = 0; i < 3; i++) {
+			for (std::size_t k = 0; k < K; k++)
+				invDirection[i][k] = 1 / packet.direction[i][k];
+		}
+		uint32_t stack[StackSize];
+		std::size_t size = 0;
+		stack[size++] = 0;
+		while (size > 0) {
+			const auto &node = nodes[stack[--size]];
+			auto mask = IntersectBox(node.bounds, packet, invDirection);
+			if (mask == 0)
+				continue;
+			if (node.IsLeaf()) {
+				leaf(node.first, node.count, packet, mask);
+				continue;
+			}
+			auto backwards = static_cast<uint32_t>(packet.direction[node.axis][Maths::CountTrailingZeros(mask)] < 0);
+			stack[size++] = node.first + 1 - backwards;
+			stack[size++] = node.first + backwards;
+		}
+	}
+
+	std::vector<Node> nodes;
+	/// Primitive indices in leaf order.
+	std::vector<uint32_t> primitives;
+	/// Primitive bounds in leaf order, so queries can reject single primitives in a leaf.
+	std::vector<AABB<T, 3>> boxes;
+};
+
+/**
+ * @brief A bounding volume hierarchy over a triangle mesh, for closest hit ray casts.
+ * Triangles are stored in leaf order with their edges precomputed, so each leaf reads one contiguous block.
+ * @tparam T The value type.
+ */
+template<typename T>
+class MeshBVH {
+public:
+	static constexpr uint32_t Invalid = ~uint32_t(0);
+
+	struct Hit {
+		uint32_t triangle = Invalid;
+		T t = 0;
+		/// Barycentric weights of the second and third vertices.
+		T u = 0, v = 0;
+	};
+
+	template<std::size_t K>
+	struct PacketHit {
+		/// The triangle hit by each ray, Invalid for rays that hit nothing.
+		uint32_t triangle[K];
+		T t[K], u[K], v[K];
+	};
+
+	MeshBVH() = default;
+	explicit MeshBVH(Span<const Vector<T, 3>> vertices, uint32_t maxLeafSize = 4) { Build(vertices, maxLeafSize); }
+
+	/**
+	 * Builds the tree, replacing any previous one.
+	 * @param vertices Three vertices per triangle, triangles are reported by their index in this span divided by three.
+	 * @param maxLeafSize The most triangles in one leaf.
+	 */
+	void Build(Span<const Vector<T, 3>> vertices, uint32_t maxLeafSize = 4) {
+		auto count = vertices.size() / 3;
+		std::vector<AABB<T, 3>> bounds(count);
+		for (std::size_t i = 0; i < count; i++)
+			bounds[i] = AABB<T, 3>(vertices[3 * i], vertices[3 * i]).Union(vertices[3 * i + 1]).Union(vertices[3 * i + 2]);
+		bvh.Build(bounds, maxLeafSize);
+
+		triangles.resize(count);
+		for (std::size_t i = 0; i < count; i++) {
+			const auto *v = &vertices[3 * bvh.primitives[i]];
+			triangles[i] = {v[0], v[1] - v[0], v[2] - v[0]};
+		}
+	}
+
+	/**
+	 * Finds the closest triangle a ray hits, triangles are double sided.
+	 * @param ray The ray.
+	 * @return The hit, or nothing if the ray hits no triangle in its range.
+	 */
+	std::optional<Hit> Raycast(const Ray<T> &ray) const {
+		auto r = ray;
+		Hit hit;
+		bvh.TraverseRay(r, [&](uint32_t first, uint32_t count, Ray<T> &r) {
+			auto found = false;
+			for (auto i = first; i < first + count; i++) {
+				T t, u, v;
+				if (Intersect(triangles[i], r, t, u, v)) {
+					r.tMax = t;
+					hit = {bvh.primitives[i], t, u, v};
+					found = true;
+				}
+			}
+			return found;
+		});
+		if (hit.triangle == Invalid)
+			return std::nullopt;
+		return hit;
+	}
+
+	/**
+	 * Finds the closest triangle each ray in a packet hits, every lane is tested against a leaf at once.
+	 * @tparam K Number of rays in the packet.
+	 * @param packet The packet.
+	 * @return The hits for each lane.
+	 */
+	template<std::size_t K>
+	PacketHit<K> Raycast(const RayPacket<T, K> &packet) const {
+		PacketHit<K> hits;
+		for (std::size_t k = 0; k < K; k++) {
+			hits.triangle[k] = Invalid;
+			hits.t[k] = hits.u[k] = hits.v[k] = 0;
+		}
+		auto rays = packet;
+		bvh.TraversePacket(rays, [&](uint32_t first, uint32_t count, RayPacket<T, K> &rays, uint32_t) {
+			for (auto i = first; i < first + count; i++)
+				Intersect(triangles[i], bvh.primitives[i], rays, hits);
+		});
+		return hits;
+	}
+
+	const BVH<T> &GetBVH() const { return bvh; }
+	std::size_t GetTriangleCount() const { return triangles.size(); }
+
+private:
+	struct Triangle {
+		Vector<T, 3> v0, e1, e2;
+	};
+
+	/**
+	 * Möller-Trumbore ray triangle intersection.
+	 */
+	static bool Intersect(const Triangle &triangle, const Ray<T> &ray, T &t, T &u, T &v) {
+		auto p = ray.direction.Cross(triangle.e2);
+		auto det = triangle.e1.Dot(p);
+		if (det == 0)
+			return false;
+		auto invDet = 1 / det;
+		auto s = ray.origin - triangle.v0;
+		u = s.Dot(p) * invDet;
+		auto q = s.Cross(triangle.e1);
+		v = ray.direction.Dot(q) * invDet;
+		t = triangle.e2.Dot(q) * invDet;
+		return (u >= 0) & (v >= 0) & (u + v <= 1) & (t >= ray.tMin) & (t < ray.tMax);
+	}
+
+	/**
+	 * Möller-Trumbore across every lane of a packet, written with selects so the loop vectorizes.
+	 */
+	template<std::size_t K>
+	static void Intersect(const Triangle &triangle, uint32_t id, RayPacket<T, K> &rays, PacketHit<K> &hits) {
+		const auto &v0 = triangle.v0, &e1 = triangle.e1, &e2 = triangle.e2;
+		for (std::size_t k = 0; k < K; k++) {
+			auto dx = rays.direction[0][k], dy = rays.direction[1][k], dz = rays.direction[2][k];
+			auto px = dy * e2.z - dz * e2.y, py = dz * e2.x - dx * e2.z, pz = dx * e2.y - dy * e2.x;
+			auto det = e1.x * px + e1.y * py + e1.z * pz;
+			auto invDet = 1 / det;
+			auto sx = rays.origin[0][k] - v0.x, sy = rays.origin[1][k] - v0.y, sz = rays.origin[2][k] - v0.z;
+			auto u = (sx * px + sy * py + sz * pz) * invDet;
+			auto qx = sy * e1.z - sz * e1.y, qy = sz * e1.x - sx * e1.z, qz = sx * e1.y - sy * e1.x;
+			auto v = (dx * qx + dy * qy + dz * qz) * invDet;
+			auto t = (e2.x * qx + e2.y * qy + e2.z * qz) * invDet;
+			auto hit = (det != 0) & (u >= 0) & (v >= 0) & (u + v <= 1) & (t >= rays.tMin[k]) & (t < rays.tMax[k]);
+			rays.tMax[k] = hit ? t : rays.tMax[k];
+			hits.triangle[k] = hit ? id : hits.triangle[k];
+			hits.t[k] = hit ? t : hits.t[k];
+			hits.u[k] = hit ? u : hits.u[k];
+			hits.v[k] = hit ? v : hits.v[k];
+		}
+	}
+
+	BVH<T> bvh;
+	/// Triangles in leaf order.
+	std::vector<Triangle> triangles;
+};
+
+using BVHf = BVH<float>;
+using BVHd = BVH<double>;
+
+using MeshBVHf = MeshBVH<float>;
+using MeshBVHd = MeshBVH<double>;
+}
@@ -161,6 +161,22 @@ public:
 			throw std::runtime_error("Unknown Color type");
 		}
 	}
+
+	/**
+	 * Gets packed integers for many colours, as GetInt does for one.
+	 * @param colours The colours.
+	 * @param results The packed integers, the same size as colours.
+	 * @param type The order components of colour are packed.
+	 */
+	static void GetInts(Span<const Colour> colours, Span<uint32_t> results, Type type = Type::RGBA) {
+		// Checked here since an exception cannot leave a worker thread.
+		if (type != Type::RGBA && type != Type::ARGB && type != Type::RGB)
+			throw std::runtime_error("Unknown Color type");
+		Parallel::For(0, colours.size(), BatchGrain, [&](std::size_t begin, std::size_t end) {
+			for (auto i = begin; i < end; i++)
+				results[i] = colours[i].GetInt(type);
+		});
+	}
 	
 	/**
 	 * Gets the hex code from this colour.
@@ -242,7 +258,7 @@ public:
 		return result;
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator*(const Colour &lhs, T1 rhs) {
 		Colour<decltype(lhs[0] * rhs)> result;
 		for (std::size_t i = 0; i < 4; i++)
@@ -250,7 +266,7 @@ public:
 		return result;
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator/(const Colour &lhs, T1 rhs) {
 		Colour<decltype(lhs[0] / rhs)> result;
 		for (std::size_t i = 0; i < 4; i++)
@@ -258,7 +274,7 @@ public:
 		return result;
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator*(T1 lhs, const Colour &rhs) {
 		Colour<decltype(lhs * rhs[0])> result;
 		for (std::size_t i = 0; i < 4; i++)
@@ -266,7 +282,7 @@ public:
 		return result;
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator/(T1 lhs, const Colour &rhs) {
 		Colour<decltype(lhs / rhs[0])> result;
 		for (std::size_t i = 0; i < 4; i++)
@@ -319,6 +335,15 @@ public:
 	static const Colour Fuchsia;
 
 	T r{}, g{}, b{}, a{1};
+
+private:
+	static constexpr std::size_t BatchGrain = 1 << 14;
+};
+
+template<typename T>
+struct ArrayTraits<Colour<T>> {
+	using Value = T;
+	static constexpr std::size_t Count = 4;
 };
 
 template<typename T>
@@ -360,16 +385,14 @@ using Colourf = Colour<float>;
 using Colourd = Colour<double>;
 using Colouri = Colour<int32_t>;
 using Colourui = Colour<uint32_t>;
+using Colourh = Colour<Half>;
 }
 
 namespace std {
 template<typename T>
 struct hash<MathsCPP::Colour<T>> {
 	size_t operator()(const MathsCPP::Colour<T> &colour) const noexcept {
-		size_t seed = 0;
-		for (size_t i = 0; i < 4; i++)
-			MathsCPP::Maths::HashCombine(seed, colour[i]);
-		return seed;
+		return static_cast<size_t>(MathsCPP::Maths::HashValues<T, 4>(&colour.r));
 	}
 };
 }
@@ -0,0 +1,903 @@
+#pragma once
+
+#include "Quaternion.hpp"
+
+namespace MathsCPP {
+namespace Detail {
+/**
+ * Multiplies the quaternion q by another on the right, in place, as Quaternion * Quaternion does.
+ */
+template<typename T>
+MATHSCPP_INLINE void MultiplyQuaternion(T &qx, T &qy, T &qz, T &qw, T x, T y, T z, T w) {
+	auto rx = qx * w + qw * x + qy * z - qz * y;
+	auto ry = qy * w + qw * y + qz * x - qx * z;
+	auto rz = qz * w + qw * z + qx * y - qy * x;
+	qw = qw * w - qx * x - qy * y - qz * z;
+	qx = rx;
+	qy = ry;
+	qz = rz;
+}
+
+/**
+ * Applies the Jacobi rotation that zeroes spq to a symmetric 3x3 matrix, p and q are the rotated axes and r the third.
+ * The rotation turns axis p toward axis q, its half angle cosine and sine are returned through ch and sh.
+ */
+template<typename T>
+MATHSCPP_INLINE void JacobiRotate(T &spp, T &sqq, T &spq, T &srp, T &srq, T &ch, T &sh) {
+	// The smaller root of t^2 + 2 tau t - 1 = 0, tau = (spp - sqq) / (2 spq), written so a zero spq gives t = 0 without dividing by it.
+	auto d = spp - sqq;
+	auto t = 2 * spq * std::copysign(T(1), d) /
+		(std::abs(d) + Maths::Fast::Sqrt<Maths::Precision::High>(d * d + 4 * spq * spq) + std::numeric_limits<T>::min());
+	auto c = Maths::Fast::Rsqrt<Maths::Precision::High>(1 + t * t);
+	auto s = t * c;
+	spp += t * spq;
+	sqq -= t * spq;
+	spq = 0;
+	auto rp = srp, rq = srq;
+	srp = c * rp + s * rq;
+	srq = c * rq - s * rp;
+	// c is at least cos(pi/4), so the half angle cosine is well away from zero.
+	ch = Maths::Fast::Sqrt<Maths::Precision::High>((1 + c) * T(0.5));
+	sh = s * T(0.5) / ch;
+}
+
+/**
+ * Applies one sweep of Jacobi rotations to the symmetric matrix s00, s10, s11, s20, s21, s22, accumulating them into q.
+ */
+template<typename T>
+MATHSCPP_INLINE void JacobiSweep(T &s00, T &s10, T &s11, T &s20, T &s21, T &s22, T &qx, T &qy, T &qz, T &qw) {
+	T ch, sh;
+	// Turning x toward y is a rotation about z, x toward z one about -y, and y toward z one about x.
+	JacobiRotate(s00, s11, s10, s20, s21, ch, sh);
+	MultiplyQuaternion(qx, qy, qz, qw, T(0), T(0), sh, ch);
+	JacobiRotate(s00, s22, s20, s10, s21, ch, sh);
+	MultiplyQuaternion(qx, qy, qz, qw, T(0), -sh, T(0), ch);
+	JacobiRotate(s11, s22, s21, s10, s20, ch, sh);
+	MultiplyQuaternion(qx, qy, qz, qw, sh, T(0), T(0), ch);
+}
+
+/**
+ * Orders three values largest first, turning q by a quarter turn for every swap so it stays a rotation with its columns following the values.
+ */
+template<typename T>
+MATHSCPP_INLINE void SortDescending(T &v0, T &v1, T &v2, T &qx, T &qy, T &qz, T &qw) {
+	constexpr auto Half = T(0.707106781186547524400844362104849039);
+	auto swap = [&](T &a, T &b, T x, T y, T z) {
+		auto less = a < b;
+		auto rx = qx, ry = qy, rz = qz, rw = qw;
+		MultiplyQuaternion(rx, ry, rz, rw, x, y, z, Half);
+		qx = Maths::Fast::Select(less, rx, qx);
+		qy = Maths::Fast::Select(less, ry, qy);
+		qz = Maths::Fast::Select(less, rz, qz);
+		qw = Maths::Fast::Select(less, rw, qw);
+		auto oldA = a;
+		a = Maths::Fast::Select(less, b, a);
+		b = Maths::Fast::Select(less, oldA, b);
+	};
+	swap(v0, v1, T(0), T(0), Half);
+	swap(v0, v2, T(0), -Half, T(0));
+	swap(v1, v2, Half, T(0), T(0));
+}
+
+/**
+ * Finds the Givens rotation that zeroes a2 against a1, as the half angle cosine and sine, leaving a1 non-negative.
+ * When both are zero, or so small their squares underflow, it is the identity rather than a rotation lost to rounding.
+ */
+template<typename T>
+MATHSCPP_INLINE void QRGivens(T a1, T a2, T &ch, T &sh) {
+	// tan(theta / 2) = a2 / (rho + a1) = (rho - a1) / a2, the form without cancellation is picked by the sign of a1.
+	auto squared = a1 * a1 + a2 * a2;
+	auto degenerate = squared < std::numeric_limits<T>::min();
+	auto rho = Maths::Fast::Sqrt<Maths::Precision::High>(squared);
+	auto large = std::abs(a1) + rho + std::numeric_limits<T>::min();
+	auto negative = a1 < 0;
+	ch = Maths::Fast::Select(negative, a2, large);
+	sh = Maths::Fast::Select(negative, large, a2);
+	auto scale = Maths::Fast::Rsqrt<Maths::Precision::High>(ch * ch + sh * sh);
+	ch = Maths::Fast::Select(degenerate, T(1), ch * scale);
+	sh = Maths::Fast::Select(degenerate, T(0), sh * scale);
+}
+
+/**
+ * Rotates two rows of a 3x3 matrix by the Givens rotation with half angle cosine ch and sine sh.
+ */
+template<typename T>
+MATHSCPP_INLINE void RotateRows(T &a0, T &a1, T &a2, T &b0, T &b1, T &b2, T ch, T sh) {
+	auto c = ch * ch - sh * sh;
+	auto s = 2 * sh * ch;
+	auto rotate = [c, s](T &a, T &b) {
+		auto oldA = a;
+		a = c * a + s * b;
+		b = c * b - s * oldA;
+	};
+	rotate(a0, b0);
+	rotate(a1, b1);
+	rotate(a2, b2);
+}
+
+/**
+ * Copies a block of matrices into structure of arrays, a[j][k][i] holding row j column k of matrix i.
+ * With Lower set only the columns up to the diagonal are copied.
+ */
+template<bool Lower, typename T, std::size_t N, std::size_t M, std::size_t Block>
+void GatherMatrices(const Matrix<T, N, M> *matrices, std::size_t count, T (&a)[M][N][Block]) {
+	for (std::size_t i = 0; i < count; i++) {
+		for (std::size_t j = 0; j < M; j++) {
+			for (std::size_t k = 0; k < (Lower ? j + 1 : N); k++)
+				a[j][k][i] = matrices[i][j][k];
+		}
+	}
+}
+
+template<typename T, std::size_t N, std::size_t Block>
+void GatherVectors(const Vector<T, N> *vectors, std::size_t count, T (&b)[N][Block]) {
+	for (std::size_t i = 0; i < count; i++) {
+		for (std::size_t j = 0; j < N; j++)
+			b[j][i] = vectors[i][j];
+	}
+}
+
+/// Copies the first N entries of a block of vectors back out of structure of arrays.
+template<typename T, std::size_t N, std::size_t M, std::size_t Block>
+void ScatterVectors(const T (&b)[M][Block], std::size_t count, Vector<T, N> *vectors) {
+	for (std::size_t i = 0; i < count; i++) {
+		for (std::size_t j = 0; j < N; j++)
+			vectors[i][j] = b[j][i];
+	}
+}
+
+/// Indexes a matrix of one system as a(j, k, i), so the same kernels serve single systems and blocks of them.
+template<typename T, std::size_t N, std::size_t M>
+auto SystemAccess(Matrix<T, N, M> &matrix) { return [&matrix](std::size_t j, std::size_t k, std::size_t) -> T & { return matrix[j][k]; }; }
+template<typename T, std::size_t N, std::size_t M>
+auto SystemAccess(const Matrix<T, N, M> &matrix) { return [&matrix](std::size_t j, std::size_t k, std::size_t) -> const T & { return matrix[j][k]; }; }
+/// Indexes a vector of one system as b(j, i).
+template<typename T, std::size_t N>
+auto SystemAccess(Vector<T, N> &vector) { return [&vector](std::size_t j, std::size_t) -> T & { return vector[j]; }; }
+template<typename T, std::size_t N>
+auto SystemAccess(const Vector<T, N> &vector) { return [&vector](std::size_t j, std::size_t) -> const T & { return vector[j]; }; }
+/// Indexes matrices of a block of systems stored as structure of arrays, a[j][k][i] holding row j column k of system i.
+template<typename T, std::size_t M, std::size_t N, std::size_t Block>
+auto SystemAccess(T (&a)[M][N][Block]) { return [&a](std::size_t j, std::size_t k, std::size_t i) -> T & { return a[j][k][i]; }; }
+/// Indexes vectors of a block of systems stored as structure of arrays, b[j][i] holding entry j of system i.
+template<typename T, std::size_t N, std::size_t Block>
+auto SystemAccess(T (&b)[N][Block]) { return [&b](std::size_t j, std::size_t i) -> T & { return b[j][i]; }; }
+
+/// Systems solved together in the batch kernels, small enough for the blocks to stay on the stack for 12x12 doubles.
+constexpr std::size_t SystemBlock = 16;
+/// Smaller again than the 3x3 decompositions, factoring a system costs O(N^3).
+constexpr std::size_t SystemGrain = 1 << 10;
+
+/**
+ * Factors and solves many independent systems, the driver behind each decomposition's batch Solve.
+ * Blocks of systems are solved together with the loop over systems innermost, so the kernels vectorize across systems.
+ * @tparam Lower If only the lower triangle of each matrix is read.
+ * @tparam State The factor data a block keeps besides its matrices, such as the inverse diagonal.
+ * @param matrices The matrices, with N columns and M rows.
+ * @param vectors The right hand sides, the same size as matrices.
+ * @param results The solutions, the same size as matrices.
+ * @param valid Set to whether each system could be solved, the same size as matrices or empty to skip it.
+ * @param factor Invocable as factor(a, state, factored), factoring a block in place and setting factored[i] to 1 or 0.
+ * @param substitute Invocable as substitute(a, state, b), overwriting the right hand sides with the solutions.
+ */
+template<bool Lower, typename State, typename T, std::size_t N, std::size_t M, typename Factor, typename Substitute>
+void SolveSystems(Span<const Matrix<T, N, M>> matrices, Span<const Vector<T, M>> vectors, Span<Vector<T, N>> results, Span<bool> valid,
+	Factor &&factor, Substitute &&substitute) {
+	Parallel::For(0, matrices.size(), SystemGrain, [&](std::size_t begin, std::size_t end) {
+		T a[M][N][SystemBlock]{}, b[M][SystemBlock]{}, factored[SystemBlock];
+		State state{};
+		for (auto block = begin; block < end; block += SystemBlock) {
+			auto count = std::min(SystemBlock, end - block);
+			GatherMatrices<Lower>(matrices.data() + block, count, a);
+			GatherVectors(vectors.data() + block, count, b);
+			factor(a, state, factored);
+			if (!valid.empty()) {
+				for (std::size_t i = 0; i < count; i++)
+					valid[block + i] = factored[i] != 0;
+			}
+			substitute(a, state, b);
+			ScatterVectors(b, count, results.data() + block);
+		}
+	});
+}
+}
+
+template<typename T>
+struct SingularValueDecomposition;
+
+/**
+ * @brief The eigen-decomposition of a symmetric 3x3 matrix, found with a fixed number of Jacobi sweeps so every matrix takes
+ * the same branch free path and batches vectorize across matrices.
+ * @tparam T The value type.
+ */
+template<typename T>
+struct SymmetricEigen {
+	static_assert(std::is_floating_point_v<T>, "SymmetricEigen needs a floating point type");
+
+	/**
+	 * Decomposes a symmetric matrix, only the lower triangle is read.
+	 * @param matrix The matrix.
+	 * @return The decomposition.
+	 */
+	static SymmetricEigen Compute(const Matrix<T, 3, 3> &matrix) {
+		T s[6][1] = {{matrix[0][0]}, {matrix[1][0]}, {matrix[1][1]}, {matrix[2][0]}, {matrix[2][1]}, {matrix[2][2]}}, q[4][1];
+		Solve(s, q);
+		SymmetricEigen result;
+		result.rotation = {q[0][0], q[1][0], q[2][0], q[3][0]};
+		result.values = {s[0][0], s[2][0], s[5][0]};
+		return result;
+	}
+
+	/**
+	 * Decomposes many symmetric matrices, as Compute does for one.
+	 * @param matrices The matrices.
+	 * @param results The decompositions, the same size as matrices.
+	 */
+	static void Compute(Span<const Matrix<T, 3, 3>> matrices, Span<SymmetricEigen> results) {
+		Parallel::For(0, matrices.size(), BatchGrain, [&](std::size_t begin, std::size_t end) {
+			T s[6][BatchBlock]{}, q[4][BatchBlock]{};
+			for (auto block = begin; block < end; block += BatchBlock) {
+				auto count = std::min(BatchBlock, end - block);
+				for (std::size_t i = 0; i < count; i++) {
+					const auto &matrix = matrices[block + i];
+					s[0][i] = matrix[0][0];
+					s[1][i] = matrix[1][0];
+					s[2][i] = matrix[1][1];
+					s[3][i] = matrix[2][0];
+					s[4][i] = matrix[2][1];
+					s[5][i] = matrix[2][2];
+				}
+				Solve(s, q);
+				for (std::size_t i = 0; i < count; i++) {
+					results[block + i].rotation = {q[0][i], q[1][i], q[2][i], q[3][i]};
+					results[block + i].values = {s[0][i], s[2][i], s[5][i]};
+				}
+			}
+		});
+	}
+
+	/**
+	 * Rebuilds the decomposed matrix.
+	 * @return The rotation times the diagonal of values times the inverse rotation.
+	 */
+	Matrix<T, 3, 3> ToMatrix() const {
+		auto vectors = rotation.ToRotationMatrix();
+		Matrix<T, 3, 3> result;
+		for (std::size_t j = 0; j < 3; j++) {
+			for (std::size_t i = 0; i < 3; i++) {
+				for (std::size_t k = 0; k < 3; k++)
+					result[j][i] += vectors[j][k] * values[k] * vectors[i][k];
+			}
+		}
+		return result;
+	}
+
+	/// Column i of the rotation matrix of this quaternion is the unit eigenvector of values[i].
+	Quaternion<T> rotation;
+	/// The eigenvalues, largest first.
+	Vector<T, 3> values;
+
+private:
+	friend struct SingularValueDecomposition<T>;
+
+	/// Matrices decomposed per pass of the batch kernels, small enough for the component arrays to stay on the stack.
+	static constexpr std::size_t BatchBlock = 64;
+	/// Smaller than the vector grains, each matrix takes four Jacobi sweeps.
+	static constexpr std::size_t BatchGrain = 1 << 12;
+	/// Jacobi converges quadratically, after four sweeps the off diagonal terms are below rounding in float and double.
+	static constexpr int Sweeps = 4;
+
+	/**
+	 * Diagonalizes a block of symmetric matrices in place, leaving the eigenvalues on the diagonal and the eigenvectors in q.
+	 * Each stage is its own loop over the block so the loops vectorize across matrices.
+	 */
+	template<std::size_t Count>
+	MATHSCPP_INLINE static void Solve(T (&s)[6][Count], T (&q)[4][Count]) {
+		for (std::size_t i = 0; i < Count; i++) {
+			q[0][i] = q[1][i] = q[2][i] = 0;
+			q[3][i] = 1;
+		}
+		for (int sweep = 0; sweep < Sweeps; sweep++) {
+			for (std::size_t i = 0; i < Count; i++)
+				Detail::JacobiSweep(s[0][i], s[1][i], s[2][i], s[3][i], s[4][i], s[5][i], q[0][i], q[1][i], q[2][i], q[3][i]);
+		}
+		for (std::size_t i = 0; i < Count; i++) {
+			Detail::SortDescending(s[0][i], s[2][i], s[5][i], q[0][i], q[1][i], q[2][i], q[3][i]);
+			// Renormalizing removes the drift of the accumulated products.
+			auto scale = Maths::Fast::Rsqrt<Maths::Precision::High>(q[0][i] * q[0][i] + q[1][i] * q[1][i] + q[2][i] * q[2][i] + q[3][i] * q[3][i]);
+			for (std::size_t c = 0; c < 4; c++)
+				q[c][i] *= scale;
+		}
+	}
+};
+
+/**
+ * @brief The singular value decomposition of a 3x3 matrix as two rotations and a diagonal, matrix = u * diagonal(values) * v^T.
+ * V comes from the eigen-decomposition of matrix^T * matrix, then Givens rotations reduce matrix * v to the upper triangle
+ * whose diagonal is the singular values, so u and v stay rotations and a mirroring matrix gets a negative last value.
+ * @tparam T The value type.
+ */
+template<typename T>
+struct SingularValueDecomposition {
+	static_assert(std::is_floating_point_v<T>, "SingularValueDecomposition needs a floating point type");
+
+	/**
+	 * Decomposes a matrix.
+	 * @param matrix The matrix.
+	 * @return The decomposition.
+	 */
+	static SingularValueDecomposition Compute(const Matrix<T, 3, 3> &matrix) {
+		T a[9][1], u[4][1], values[3][1], v[4][1];
+		for (std::size_t j = 0; j < 3; j++) {
+			for (std::size_t i = 0; i < 3; i++)
+				a[j * 3 + i][0] = matrix[j][i];
+		}
+		Solve(a, u, values, v);
+		SingularValueDecomposition result;
+		result.u = {u[0][0], u[1][0], u[2][0], u[3][0]};
+		result.values = {values[0][0], values[1][0], values[2][0]};
+		result.v = {v[0][0], v[1][0], v[2][0], v[3][0]};
+		return result;
+	}
+
+	/**
+	 * Decomposes many matrices, as Compute does for one.
+	 * @param matrices The matrices.
+	 * @param results The decompositions, the same size as matrices.
+	 */
+	static void Compute(Span<const Matrix<T, 3, 3>> matrices, Span<SingularValueDecomposition> results) {
+		Parallel::For(0, matrices.size(), BatchGrain, [&](std::size_t begin, std::size_t end) {
+			T a[9][BatchBlock]{}, u[4][BatchBlock]{}, values[3][BatchBlock]{}, v[4][BatchBlock]{};
+			for (auto block = begin; block < end; block += BatchBlock) {
+				auto count = std::min(BatchBlock, end - block);
+				for (std::size_t i = 0; i < count; i++) {
+					for (std::size_t j = 0; j < 3; j++) {
+						for (std::size_t k = 0; k < 3; k++)
+							a[j * 3 + k][i] = matrices[block + i][j][k];
+					}
+				}
+				Solve(a, u, values, v);
+				for (std::size_t i = 0; i < count; i++) {
+					auto &result = results[block + i];
+					result.u = {u[0][i], u[1][i], u[2][i], u[3][i]};
+					result.values = {values[0][i], values[1][i], values[2][i]};
+					result.v = {v[0][i], v[1][i], v[2][i], v[3][i]};
+				}
+			}
+		});
+	}
+
+	/**
+	 * Gets the rotation of the polar decomposition matrix = rotation * stretch, the rotation nearest to the matrix.
+	 * @return The rotation u * v^T.
+	 */
+	Quaternion<T> GetPolarRotation() const {
+		return u * v.Conjugate();
+	}
+
+	/**
+	 * Gets the symmetric stretch of the polar decomposition matrix = rotation * stretch.
+	 * @return The stretch v * diagonal(values) * v^T.
+	 */
+	Matrix<T, 3, 3> GetPolarStretch() const {
+		SymmetricEigen<T> stretch;
+		stretch.rotation = v;
+		stretch.values = values;
+		return stretch.ToMatrix();
+	}
+
+	/**
+	 * Rebuilds the decomposed matrix.
+	 * @return u * diagonal(values) * v^T.
+	 */
+	Matrix<T, 3, 3> ToMatrix() const {
+		auto left = u.ToRotationMatrix(), right = v.ToRotationMatrix();
+		Matrix<T, 3, 3> result;
+		for (std::size_t j = 0; j < 3; j++) {
+			for (std::size_t i = 0; i < 3; i++) {
+				for (std::size_t k = 0; k < 3; k++)
+					result[j][i] += left[j][k] * values[k] * right[i][k];
+			}
+		}
+		return result;
+	}
+
+	/// The left rotation, its columns are the left singular vectors.
+	Quaternion<T> u;
+	/// The singular values, largest magnitude first, only the last may be negative.
+	Vector<T, 3> values;
+	/// The right rotation, its columns are the right singular vectors.
+	Quaternion<T> v;
+
+private:
+	static constexpr std::size_t BatchBlock = SymmetricEigen<T>::BatchBlock;
+	static constexpr std::size_t BatchGrain = SymmetricEigen<T>::BatchGrain;
+
+	/**
+	 * Decomposes a block of matrices stored row by row, a[j * 3 + i] holding row j column i.
+	 */
+	template<std::size_t Count>
+	MATHSCPP_INLINE static void Solve(T (&a)[9][Count], T (&u)[4][Count], T (&values)[3][Count], T (&v)[4][Count]) {
+		T s[6][Count];
+		for (std::size_t i = 0; i < Count; i++) {
+			auto column = [&](std::size_t p, std::size_t q) { return a[p][i] * a[q][i] + a[3 + p][i] * a[3 + q][i] + a[6 + p][i] * a[6 + q][i]; };
+			s[0][i] = column(0, 0);
+			s[1][i] = column(1, 0);
+			s[2][i] = column(1, 1);
+			s[3][i] = column(2, 0);
+			s[4][i] = column(2, 1);
+			s[5][i] = column(2, 2);
+		}
+		SymmetricEigen<T>::Solve(s, v);
+		for (std::size_t i = 0; i < Count; i++) {
+			T r[12];
+			Detail::ComposeTRS(T(0), T(0), T(0), v[0][i], v[1][i], v[2][i], v[3][i], T(1), T(1), T(1), r, 1);
+			// b = a * v, then reduced to the upper triangle by rotating rows, the rotations make up u.
+			T b[9];
+			for (std::size_t j = 0; j < 3; j++) {
+				for (std::size_t k = 0; k < 3; k++)
+					b[j * 3 + k] = a[j * 3][i] * r[k] + a[j * 3 + 1][i] * r[4 + k] + a[j * 3 + 2][i] * r[8 + k];
+			}
+			T ch, sh, qx = 0, qy = 0, qz = 0, qw = 1;
+			Detail::QRGivens(b[0], b[3], ch, sh);
+			Detail::RotateRows(b[0], b[1], b[2], b[3], b[4], b[5], ch, sh);
+			Detail::MultiplyQuaternion(qx, qy, qz, qw, T(0), T(0), sh, ch);
+			Detail::QRGivens(b[0], b[6], ch, sh);
+			Detail::RotateRows(b[0], b[1], b[2], b[6], b[7], b[8], ch, sh);
+			Detail::MultiplyQuaternion(qx, qy, qz, qw, T(0), -sh, T(0), ch);
+			Detail::QRGivens(b[4], b[7], ch, sh);
+			Detail::RotateRows(b[3], b[4], b[5], b[6], b[7], b[8], ch, sh);
+			Detail::MultiplyQuaternion(qx, qy, qz, qw, sh, T(0), T(0), ch);
+			u[0][i] = qx;
+			u[1][i] = qy;
+			u[2][i] = qz;
+			u[3][i] = qw;
+			values[0][i] = b[0];
+			values[1][i] = b[4];
+			values[2][i] = b[8];
+		}
+	}
+};
+
+/**
+ * @brief The Cholesky factorization matrix = L * L^T of a symmetric positive definite matrix, for solving linear systems.
+ * Only the lower triangle of the matrix is read. Every loop has a compile time bound, so small systems unroll fully.
+ * @tparam T The value type.
+ * @tparam N The size of the system.
+ */
+template<typename T, std::size_t N>
+class Cholesky {
+	static_assert(std::is_floating_point_v<T>, "Cholesky needs a floating point type");
+public:
+	Cholesky() = default;
+	/**
+	 * Factors a matrix.
+	 * @param matrix The symmetric positive definite matrix.
+	 */
+	explicit Cholesky(const Matrix<T, N, N> &matrix) : factor(matrix) {
+		T valid[1];
+		Factor<1>(Detail::SystemAccess(factor), Detail::SystemAccess(inverseDiagonal), valid);
+		positiveDefinite = valid[0] != 0;
+	}
+
+	/**
+	 * Gets if every pivot was positive, when it is not the solutions are meaningless.
+	 * @return If the matrix is positive definite.
+	 */
+	bool IsPositiveDefinite() const { return positiveDefinite; }
+
+	/**
+	 * Gets the lower triangular factor.
+	 * @return L.
+	 */
+	Matrix<T, N, N> GetLower() const {
+		Matrix<T, N, N> result;
+		for (std::size_t j = 0; j < N; j++) {
+			for (std::size_t k = 0; k <= j; k++)
+				result[j][k] = factor[j][k];
+		}
+		return result;
+	}
+
+	/**
+	 * Solves matrix * x = vector.
+	 * @param vector The right hand side.
+	 * @return x.
+	 */
+	Vector<T, N> Solve(Vector<T, N> vector) const {
+		SolveInPlace(vector);
+		return vector;
+	}
+
+	/**
+	 * Solves matrix * x = vector, overwriting the vector with x.
+	 * @param vector The right hand side, then x.
+	 */
+	void SolveInPlace(Vector<T, N> &vector) const {
+		Substitute<1>(Detail::SystemAccess(factor), Detail::SystemAccess(inverseDiagonal), Detail::SystemAccess(vector));
+	}
+
+	/**
+	 * Factors and solves many independent systems, as Solve does for one, through Detail::SolveSystems.
+	 * @param matrices The symmetric positive definite matrices.
+	 * @param vectors The right hand sides, the same size as matrices.
+	 * @param results The solutions, the same size as matrices, it may be the same memory as vectors.
+	 * @param valid Set to whether each matrix was positive definite, as IsPositiveDefinite, the same size as matrices or empty to skip it.
+	 */
+	static void Solve(Span<const Matrix<T, N, N>> matrices, Span<const Vector<T, N>> vectors, Span<Vector<T, N>> results, Span<bool> valid = {}) {
+		Detail::SolveSystems<true, T[N][Detail::SystemBlock]>(matrices, vectors, results, valid, [](auto &a, auto &inverseDiagonal, auto &factored) {
+			Factor<Detail::SystemBlock>(Detail::SystemAccess(a), Detail::SystemAccess(inverseDiagonal), factored);
+		}, [](auto &a, auto &inverseDiagonal, auto &b) {
+			Substitute<Detail::SystemBlock>(Detail::SystemAccess(a), Detail::SystemAccess(inverseDiagonal), Detail::SystemAccess(b));
+		});
+	}
+
+private:
+
+	/**
+	 * Factors Count matrices in place over their lower triangles, a(j, k, i) being row j column k of matrix i.
+	 * Pivots that are not positive clear valid[i].
+	 */
+	template<std::size_t Count, typename A, typename D>
+	MATHSCPP_INLINE static void Factor(A &&a, D &&inverseDiagonal, T (&valid)[Count]) {
+		for (std::size_t i = 0; i < Count; i++)
+			valid[i] = 1;
+		for (std::size_t j = 0; j < N; j++) {
+			for (std::size_t k = 0; k < j; k++) {
+				for (std::size_t i = 0; i < Count; i++)
+					a(j, j, i) -= a(j, k, i) * a(j, k, i);
+			}
+			for (std::size_t i = 0; i < Count; i++) {
+				auto pivot = a(j, j, i);
+				valid[i] = Maths::Fast::Select(pivot > 0, valid[i], T(0));
+				inverseDiagonal(j, i) = Maths::Fast::Rsqrt<Maths::Precision::High>(pivot);
+				a(j, j, i) = pivot * inverseDiagonal(j, i);
+			}
+			for (std::size_t r = j + 1; r < N; r++) {
+				for (std::size_t k = 0; k < j; k++) {
+					for (std::size_t i = 0; i < Count; i++)
+						a(r, j, i) -= a(r, k, i) * a(j, k, i);
+				}
+				for (std::size_t i = 0; i < Count; i++)
+					a(r, j, i) *= inverseDiagonal(j, i);
+			}
+		}
+	}
+
+	/**
+	 * Solves L * L^T * x = b for Count factored matrices, overwriting b(j, i) with x.
+	 */
+	template<std::size_t Count, typename A, typename D, typename B>
+	MATHSCPP_INLINE static void Substitute(A &&a, D &&inverseDiagonal, B &&b) {
+		for (std::size_t j = 0; j < N; j++) {
+			for (std::size_t k = 0; k < j; k++) {
+				for (std::size_t i = 0; i < Count; i++)
+					b(j, i) -= a(j, k, i) * b(k, i);
+			}
+			for (std::size_t i = 0; i < Count; i++)
+				b(j, i) *= inverseDiagonal(j, i);
+		}
+		for (std::size_t j = N; j-- > 0;) {
+			for (std::size_t k = j + 1; k < N; k++) {
+				for (std::size_t i = 0; i < Count; i++)
+					b(j, i) -= a(k, j, i) * b(k, i);
+			}
+			for (std::size_t i = 0; i < Count; i++)
+				b(j, i) *= inverseDiagonal(j, i);
+		}
+	}
+
+	Matrix<T, N, N> factor;
+	Vector<T, N> inverseDiagonal;
+	bool positiveDefinite = false;
+};
+
+/**
+ * @brief The factorization matrix = L * D * L^T of a symmetric matrix with L unit lower triangular and D diagonal.
+ * Unlike Cholesky it takes no square roots and also handles indefinite matrices, as long as no pivot is zero, there is no pivoting.
+ * Only the lower triangle of the matrix is read. Every loop has a compile time bound, so small systems unroll fully.
+ * @tparam T The value type.
+ * @tparam N The size of the system.
+ */
+template<typename T, std::size_t N>
+class LDLT {
+	static_assert(std::is_floating_point_v<T>, "LDLT needs a floating point type");
+public:
+	LDLT() = default;
+	/**
+	 * Factors a matrix.
+	 * @param matrix The symmetric matrix.
+	 */
+	explicit LDLT(const Matrix<T, N, N> &matrix) : factor(matrix) {
+		T valid[1];
+		Factor<1>(Detail::SystemAccess(factor), Detail::SystemAccess(inverseDiagonal), valid);
+		invertible = valid[0] != 0;
+	}
+
+	/**
+	 * Gets if no pivot was zero, when one was the solutions are not finite.
+	 * @return If the factorization can solve systems.
+	 */
+	bool IsInvertible() const { return invertible; }
+
+	/**
+	 * Gets the unit lower triangular factor.
+	 * @return L.
+	 */
+	Matrix<T, N, N> GetLower() const {
+		Matrix<T, N, N> result;
+		for (std::size_t j = 0; j < N; j++) {
+			for (std::size_t k = 0; k < j; k++)
+				result[j][k] = factor[j][k];
+			result[j][j] = 1;
+		}
+		return result;
+	}
+
+	/**
+	 * Gets the diagonal factor.
+	 * @return The diagonal of D.
+	 */
+	Vector<T, N> GetDiagonal() const {
+		Vector<T, N> result;
+		for (std::size_t j = 0; j < N; j++)
+			result[j] = factor[j][j];
+		return result;
+	}
+
+	/**
+	 * Solves matrix * x = vector.
+	 * @param vector The right hand side.
+	 * @return x.
+	 */
+	Vector<T, N> Solve(Vector<T, N> vector) const {
+		SolveInPlace(vector);
+		return vector;
+	}
+
+	/**
+	 * Solves matrix * x = vector, overwriting the vector with x.
+	 * @param vector The right hand side, then x.
+	 */
+	void SolveInPlace(Vector<T, N> &vector) const {
+		Substitute<1>(Detail::SystemAccess(factor), Detail::SystemAccess(inverseDiagonal), Detail::SystemAccess(vector));
+	}
+
+	/**
+	 * Factors and solves many independent systems, as Solve does for one, through Detail::SolveSystems.
+	 * @param matrices The symmetric matrices.
+	 * @param vectors The right hand sides, the same size as matrices.
+	 * @param results The solutions, the same size as matrices, it may be the same memory as vectors.
+	 * @param valid Set to whether each matrix was invertible, as IsInvertible, the same size as matrices or empty to skip it.
+	 */
+	static void Solve(Span<const Matrix<T, N, N>> matrices, Span<const Vector<T, N>> vectors, Span<Vector<T, N>> results, Span<bool> valid = {}) {
+		Detail::SolveSystems<true, T[N][Detail::SystemBlock]>(matrices, vectors, results, valid, [](auto &a, auto &inverseDiagonal, auto &factored) {
+			Factor<Detail::SystemBlock>(Detail::SystemAccess(a), Detail::SystemAccess(inverseDiagonal), factored);
+		}, [](auto &a, auto &inverseDiagonal, auto &b) {
+			Substitute<Detail::SystemBlock>(Detail::SystemAccess(a), Detail::SystemAccess(inverseDiagonal), Detail::SystemAccess(b));
+		});
+	}
+
+private:
+
+	/**
+	 * Factors Count matrices in place over their lower triangles, a(j, k, i) being row j column k of matrix i, D goes on the diagonal.
+	 * Zero pivots clear valid[i].
+	 */
+	template<std::size_t Count, typename A, typename D>
+	MATHSCPP_INLINE static void Factor(A &&a, D &&inverseDiagonal, T (&valid)[Count]) {
+		for (std::size_t i = 0; i < Count; i++)
+			valid[i] = 1;
+		for (std::size_t j = 0; j < N; j++) {
+			for (std::size_t k = 0; k < j; k++) {
+				for (std::size_t i = 0; i < Count; i++)
+					a(j, j, i) -= a(j, k, i) * a(j, k, i) * a(k, k, i);
+			}
+			for (std::size_t i = 0; i < Count; i++) {
+				valid[i] = Maths::Fast::Select(a(j, j, i) != 0, valid[i], T(0));
+				inverseDiagonal(j, i) = 1 / a(j, j, i);
+			}
+			for (std::size_t r = j + 1; r < N; r++) {
+				for (std::size_t k = 0; k < j; k++) {
+					for (std::size_t i = 0; i < Count; i++)
+						a(r, j, i) -= a(r, k, i) * a(j, k, i) * a(k, k, i);
+				}
+				for (std::size_t i = 0; i < Count; i++)
+					a(r, j, i) *= inverseDiagonal(j, i);
+			}
+		}
+	}
+
+	/**
+	 * Solves L * D * L^T * x = b for Count factored matrices, overwriting b(j, i) with x.
+	 */
+	template<std::size_t Count, typename A, typename D, typename B>
+	MATHSCPP_INLINE static void Substitute(A &&a, D &&inverseDiagonal, B &&b) {
+		for (std::size_t j = 0; j < N; j++) {
+			for (std::size_t k = 0; k < j; k++) {
+				for (std::size_t i = 0; i < Count; i++)
+					b(j, i) -= a(j, k, i) * b(k, i);
+			}
+		}
+		for (std::size_t j = 0; j < N; j++) {
+			for (std::size_t i = 0; i < Count; i++)
+				b(j, i) *= inverseDiagonal(j, i);
+		}
+		for (std::size_t j = N; j-- > 0;) {
+			for (std::size_t k = j + 1; k < N; k++) {
+				for (std::size_t i = 0; i < Count; i++)
+					b(j, i) -= a(k, j, i) * b(k, i);
+			}
+		}
+	}
+
+	Matrix<T, N, N> factor;
+	Vector<T, N> inverseDiagonal;
+	bool invertible = false;
+};
+
+/**
+ * @brief The Householder QR factorization of a matrix with M rows and N columns, M >= N, for least squares solutions.
+ * Each column below the diagonal is reflected to zero, the reflections are kept in place of the zeroed entries and R above them.
+ * Every loop has a compile time bound, so small systems unroll fully.
+ * @tparam T The value type.
+ * @tparam N The number of columns, the size of the solution.
+ * @tparam M The number of rows, the size of the right hand side.
+ */
+template<typename T, std::size_t N, std::size_t M>
+class HouseholderQR {
+	static_assert(std::is_floating_point_v<T>, "HouseholderQR needs a floating point type");
+	static_assert(M >= N, "HouseholderQR needs at least as many rows as columns");
+public:
+	HouseholderQR() = default;
+	/**
+	 * Factors a matrix.
+	 * @param matrix The matrix.
+	 */
+	explicit HouseholderQR(const Matrix<T, N, M> &matrix) : factor(matrix) {
+		Factor<1>(Detail::SystemAccess(factor), Detail::SystemAccess(betas), Detail::SystemAccess(inverseDiagonal));
+	}
+
+	/**
+	 * Gets if the columns are independent, when they are not the solutions are not finite.
+	 * @return If R has no zero on its diagonal.
+	 */
+	bool IsFullRank() const {
+		for (std::size_t j = 0; j < N; j++) {
+			if (!std::isfinite(inverseDiagonal[j]))
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Gets the upper triangular factor.
+	 * @return R.
+	 */
+	Matrix<T, N, N> GetUpper() const {
+		Matrix<T, N, N> result;
+		for (std::size_t j = 0; j < N; j++) {
+			result[j][j] = 1 / inverseDiagonal[j];
+			for (std::size_t k = j + 1; k < N; k++)
+				result[j][k] = factor[j][k];
+		}
+		return result;
+	}
+
+	/**
+	 * Finds the x that minimizes |matrix * x - vector|, the exact solution for square matrices.
+	 * @param vector The right hand side.
+	 * @return x.
+	 */
+	Vector<T, N> Solve(Vector<T, M> vector) const {
+		SolveInPlace(vector);
+		Vector<T, N> result;
+		for (std::size_t j = 0; j < N; j++)
+			result[j] = vector[j];
+		return result;
+	}
+
+	/**
+	 * Finds the x that minimizes |matrix * x - vector|, overwriting the first N entries of the vector with x.
+	 * @param vector The right hand side, then x followed by the residual in the reflected basis.
+	 */
+	void SolveInPlace(Vector<T, M> &vector) const {
+		Substitute<1>(Detail::SystemAccess(factor), Detail::SystemAccess(betas), Detail::SystemAccess(inverseDiagonal), Detail::SystemAccess(vector));
+	}
+
+	/**
+	 * Factors and solves many independent least squares problems, as Solve does for one, through Detail::SolveSystems.
+	 * @param matrices The matrices.
+	 * @param vectors The right hand sides, the same size as matrices.
+	 * @param results The solutions, the same size as matrices.
+	 * @param valid Set to whether each matrix was full rank, as IsFullRank, the same size as matrices or empty to skip it.
+	 */
+	static void Solve(Span<const Matrix<T, N, M>> matrices, Span<const Vector<T, M>> vectors, Span<Vector<T, N>> results, Span<bool> valid = {}) {
+		// The state holds the betas then the inverse diagonal of each block.
+		Detail::SolveSystems<false, T[2][N][Detail::SystemBlock]>(matrices, vectors, results, valid, [](auto &a, auto &state, auto &factored) {
+			Factor<Detail::SystemBlock>(Detail::SystemAccess(a), Detail::SystemAccess(state[0]), Detail::SystemAccess(state[1]));
+			for (std::size_t i = 0; i < Detail::SystemBlock; i++)
+				factored[i] = 1;
+			for (std::size_t j = 0; j < N; j++) {
+				for (std::size_t i = 0; i < Detail::SystemBlock; i++)
+					factored[i] = Maths::Fast::Select(std::abs(state[1][j][i]) <= std::numeric_limits<T>::max(), factored[i], T(0));
+			}
+		}, [](auto &a, auto &state, auto &b) {
+			Substitute<Detail::SystemBlock>(Detail::SystemAccess(a), Detail::SystemAccess(state[0]), Detail::SystemAccess(state[1]), Detail::SystemAccess(b));
+		});
+	}
+
+private:
+
+	/**
+	 * Factors Count matrices in place, a(j, k, i) being row j column k of matrix i.
+	 * Column k below the diagonal becomes the reflection vector v, with I - beta v v^T the reflection, and R goes above the diagonal.
+	 */
+	template<std::size_t Count, typename A, typename B, typename D>
+	MATHSCPP_INLINE static void Factor(A &&a, B &&betas, D &&inverseDiagonal) {
+		T dot[Count];
+		for (std::size_t k = 0; k < N; k++) {
+			for (std::size_t i = 0; i < Count; i++)
+				dot[i] = 0;
+			for (std::size_t r = k; r < M; r++) {
+				for (std::size_t i = 0; i < Count; i++)
+					dot[i] += a(r, k, i) * a(r, k, i);
+			}
+			for (std::size_t i = 0; i < Count; i++) {
+				// Reflecting onto the axis on the far side from the column keeps v = x - alpha e_k free of cancellation.
+				auto head = a(k, k, i);
+				auto alpha = -std::copysign(Maths::Fast::Sqrt<Maths::Precision::High>(dot[i]), head);
+				auto v = head - alpha;
+				a(k, k, i) = v;
+				// A zero column has a zero v, the smallest normal keeps beta finite so the reflection does nothing.
+				betas(k, i) = 2 / (dot[i] - head * head + v * v + std::numeric_limits<T>::min());
+				inverseDiagonal(k, i) = 1 / alpha;
+			}
+			for (std::size_t j = k + 1; j < N; j++) {
+				for (std::size_t i = 0; i < Count; i++)
+					dot[i] = 0;
+				for (std::size_t r = k; r < M; r++) {
+					for (std::size_t i = 0; i < Count; i++)
+						dot[i] += a(r, k, i) * a(r, j, i);
+				}
+				for (std::size_t r = k; r < M; r++) {
+					for (std::size_t i = 0; i < Count; i++)
+						a(r, j, i) -= betas(k, i) * dot[i] * a(r, k, i);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Applies the reflections to b(j, i) for Count factored matrices, then solves R * x = b over the first N entries.
+	 */
+	template<std::size_t Count, typename A, typename B, typename D, typename V>
+	MATHSCPP_INLINE static void Substitute(A &&a, B &&betas, D &&inverseDiagonal, V &&b) {
+		T dot[Count];
+		for (std::size_t k = 0; k < N; k++) {
+			for (std::size_t i = 0; i < Count; i++)
+				dot[i] = 0;
+			for (std::size_t r = k; r < M; r++) {
+				for (std::size_t i = 0; i < Count; i++)
+					dot[i] += a(r, k, i) * b(r, i);
+			}
+			for (std::size_t r = k; r < M; r++) {
+				for (std::size_t i = 0; i < Count; i++)
+					b(r, i) -= betas(k, i) * dot[i] * a(r, k, i);
+			}
+		}
+		for (std::size_t j = N; j-- > 0;) {
+			for (std::size_t k = j + 1; k < N; k++) {
+				for (std::size_t i = 0; i < Count; i++)
+					b(j, i) -= a(j, k, i) * b(k, i);
+			}
+			for (std::size_t i = 0; i < Count; i++)
+				b(j, i) *= inverseDiagonal(j, i);
+		}
+	}
+
+	Matrix<T, N, M> factor;
+	Vector<T, N> betas;
+	Vector<T, N> inverseDiagonal;
+};
+}
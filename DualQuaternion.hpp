@@ -0,0 +1,197 @@
+#pragma once
+
+#include "Quaternion.hpp"
+
+namespace MathsCPP {
+/**
+ * @brief A rigid transform as a dual quaternion, a rotation quaternion plus a dual part that carries the translation.
+ * Unlike matrices, normalized dual quaternions blend into another rigid transform, which is what dual quaternion skinning relies on.
+ * @tparam T The value type.
+ */
+template<typename T>
+class DualQuaternion {
+public:
+	constexpr DualQuaternion() = default;
+	constexpr DualQuaternion(const Quaternion<T> &real, const Quaternion<T> &dual) : real(real), dual(dual) {}
+	/**
+	 * Creates a transform that rotates and then translates.
+	 * @param rotation The rotation, must be normalized.
+	 * @param translation The translation.
+	 */
+	template<typename T1>
+	constexpr DualQuaternion(const Quaternion<T1> &rotation, const Vector<T1, 3> &translation) :
+		real(rotation),
+		dual(Quaternion<T>(translation.x, translation.y, translation.z, 0) * real * T(0.5)) {
+	}
+	template<typename T1>
+	constexpr DualQuaternion(const DualQuaternion<T1> &d) : real(d.real), dual(d.dual) {}
+
+	constexpr const T &at(std::size_t i) const { return i < 4 ? real[i] : dual[i - 4]; }
+	constexpr T &at(std::size_t i) { return i < 4 ? real[i] : dual[i - 4]; }
+
+	constexpr const T &operator[](std::size_t i) const { return at(i); }
+	constexpr T &operator[](std::size_t i) { return at(i); }
+
+	auto begin() { return &at(0); }
+	auto begin() const { return &at(0); }
+
+	auto end() { return &at(0) + 8; }
+	auto end() const { return &at(0) + 8; }
+
+	constexpr const Quaternion<T> &GetRotation() const { return real; }
+
+	/**
+	 * Gets the translation applied after the rotation.
+	 * @return The translation.
+	 */
+	constexpr Vector<T, 3> GetTranslation() const {
+		auto t = dual * real.Conjugate();
+		return {2 * t.x, 2 * t.y, 2 * t.z};
+	}
+
+	/**
+	 * Calculates the dot product of the rotation parts of this and another dual quaternion.
+	 * @param other The other dual quaternion.
+	 * @return The dot product.
+	 */
+	constexpr T Dot(const DualQuaternion &other) const {
+		return real.Dot(other.real);
+	}
+
+	/**
+	 * Gets the conjugate of both parts, for a normalized dual quaternion this is the inverse transform.
+	 * @return The conjugate.
+	 */
+	constexpr DualQuaternion Conjugate() const {
+		return {real.Conjugate(), dual.Conjugate()};
+	}
+
+	/**
+	 * Gets the unit dual quaternion of this dual quaternion, the dual part is also made orthogonal to the real part.
+	 * @return The normalized dual quaternion.
+	 */
+	auto Normalize() const {
+		auto length = real.Length();
+		auto r = real / length;
+		auto d = dual / length;
+		return DualQuaternion(r, d - r * r.Dot(d));
+	}
+
+	/**
+	 * Blends linearly to another dual quaternion along the shortest path and normalizes, the blend used by dual quaternion skinning.
+	 * @param other The other dual quaternion.
+	 * @param t The progression.
+	 * @return Left blended with right.
+	 */
+	template<typename T1>
+	auto Lerp(const DualQuaternion &other, T1 t) const {
+		auto scale = Dot(other) < 0 ? -t : t;
+		return DualQuaternion(real * (1 - t) + other.real * scale, dual * (1 - t) + other.dual * scale).Normalize();
+	}
+
+	/**
+	 * Converts this dual quaternion to a 4x4 matrix that transforms column vectors, as Matrix * Vector does.
+	 * @return The transform matrix.
+	 */
+	auto ToMatrix() const {
+		return Matrix<T, 4, 4>::FromTRS(GetTranslation(), real);
+	}
+
+	/**
+	 * Rotates a direction, the translation is ignored.
+	 * @param direction The direction.
+	 * @return The rotated direction.
+	 */
+	template<typename T1>
+	constexpr auto Rotate(const Vector<T1, 3> &direction) const {
+		return real * direction;
+	}
+
+	template<typename T1>
+	constexpr friend auto operator==(const DualQuaternion &lhs, const DualQuaternion<T1> &rhs) {
+		return lhs.real == rhs.real && lhs.dual == rhs.dual;
+	}
+
+	template<typename T1>
+	constexpr friend auto operator!=(const DualQuaternion &lhs, const DualQuaternion<T1> &rhs) {
+		return !(lhs == rhs);
+	}
+
+	constexpr friend auto operator-(const DualQuaternion &lhs) {
+		return DualQuaternion(-lhs.real, -lhs.dual);
+	}
+
+	template<typename T1>
+	constexpr friend auto operator+(const DualQuaternion &lhs, const DualQuaternion<T1> &rhs) {
+		return DualQuaternion<decltype(lhs[0] + rhs[0])>(lhs.real + rhs.real, lhs.dual + rhs.dual);
+	}
+
+	template<typename T1>
+	constexpr friend auto operator-(const DualQuaternion &lhs, const DualQuaternion<T1> &rhs) {
+		return DualQuaternion<decltype(lhs[0] - rhs[0])>(lhs.real - rhs.real, lhs.dual - rhs.dual);
+	}
+
+	/// Composes two transforms, the right transform is applied first.
+	template<typename T1>
+	constexpr friend auto operator*(const DualQuaternion &lhs, const DualQuaternion<T1> &rhs) {
+		return DualQuaternion<decltype(lhs[0] * rhs[0])>(lhs.real * rhs.real, lhs.real * rhs.dual + lhs.dual * rhs.real);
+	}
+
+	/// Transforms a point, rotating and then translating it.
+	template<typename T1>
+	constexpr friend auto operator*(const DualQuaternion &lhs, const Vector<T1, 3> &rhs) {
+		return lhs.real * rhs + lhs.GetTranslation();
+	}
+
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
+	constexpr friend auto operator*(const DualQuaternion &lhs, T1 rhs) {
+		return DualQuaternion<decltype(lhs[0] * rhs)>(lhs.real * rhs, lhs.dual * rhs);
+	}
+
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
+	constexpr friend auto operator*(T1 lhs, const DualQuaternion &rhs) {
+		return DualQuaternion<decltype(lhs * rhs[0])>(lhs * rhs.real, lhs * rhs.dual);
+	}
+
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
+	constexpr friend auto operator/(const DualQuaternion &lhs, T1 rhs) {
+		return DualQuaternion<decltype(lhs[0] / rhs)>(lhs.real / rhs, lhs.dual / rhs);
+	}
+
+	template<typename T1>
+	constexpr friend auto operator+=(DualQuaternion &lhs, const T1 &rhs) {
+		return lhs = lhs + rhs;
+	}
+
+	template<typename T1>
+	constexpr friend auto operator-=(DualQuaternion &lhs, const T1 &rhs) {
+		return lhs = lhs - rhs;
+	}
+
+	template<typename T1>
+	constexpr friend auto operator*=(DualQuaternion &lhs, const T1 &rhs) {
+		return lhs = lhs * rhs;
+	}
+
+	template<typename T1>
+	constexpr friend auto operator/=(DualQuaternion &lhs, const T1 &rhs) {
+		return lhs = lhs / rhs;
+	}
+
+	friend std::ostream &operator<<(std::ostream &stream, const DualQuaternion &dualQuaternion) {
+		return stream << dualQuaternion.real << ", " << dualQuaternion.dual;
+	}
+
+	Quaternion<T> real;
+	Quaternion<T> dual{0, 0, 0, 0};
+};
+
+template<typename T>
+struct ArrayTraits<DualQuaternion<T>> {
+	using Value = T;
+	static constexpr std::size_t Count = 8;
+};
+
+using DualQuaternionf = DualQuaternion<float>;
+using DualQuaterniond = DualQuaternion<double>;
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <functional>
+#include <type_traits>
+
+#include "Vector.hpp"
+#include "Matrix.hpp"
+
+namespace MathsCPP {
+/**
+ * @brief Describes a container that lazy expressions can read from and evaluate into, as a flat array of values.
+ * @tparam C The container type.
+ */
+template<typename C>
+struct ExpressionTraits {
+	static constexpr bool IsContainer = false;
+};
+
+template<typename T, std::size_t N>
+struct ExpressionTraits<Vector<T, N>> {
+	static constexpr bool IsContainer = true;
+	/// Vectors multiply and divide element-wise, so products of two vectors can be lazy too.
+	static constexpr bool ElementwiseProduct = true;
+	static constexpr std::size_t Size = N;
+	template<typename U>
+	using Rebind = Vector<U, N>;
+
+	static const T *Data(const Vector<T, N> &vector) { return &vector[0]; }
+	static T *Data(Vector<T, N> &vector) { return &vector[0]; }
+};
+
+template<typename T, std::size_t N, std::size_t M>
+struct ExpressionTraits<Matrix<T, N, M>> {
+	static constexpr bool IsContainer = true;
+	/// Matrix products are not element-wise, only scalars may multiply or divide a lazy matrix.
+	static constexpr bool ElementwiseProduct = false;
+	static constexpr std::size_t Size = N * M;
+	template<typename U>
+	using Rebind = Matrix<U, N, M>;
+
+	static const T *Data(const Matrix<T, N, M> &matrix) { return &matrix[0][0]; }
+	static T *Data(Matrix<T, N, M> &matrix) { return &matrix[0][0]; }
+};
+
+/**
+ * @brief Holds an element-wise operation over vectors or matrices without computing it, chains of operations
+ * fuse into a single loop once the expression is converted or evaluated into a container.
+ * Expressions refer to the containers they were built from, so evaluate them before those containers go out of scope
+ * and do not store them in auto variables that outlive the statement.
+ * @tparam C The container type the expression evaluates to.
+ * @tparam Eval Invocable as eval(i), giving element i.
+ */
+template<typename C, typename Eval>
+class Expression {
+public:
+	using Traits = ExpressionTraits<C>;
+
+	constexpr explicit Expression(Eval eval) : eval(eval) {}
+
+	constexpr auto operator[](std::size_t i) const { return eval(i); }
+
+	constexpr auto size() const { return Traits::Size; }
+
+	/**
+	 * Computes this expression into a container in one pass. Each element only reads the same element of its operands,
+	 * so the container may also appear in this expression.
+	 * @tparam C1 A container with the same shape, values are cast to its value type.
+	 * @param result The container to write to.
+	 */
+	template<typename C1>
+	constexpr void EvaluateTo(C1 &result) const {
+		static_assert(std::is_same_v<typename Traits::template Rebind<char>, typename ExpressionTraits<C1>::template Rebind<char>>,
+			"Expressions evaluate into containers of the same shape");
+		auto data = ExpressionTraits<C1>::Data(result);
+		using Value = std::remove_reference_t<decltype(*data)>;
+		for (std::size_t i = 0; i < Traits::Size; i++)
+			data[i] = static_cast<Value>(eval(i));
+	}
+
+	/**
+	 * Computes this expression into a new container.
+	 * @return The container.
+	 */
+	constexpr C Evaluate() const {
+		C result;
+		EvaluateTo(result);
+		return result;
+	}
+
+	template<typename C1, typename = std::enable_if_t<ExpressionTraits<C1>::IsContainer>,
+		typename = std::enable_if_t<std::is_same_v<typename Traits::template Rebind<char>, typename ExpressionTraits<C1>::template Rebind<char>>>>
+	constexpr operator C1() const {
+		C1 result;
+		EvaluateTo(result);
+		return result;
+	}
+
+private:
+	Eval eval;
+};
+
+template<typename E>
+struct IsExpression : std::false_type {};
+template<typename C, typename Eval>
+struct IsExpression<Expression<C, Eval>> : std::true_type {};
+
+/**
+ * Starts a lazy expression from a vector or matrix, operations with the result build expressions instead of containers.
+ * @param container The vector or matrix, it must outlive the expression.
+ * @return The expression.
+ */
+template<typename C, typename = std::enable_if_t<ExpressionTraits<C>::IsContainer>>
+constexpr auto Lazy(const C &container) {
+	auto data = ExpressionTraits<C>::Data(container);
+	auto eval = [data](std::size_t i) { return data[i]; };
+	return Expression<C, decltype(eval)>(eval);
+}
+
+namespace Detail {
+template<typename T>
+struct ScalarOperand {
+	constexpr T operator[](std::size_t) const { return value; }
+	T value;
+};
+
+/// Containers and expressions give their element type, scalars give themselves.
+template<typename T, typename = void>
+struct OperandShape {
+	using Type = void;
+};
+template<typename C, typename Eval>
+struct OperandShape<Expression<C, Eval>> {
+	using Type = C;
+};
+template<typename C>
+struct OperandShape<C, std::enable_if_t<ExpressionTraits<C>::IsContainer>> {
+	using Type = C;
+};
+
+template<typename T>
+constexpr auto MakeOperand(const T &value) {
+	if constexpr (IsExpression<T>::value)
+		return value;
+	else if constexpr (is_number_v<T>)
+		return ScalarOperand<T>{value};
+	else
+		return Lazy(value);
+}
+
+/**
+ * Binary operations are lazy when one side is an expression and the other side is an expression, a container
+ * of the same shape, or a scalar. Products of two matrices are left to the eager matrix product.
+ */
+template<typename L, typename R, bool Product>
+constexpr bool IsLazyBinary() {
+	if constexpr (!IsExpression<L>::value && !IsExpression<R>::value) {
+		return false;
+	} else {
+		using LShape = typename OperandShape<L>::Type;
+		using RShape = typename OperandShape<R>::Type;
+		if constexpr (std::is_void_v<LShape> || std::is_void_v<RShape>) {
+			return (!std::is_void_v<LShape> || is_number_v<L>) && (!std::is_void_v<RShape> || is_number_v<R>);
+		} else {
+			return std::is_same_v<typename ExpressionTraits<LShape>::template Rebind<char>, typename ExpressionTraits<RShape>::template Rebind<char>> &&
+				(!Product || ExpressionTraits<LShape>::ElementwiseProduct);
+		}
+	}
+}
+
+template<typename L, typename R, typename Op>
+constexpr auto MakeBinary(const L &lhs, const R &rhs, Op op) {
+	using Shape = std::conditional_t<std::is_void_v<typename OperandShape<L>::Type>, typename OperandShape<R>::Type, typename OperandShape<L>::Type>;
+	auto l = MakeOperand(lhs);
+	auto r = MakeOperand(rhs);
+	auto eval = [l, r, op](std::size_t i) { return op(l[i], r[i]); };
+	using Result = typename ExpressionTraits<Shape>::template Rebind<decltype(eval(0))>;
+	return Expression<Result, decltype(eval)>(eval);
+}
+}
+
+template<typename L, typename R, typename = std::enable_if_t<Detail::IsLazyBinary<L, R, false>()>>
+constexpr auto operator+(const L &lhs, const R &rhs) {
+	return Detail::MakeBinary(lhs, rhs, std::plus<>());
+}
+
+template<typename L, typename R, typename = std::enable_if_t<Detail::IsLazyBinary<L, R, false>()>>
+constexpr auto operator-(const L &lhs, const R &rhs) {
+	return Detail::MakeBinary(lhs, rhs, std::minus<>());
+}
+
+template<typename L, typename R, typename = std::enable_if_t<Detail::IsLazyBinary<L, R, true>()>>
+constexpr auto operator*(const L &lhs, const R &rhs) {
+	return Detail::MakeBinary(lhs, rhs, std::multiplies<>());
+}
+
+template<typename L, typename R, typename = std::enable_if_t<Detail::IsLazyBinary<L, R, true>()>>
+constexpr auto operator/(const L &lhs, const R &rhs) {
+	return Detail::MakeBinary(lhs, rhs, std::divides<>());
+}
+
+template<typename C, typename Eval>
+constexpr auto operator-(const Expression<C, Eval> &expression) {
+	auto eval = [expression](std::size_t i) { return -expression[i]; };
+	using Result = typename ExpressionTraits<C>::template Rebind<decltype(eval(0))>;
+	return Expression<Result, decltype(eval)>(eval);
+}
+}
@@ -0,0 +1,538 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+#include "Maths.hpp"
+#include "Parallel.hpp"
+
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+
+namespace MathsCPP {
+namespace Detail {
+/// The integer type twice as wide as a fixed point value, products and quotients are taken in it without overflow.
+template<bool Narrow>
+struct FixedWide;
+
+template<>
+struct FixedWide<true> {
+	using Type = int64_t;
+};
+
+#ifdef __SIZEOF_INT128__
+template<>
+struct FixedWide<false> {
+	__extension__ typedef __int128 Type;
+};
+#endif
+
+/**
+ * Polynomials for the fixed point trigonometry, fitted so their error stays below the precision of the internal format.
+ * Sin is sin(pi / 2 * x) as x * P(x^2) for x in [0, 1], Atan is atan(x) as x * P(x^2) for x in [0, tan(pi / 8)].
+ */
+template<std::size_t Bits>
+struct FixedCoefficients;
+
+template<>
+struct FixedCoefficients<32> {
+	static constexpr double Sin[] = {1.5707962900318295, -0.6459633599563046, 0.07968848079611952, -0.004672228199508375, 0.00015082066452068503};
+	static constexpr double Atan[] = {0.9999999056022576, -0.3333220418971221, 0.1996196724936961, -0.1375482157997718, 0.07734578338891246};
+};
+
+template<>
+struct FixedCoefficients<64> {
+	static constexpr double Sin[] = {1.5707963267943073, -0.6459640974842167, 0.07969262600790536, -0.004681752998769235, 0.0001604384000042676,
+		-3.5951842414437544e-06, 5.4465048664969866e-08};
+	static constexpr double Atan[] = {0.9999999999941753, -0.3333333316751789, 0.19999986209954296, -0.1428519755979223, 0.11100775195047222,
+		-0.08972160616237355, 0.06895186684900323, -0.036430071442447934};
+};
+}
+
+/**
+ * @brief A signed fixed point number for simulations that must give the same results on every machine, such as lockstep
+ * networking. Arithmetic, sin, cos, atan2 and acos are integer arithmetic, so results only depend on the inputs. Sqrt starts from
+ * a std::sqrt guess in double and then corrects it with integer checks to the exact floor of the root, the same bits on every
+ * target whatever the guess rounded to.
+ * Sin and cos of Fixed16x16 are within about half an ulp for small angles, the rounding of 1 / (2 pi) adds error in proportion
+ * to the angle, up to about 1.8 ulp as |angle| nears 32768.
+ * Products round to nearest, quotients truncate toward zero, and results past the range wrap.
+ * @tparam IntBits The integer bits, including the sign bit.
+ * @tparam FracBits The fraction bits, with IntBits 32 or 64 bits in total. 64 bit values need a 128 bit integer type.
+ */
+template<std::size_t IntBits, std::size_t FracBits>
+class Fixed {
+	static_assert(IntBits >= 2 && (IntBits + FracBits == 32 || IntBits + FracBits == 64), "Fixed point values are 32 or 64 bits with at least one integer bit");
+public:
+	using Raw = std::conditional_t<IntBits + FracBits == 32, int32_t, int64_t>;
+	using Wide = typename Detail::FixedWide<IntBits + FracBits == 32>::Type;
+
+	constexpr Fixed() = default;
+	/**
+	 * Converts a number, floating point values round to nearest. Integers past the range wrap like the arithmetic,
+	 * floating point values past it saturate and NaN gives zero.
+	 */
+	template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+	constexpr Fixed(T value) : raw(FromArithmetic(value)) {}
+
+	/**
+	 * Creates a value from its underlying integer.
+	 * @param raw The integer, the value times 2 to the power of FracBits.
+	 * @return The value.
+	 */
+	static constexpr Fixed FromRaw(Raw raw) {
+		Fixed result;
+		result.raw = raw;
+		return result;
+	}
+
+	constexpr Raw GetRaw() const { return raw; }
+
+	/**
+	 * Converts to a number, floating point types get the nearest value and integer types truncate toward zero.
+	 */
+	template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+	constexpr explicit operator T() const {
+		if constexpr (std::is_floating_point_v<T>)
+			return static_cast<T>(raw) / static_cast<T>(One);
+		else
+			return static_cast<T>(raw / One);
+	}
+
+	constexpr Fixed operator+() const { return *this; }
+	// Sums and negation are taken in the unsigned type, where they wrap instead of overflowing.
+	constexpr Fixed operator-() const { return FromRaw(static_cast<Raw>(Unsigned(0) - static_cast<Unsigned>(raw))); }
+
+	constexpr friend Fixed operator+(Fixed lhs, Fixed rhs) { return FromRaw(static_cast<Raw>(static_cast<Unsigned>(lhs.raw) + static_cast<Unsigned>(rhs.raw))); }
+	constexpr friend Fixed operator-(Fixed lhs, Fixed rhs) { return FromRaw(static_cast<Raw>(static_cast<Unsigned>(lhs.raw) - static_cast<Unsigned>(rhs.raw))); }
+	constexpr friend Fixed operator*(Fixed lhs, Fixed rhs) { return FromRaw(Multiply(lhs.raw, rhs.raw)); }
+	/// The divisor must not be zero.
+	constexpr friend Fixed operator/(Fixed lhs, Fixed rhs) { return FromRaw(Divide(lhs.raw, rhs.raw)); }
+
+	constexpr Fixed &operator+=(Fixed rhs) { return *this = *this + rhs; }
+	constexpr Fixed &operator-=(Fixed rhs) { return *this = *this - rhs; }
+	constexpr Fixed &operator*=(Fixed rhs) { return *this = *this * rhs; }
+	constexpr Fixed &operator/=(Fixed rhs) { return *this = *this / rhs; }
+
+	constexpr friend bool operator==(Fixed lhs, Fixed rhs) { return lhs.raw == rhs.raw; }
+	constexpr friend bool operator!=(Fixed lhs, Fixed rhs) { return lhs.raw != rhs.raw; }
+	constexpr friend bool operator<(Fixed lhs, Fixed rhs) { return lhs.raw < rhs.raw; }
+	constexpr friend bool operator<=(Fixed lhs, Fixed rhs) { return lhs.raw <= rhs.raw; }
+	constexpr friend bool operator>(Fixed lhs, Fixed rhs) { return lhs.raw > rhs.raw; }
+	constexpr friend bool operator>=(Fixed lhs, Fixed rhs) { return lhs.raw >= rhs.raw; }
+
+	friend std::ostream &operator<<(std::ostream &stream, Fixed value) {
+		return stream << static_cast<double>(value);
+	}
+
+	/*
+	 * The maths functions are found by argument dependent lookup, generic code reaches them with using std::sqrt then sqrt(x).
+	 */
+
+	constexpr friend Fixed abs(Fixed value) { return value.raw < 0 ? -value : value; }
+
+	/**
+	 * Takes the square root, rounded down to the nearest value. Negative values give zero.
+	 */
+	friend Fixed sqrt(Fixed value) { return FromRaw(SquareRoot(value.raw)); }
+
+	friend Fixed sin(Fixed angle) {
+		Raw s, c;
+		SinCos(angle.raw, s, c);
+		return FromRaw(s);
+	}
+
+	friend Fixed cos(Fixed angle) {
+		Raw s, c;
+		SinCos(angle.raw, s, c);
+		return FromRaw(c);
+	}
+
+	/**
+	 * Gets the angle of a point from the positive x axis, in radians from -pi to pi, zero at the origin.
+	 */
+	friend Fixed atan2(Fixed y, Fixed x) { return FromRaw(ArcTangent(y.raw, x.raw)); }
+
+	/**
+	 * Gets the angle with a cosine, values past [-1, 1] are clamped.
+	 */
+	friend Fixed acos(Fixed value) {
+		auto x = std::clamp(value, Fixed(-1), Fixed(1));
+		return atan2(sqrt((1 - x) * (1 + x)), x);
+	}
+
+	friend Fixed asin(Fixed value) {
+		auto x = std::clamp(value, Fixed(-1), Fixed(1));
+		return atan2(x, sqrt((1 - x) * (1 + x)));
+	}
+
+	/*
+	 * The batch kernels give the same bits as the scalar functions. 32 bit values run four lanes at a time with SSE2.
+	 * Batch SinCos of Fixed16x16 is about as fast as float std::sin and std::cos.
+	 */
+
+	/**
+	 * Multiplies many pairs of values.
+	 * @param lhs The left values.
+	 * @param rhs The right values, the same size as lhs.
+	 * @param result The products, the same size as lhs, it may be the same memory as either input.
+	 */
+	static void Multiply(Span<const Fixed> lhs, Span<const Fixed> rhs, Span<Fixed> result) {
+		Parallel::For(0, lhs.size(), BatchGrain, [&](std::size_t begin, std::size_t end) {
+			auto i = begin;
+#ifdef MATHSCPP_SSE2
+			if constexpr (Bits == 32)
+				i += PackedMultiply(&lhs[i].raw, &rhs[i].raw, &result[i].raw, end - i);
+#endif
+			for (; i < end; i++)
+				result[i].raw = Multiply(lhs[i].raw, rhs[i].raw);
+		});
+	}
+
+	/**
+	 * Takes the square roots of many values.
+	 * @param values The values.
+	 * @param result The square roots, the same size as values, it may be the same memory.
+	 */
+	static void Sqrt(Span<const Fixed> values, Span<Fixed> result) {
+		Parallel::For(0, values.size(), BatchGrain, [&](std::size_t begin, std::size_t end) {
+			auto i = begin;
+#ifdef MATHSCPP_SSE2
+			if constexpr (Bits == 32 && FracBits <= 21)
+				i += PackedSqrt(&values[i].raw, &result[i].raw, end - i);
+#endif
+			for (; i < end; i++)
+				result[i].raw = SquareRoot(values[i].raw);
+		});
+	}
+
+	/**
+	 * Takes the sines and cosines of many angles.
+	 * @param angles The angles, in radians.
+	 * @param sines The sines, the same size as angles.
+	 * @param cosines The cosines, the same size as angles.
+	 */
+	static void SinCos(Span<const Fixed> angles, Span<Fixed> sines, Span<Fixed> cosines) {
+		Parallel::For(0, angles.size(), BatchGrain, [&](std::size_t begin, std::size_t end) {
+			auto i = begin;
+#ifdef MATHSCPP_SSE2
+			if constexpr (Bits == 32)
+				i += PackedSinCos(&angles[i].raw, &sines[i].raw, &cosines[i].raw, end - i);
+#endif
+			for (; i < end; i++)
+				SinCos(angles[i].raw, sines[i].raw, cosines[i].raw);
+		});
+	}
+
+private:
+	using Unsigned = std::make_unsigned_t<Raw>;
+
+	static constexpr std::size_t Bits = sizeof(Raw) * 8;
+	/// Fraction bits of the internal trigonometry format, values in [-2, 2).
+	static constexpr std::size_t InternalBits = Bits - 2;
+	static constexpr Raw One = Raw(1) << FracBits;
+	/// Larger than the vector grains, most batch operations here are a few integer instructions per value.
+	static constexpr std::size_t BatchGrain = 1 << 16;
+
+	template<typename T>
+	static constexpr Raw FromArithmetic(T value) {
+		if constexpr (std::is_integral_v<T>) {
+			// Shifted in the unsigned type so the integer bits that do not fit wrap away.
+			return static_cast<Raw>(static_cast<Unsigned>(value) << FracBits);
+		} else {
+			// Scaling by a power of two is exact, so rounding half away from zero only depends on the value.
+			auto scaled = static_cast<long double>(value) * One;
+			if (scaled != scaled)
+				return 0;
+			if (scaled >= static_cast<long double>(std::numeric_limits<Raw>::max()))
+				return std::numeric_limits<Raw>::max();
+			if (scaled <= static_cast<long double>(std::numeric_limits<Raw>::min()))
+				return std::numeric_limits<Raw>::min();
+			auto truncated = static_cast<Raw>(scaled);
+			auto fraction = scaled - truncated;
+			return static_cast<Raw>(truncated + (fraction >= 0.5L) - (fraction <= -0.5L));
+		}
+	}
+
+	/// Shifts right rounding to nearest, shifts of zero or less shift left.
+	template<int Shift>
+	static constexpr Wide RoundShift(Wide value) {
+		if constexpr (Shift > 0)
+			return (value + (Wide(1) << (Shift - 1))) >> Shift;
+		else
+			return value * (Wide(1) << -Shift);
+	}
+
+	static constexpr Raw Multiply(Raw lhs, Raw rhs) {
+		return static_cast<Raw>(RoundShift<FracBits>(static_cast<Wide>(lhs) * rhs));
+	}
+
+	static constexpr Raw Divide(Raw lhs, Raw rhs) {
+		return static_cast<Raw>(static_cast<Wide>(lhs) * One / rhs);
+	}
+
+	static MATHSCPP_INLINE Raw SquareRoot(Raw raw) {
+		if (raw <= 0)
+			return 0;
+		// A floating point guess is within one of the root for 32 bit values, 64 bit values take a Newton step first.
+		// The integer checks then give the exact floor, whatever the guess rounded to.
+		auto square = static_cast<Wide>(raw) * One;
+		auto root = static_cast<Wide>(std::sqrt(static_cast<double>(raw) * static_cast<double>(One)));
+		if constexpr (Bits == 64)
+			root = (root + square / root) / 2;
+		root -= root * root > square;
+		root += (root + 1) * (root + 1) <= square;
+		return static_cast<Raw>(root);
+	}
+
+	/// Converts a constant to the internal format.
+	static constexpr Raw Internal(double value) {
+		return static_cast<Raw>(value * static_cast<double>(Wide(1) << InternalBits) + (value < 0 ? -0.5 : 0.5));
+	}
+
+	template<std::size_t Count>
+	static constexpr std::array<Raw, Count> Internal(const double (&values)[Count]) {
+		std::array<Raw, Count> result{};
+		for (std::size_t i = 0; i < Count; i++)
+			result[i] = Internal(values[i]);
+		return result;
+	}
+
+	/// The polynomials in the internal format, converted at compile time so every platform gets the same bits.
+	/// The sine coefficients alternate in sign and are kept as magnitudes, see SinUnit.
+	static constexpr auto SinPolynomial = [] {
+		auto coefficients = Internal(Detail::FixedCoefficients<Bits>::Sin);
+		for (auto &coefficient : coefficients)
+			coefficient = coefficient < 0 ? -coefficient : coefficient;
+		return coefficients;
+	}();
+	/// One over 2 pi as a fraction of 2 to the power of Bits.
+	static constexpr auto InvTwoPi = static_cast<Wide>(static_cast<double>(Wide(1) << (Bits - 2)) * 4.0 / (2.0 * 3.14159265358979323846) + 0.5);
+	static constexpr auto AtanPolynomial = Internal(Detail::FixedCoefficients<Bits>::Atan);
+
+	static constexpr MATHSCPP_INLINE Raw MultiplyInternal(Raw lhs, Raw rhs) {
+		return static_cast<Raw>((static_cast<Wide>(lhs) * rhs) >> InternalBits);
+	}
+
+	/// Evaluates x * P(x^2) with coefficients in the internal format.
+	template<std::size_t Count>
+	static constexpr MATHSCPP_INLINE Raw OddPolynomial(Raw x, const std::array<Raw, Count> &coefficients) {
+		auto x2 = MultiplyInternal(x, x);
+		auto result = coefficients[Count - 1];
+		for (std::size_t i = Count - 1; i-- > 0;)
+			result = coefficients[i] + MultiplyInternal(result, x2);
+		return MultiplyInternal(result, x);
+	}
+
+	/**
+	 * Evaluates sin(pi / 2 * x) for x in [0, 1] in the internal format, as x * (c0 - x^2 * (c1 - x^2 * (c2 - ...))).
+	 * The magnitudes shrink fast enough that every step stays positive, so the packed kernel multiplies without sign corrections.
+	 */
+	static constexpr MATHSCPP_INLINE Raw SinUnit(Raw x) {
+		auto x2 = MultiplyInternal(x, x);
+		auto result = SinPolynomial.back();
+		for (std::size_t i = SinPolynomial.size() - 1; i-- > 0;)
+			result = SinPolynomial[i] - MultiplyInternal(result, x2);
+		return MultiplyInternal(result, x);
+	}
+
+	static MATHSCPP_INLINE void SinCos(Raw angle, Raw &sine, Raw &cosine) {
+		// Turns are the angle over 2 pi with the integer part wrapped away, an exact range reduction for every input.
+		auto turns = static_cast<Unsigned>((static_cast<Wide>(angle) * InvTwoPi) >> FracBits);
+		auto quadrant = static_cast<Raw>(turns >> InternalBits);
+		auto x = static_cast<Raw>(turns & ((Unsigned(1) << InternalBits) - 1));
+
+		auto s = SinUnit(x);
+		auto c = SinUnit((Raw(1) << InternalBits) - x);
+		// Odd quadrants swap sine and cosine, the sine is negative in the lower half and the cosine in the left half.
+		auto swap = quadrant & 1;
+		auto negateSine = -(quadrant >> 1);
+		auto negateCosine = -((quadrant ^ (quadrant >> 1)) & 1);
+		auto rotatedSine = swap ? c : s, rotatedCosine = swap ? s : c;
+		sine = static_cast<Raw>(RoundShift<int(InternalBits) - int(FracBits)>((rotatedSine ^ negateSine) - negateSine));
+		cosine = static_cast<Raw>(RoundShift<int(InternalBits) - int(FracBits)>((rotatedCosine ^ negateCosine) - negateCosine));
+	}
+
+	static Raw ArcTangent(Raw y, Raw x) {
+		constexpr auto QuarterPi = Internal(3.14159265358979323846 / 4);
+		constexpr auto TanEighthPi = Internal(0.41421356237309504880);
+		auto ax = static_cast<Wide>(x < 0 ? -static_cast<Wide>(x) : x), ay = static_cast<Wide>(y < 0 ? -static_cast<Wide>(y) : y);
+		auto low = std::min(ax, ay), high = std::max(ax, ay);
+		if (high == 0)
+			return 0;
+		// The ratio is reduced past tan(pi / 8) with atan(t) = pi / 4 + atan((t - 1) / (t + 1)), quotients taken in the internal format.
+		auto t = static_cast<Raw>(low * (Wide(1) << InternalBits) / high);
+		auto reduced = t > TanEighthPi;
+		if (reduced)
+			t = static_cast<Raw>((low - high) * (Wide(1) << InternalBits) / (low + high));
+		auto result = static_cast<Wide>(OddPolynomial(t, AtanPolynomial)) + (reduced ? QuarterPi : 0);
+		// Octants past the diagonal, the left half and the lower half reflect the angle, using pi / 4 steps which stay in range.
+		if (ay > ax)
+			result = 2 * static_cast<Wide>(QuarterPi) - result;
+		if (x < 0)
+			result = 4 * static_cast<Wide>(QuarterPi) - result;
+		if (y < 0)
+			result = -result;
+		return static_cast<Raw>(RoundShift<int(InternalBits) - int(FracBits)>(result));
+	}
+
+#ifdef MATHSCPP_SSE2
+	/**
+	 * Multiplies signed 32 bit lanes into 64 bits, adds a rounding term and keeps bits [Shift, Shift + 32) of each sum,
+	 * the same bits the scalar casts keep. SSE2 only multiplies unsigned lanes, so the high halves are corrected for negative inputs.
+	 */
+	template<int Shift>
+	static MATHSCPP_INLINE __m128i MultiplyShift(__m128i lhs, __m128i rhs, __m128i round) {
+#ifdef __SSE4_1__
+		auto even = _mm_add_epi64(_mm_mul_epi32(lhs, rhs), round);
+		auto odd = _mm_add_epi64(_mm_mul_epi32(_mm_srli_epi64(lhs, 32), _mm_srli_epi64(rhs, 32)), round);
+#else
+		auto even = _mm_add_epi64(_mm_mul_epu32(lhs, rhs), round);
+		auto odd = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(lhs, 32), _mm_srli_epi64(rhs, 32)), round);
+		auto correction = _mm_add_epi32(_mm_and_si128(_mm_srai_epi32(lhs, 31), rhs), _mm_and_si128(_mm_srai_epi32(rhs, 31), lhs));
+		even = _mm_sub_epi64(even, _mm_slli_epi64(correction, 32));
+		odd = _mm_sub_epi64(odd, _mm_and_si128(correction, _mm_set_epi32(-1, 0, -1, 0)));
+#endif
+		return _mm_or_si128(_mm_and_si128(_mm_srli_epi64(even, Shift), _mm_set_epi32(0, -1, 0, -1)), _mm_slli_epi64(_mm_srli_epi64(odd, Shift), 32));
+	}
+
+	/**
+	 * Multiplies non-negative 32 bit lanes and keeps bits [Shift, Shift + 32) of each product, as MultiplyShift does without
+	 * the sign corrections or rounding.
+	 */
+	template<int Shift>
+	static MATHSCPP_INLINE __m128i MultiplyShiftPositive(__m128i lhs, __m128i rhs) {
+		auto even = _mm_mul_epu32(lhs, rhs);
+		auto odd = _mm_mul_epu32(_mm_srli_epi64(lhs, 32), _mm_srli_epi64(rhs, 32));
+		return _mm_or_si128(_mm_and_si128(_mm_srli_epi64(even, Shift), _mm_set_epi32(0, -1, 0, -1)), _mm_slli_epi64(_mm_srli_epi64(odd, Shift), 32));
+	}
+
+	static std::size_t PackedMultiply(const Raw *lhs, const Raw *rhs, Raw *result, std::size_t count) {
+		auto round = _mm_set1_epi64x(FracBits > 0 ? int64_t(1) << (FracBits - 1) : 0);
+		std::size_t i = 0;
+		for (; i < (count & ~std::size_t(3)); i += 4) {
+			auto product = MultiplyShift<FracBits>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + i)),
+				_mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i)), round);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(result + i), product);
+		}
+		return i;
+	}
+
+	/**
+	 * With at most 21 fraction bits a value shifted by the fraction fits a double exactly, so the root and the check
+	 * that it is not one too high are exact in packed doubles.
+	 */
+	static std::size_t PackedSqrt(const Raw *values, Raw *result, std::size_t count) {
+		auto scale = _mm_set1_pd(static_cast<double>(One));
+		std::size_t i = 0;
+		for (; i < (count & ~std::size_t(1)); i += 2) {
+			auto raw = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(values + i));
+			raw = _mm_andnot_si128(_mm_srai_epi32(raw, 31), raw);
+			auto square = _mm_mul_pd(_mm_cvtepi32_pd(raw), scale);
+			auto root = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_sqrt_pd(square)));
+			root = _mm_sub_pd(root, _mm_and_pd(_mm_cmpgt_pd(_mm_mul_pd(root, root), square), _mm_set1_pd(1.0)));
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(result + i), _mm_cvttpd_epi32(root));
+		}
+		return i;
+	}
+
+	static std::size_t PackedSinCos(const Raw *angles, Raw *sines, Raw *cosines, std::size_t count) {
+		constexpr auto Shift = int(InternalBits) - int(FracBits);
+		auto zero = _mm_setzero_si128(), one = _mm_set1_epi32(1);
+		auto round = Shift > 0 ? _mm_set1_epi32(1 << (Shift > 0 ? Shift - 1 : 0)) : zero;
+		auto polynomial = [](__m128i x) {
+			auto x2 = MultiplyShiftPositive<InternalBits>(x, x);
+			auto result = _mm_set1_epi32(SinPolynomial.back());
+			for (std::size_t j = SinPolynomial.size() - 1; j-- > 0;)
+				result = _mm_sub_epi32(_mm_set1_epi32(SinPolynomial[j]), MultiplyShiftPositive<InternalBits>(result, x2));
+			return MultiplyShiftPositive<InternalBits>(result, x);
+		};
+		std::size_t i = 0;
+		for (; i < (count & ~std::size_t(3)); i += 4) {
+			auto angle = _mm_loadu_si128(reinterpret_cast<const __m128i *>(angles + i));
+			auto turns = MultiplyShift<FracBits>(angle, _mm_set1_epi32(static_cast<Raw>(InvTwoPi)), zero);
+			auto quadrant = _mm_srli_epi32(turns, InternalBits);
+			auto x = _mm_and_si128(turns, _mm_set1_epi32((1 << InternalBits) - 1));
+			auto s = polynomial(x);
+			auto c = polynomial(_mm_sub_epi32(_mm_set1_epi32(1 << InternalBits), x));
+
+			auto swap = _mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one);
+			auto negateSine = _mm_sub_epi32(zero, _mm_srli_epi32(quadrant, 1));
+			auto negateCosine = _mm_sub_epi32(zero, _mm_and_si128(_mm_xor_si128(quadrant, _mm_srli_epi32(quadrant, 1)), one));
+			auto rotatedSine = _mm_or_si128(_mm_and_si128(swap, c), _mm_andnot_si128(swap, s));
+			auto rotatedCosine = _mm_or_si128(_mm_and_si128(swap, s), _mm_andnot_si128(swap, c));
+			rotatedSine = _mm_sub_epi32(_mm_xor_si128(rotatedSine, negateSine), negateSine);
+			rotatedCosine = _mm_sub_epi32(_mm_xor_si128(rotatedCosine, negateCosine), negateCosine);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(sines + i), _mm_srai_epi32(_mm_add_epi32(rotatedSine, round), Shift));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(cosines + i), _mm_srai_epi32(_mm_add_epi32(rotatedCosine, round), Shift));
+		}
+		return i;
+	}
+#endif
+
+	Raw raw = 0;
+};
+
+template<std::size_t IntBits, std::size_t FracBits>
+struct is_number<Fixed<IntBits, FracBits>> : std::true_type {};
+
+using Fixed16x16 = Fixed<16, 16>;
+using Fixed32x32 = Fixed<32, 32>;
+}
+
+namespace std {
+template<std::size_t IntBits, std::size_t FracBits>
+class numeric_limits<MathsCPP::Fixed<IntBits, FracBits>> {
+	using Type = MathsCPP::Fixed<IntBits, FracBits>;
+	using Raw = typename Type::Raw;
+public:
+	static constexpr bool is_specialized = true;
+	static constexpr bool is_signed = true;
+	static constexpr bool is_integer = false;
+	static constexpr bool is_exact = true;
+	static constexpr bool has_infinity = false;
+	static constexpr bool has_quiet_NaN = false;
+	static constexpr bool has_signaling_NaN = false;
+	static constexpr float_denorm_style has_denorm = denorm_absent;
+	static constexpr bool has_denorm_loss = false;
+	static constexpr float_round_style round_style = round_to_nearest;
+	static constexpr bool is_iec559 = false;
+	static constexpr bool is_bounded = true;
+	static constexpr bool is_modulo = true;
+	static constexpr int digits = static_cast<int>(IntBits + FracBits) - 1;
+	static constexpr int digits10 = digits * 301 / 1000;
+	static constexpr int max_digits10 = 0;
+	static constexpr int radix = 2;
+	static constexpr int min_exponent = 0;
+	static constexpr int min_exponent10 = 0;
+	static constexpr int max_exponent = 0;
+	static constexpr int max_exponent10 = 0;
+	static constexpr bool traps = true;
+	static constexpr bool tinyness_before = false;
+
+	static constexpr Type min() noexcept { return Type::FromRaw(1); }
+	static constexpr Type max() noexcept { return Type::FromRaw(numeric_limits<Raw>::max()); }
+	static constexpr Type lowest() noexcept { return Type::FromRaw(numeric_limits<Raw>::min()); }
+	static constexpr Type epsilon() noexcept { return Type::FromRaw(1); }
+	static constexpr Type round_error() noexcept { return Type(0.5); }
+	static constexpr Type infinity() noexcept { return Type(); }
+	static constexpr Type quiet_NaN() noexcept { return Type(); }
+	static constexpr Type signaling_NaN() noexcept { return Type(); }
+	static constexpr Type denorm_min() noexcept { return Type(); }
+};
+
+template<std::size_t IntBits, std::size_t FracBits>
+struct hash<MathsCPP::Fixed<IntBits, FracBits>> {
+	size_t operator()(MathsCPP::Fixed<IntBits, FracBits> value) const noexcept {
+		auto raw = value.GetRaw();
+		return static_cast<size_t>(MathsCPP::Maths::HashValues<decltype(raw), 1>(&raw));
+	}
+};
+}
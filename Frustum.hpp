@@ -0,0 +1,225 @@
+#pragma once
+
+#include "AABB.hpp"
+#include "Matrix.hpp"
+#include "Parallel.hpp"
+
+namespace MathsCPP {
+/**
+ * @brief Holds many spheres with each component in its own array, so tests across them vectorize.
+ * @tparam T The value type.
+ */
+template<typename T>
+class SphereArray {
+public:
+	SphereArray() = default;
+
+	void Add(const Vector<T, 3> &center, T r) {
+		x.emplace_back(center.x);
+		y.emplace_back(center.y);
+		z.emplace_back(center.z);
+		radius.emplace_back(r);
+	}
+
+	void Set(std::size_t i, const Vector<T, 3> &center, T r) {
+		x[i] = center.x, y[i] = center.y, z[i] = center.z, radius[i] = r;
+	}
+
+	Vector<T, 3> GetCenter(std::size_t i) const { return {x[i], y[i], z[i]}; }
+	T GetRadius(std::size_t i) const { return radius[i]; }
+
+	void Reserve(std::size_t size) {
+		x.reserve(size), y.reserve(size), z.reserve(size), radius.reserve(size);
+	}
+
+	void Clear() {
+		x.clear(), y.clear(), z.clear(), radius.clear();
+	}
+
+	std::size_t size() const { return x.size(); }
+	std::size_t GetMaskSize() const { return (size() + 63) / 64; }
+
+	std::vector<T> x, y, z;
+	std::vector<T> radius;
+};
+
+/**
+ * @brief Holds the six planes bounding a view volume.
+ * @tparam T The value type.
+ */
+template<typename T>
+class Frustum {
+public:
+	enum Side { Left, Right, Bottom, Top, Near, Far };
+
+	constexpr Frustum() = default;
+
+	/**
+	 * Extracts the planes from a projection or view projection matrix, the planes are then in the space the matrix projects from.
+	 * Each plane bounds one clip space coordinate against w, so the forward axis is already part of the matrix.
+	 * @param m The matrix, with columns in m[0] to m[3] as built by Matrix::FrustumMatrix and Matrix::PerspectiveMatrix.
+	 * @param z The clip space depth range the matrix maps to.
+	 * @return The frustum with normalized planes.
+	 */
+	static Frustum FromMatrix(const Matrix<T, 4, 4> &m, ZRange z = ZRange::NegOneToOne) {
+		auto row = [&m](std::size_t i) { return Vector<T, 4>(m[0][i], m[1][i], m[2][i], m[3][i]); };
+		auto r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+		Frustum frustum;
+		frustum.planes[Left] = r3 + r0;
+		frustum.planes[Right] = r3 - r0;
+		frustum.planes[Bottom] = r3 + r1;
+		frustum.planes[Top] = r3 - r1;
+		frustum.planes[Near] = z == ZRange::NegOneToOne ? r3 + r2 : r2;
+		frustum.planes[Far] = r3 - r2;
+		for (auto &plane : frustum.planes)
+			plane = plane / plane.xyz().Length();
+		return frustum;
+	}
+
+	/**
+	 * Gets the signed distance from a plane to a point, scaled by the length of the plane normal.
+	 * @param side The plane.
+	 * @param point The point.
+	 * @return The distance, positive on the inside.
+	 */
+	constexpr T Distance(Side side, const Vector<T, 3> &point) const {
+		const auto &p = planes[side];
+		return p.x * point.x + p.y * point.y + p.z * point.z + p.w;
+	}
+
+	/**
+	 * Gets if a point is inside every plane.
+	 * @param point The point.
+	 * @return If the point is inside.
+	 */
+	constexpr bool Contains(const Vector<T, 3> &point) const {
+		bool result = true;
+		for (std::size_t i = 0; i < 6; i++)
+			result &= Distance(static_cast<Side>(i), point) >= 0;
+		return result;
+	}
+
+	/**
+	 * Gets if a box is fully inside every plane.
+	 * @param box The box.
+	 * @return If the box is inside.
+	 */
+	constexpr bool Contains(const AABB<T, 3> &box) const {
+		bool result = true;
+		for (std::size_t i = 0; i < 6; i++)
+			result &= Distance(static_cast<Side>(i), NegativeVertex(planes[i], box)) >= 0;
+		return result;
+	}
+
+	/**
+	 * Gets if a box may be inside the frustum, boxes near the corners may pass when they are just outside.
+	 * @param box The box.
+	 * @return If the box is not fully outside any plane.
+	 */
+	constexpr bool Intersects(const AABB<T, 3> &box) const {
+		bool result = true;
+		for (std::size_t i = 0; i < 6; i++)
+			result &= Distance(static_cast<Side>(i), PositiveVertex(planes[i], box)) >= 0;
+		return result;
+	}
+
+	/**
+	 * Gets if a sphere may be inside the frustum, the planes must be normalized.
+	 * @param center The sphere center.
+	 * @param radius The sphere radius.
+	 * @return If the sphere is not fully outside any plane.
+	 */
+	constexpr bool Intersects(const Vector<T, 3> &center, T radius) const {
+		bool result = true;
+		for (std::size_t i = 0; i < 6; i++)
+			result &= Distance(static_cast<Side>(i), center) >= -radius;
+		return result;
+	}
+
+	/**
+	 * Tests which boxes may be inside the frustum, large arrays are split across threads.
+	 * @param boxes The boxes.
+	 * @param mask The output mask, bit i is set when box i is not fully outside any plane.
+	 */
+	void Intersects(const AABBArray<T, 3> &boxes, Span<uint64_t> mask) const {
+		// The corner tested against a plane is the same for every box, so its arrays are picked once per plane.
+		Vector<T, 4> p[6];
+		const T *px[6], *py[6], *pz[6];
+		for (std::size_t i = 0; i < 6; i++) {
+			p[i] = planes[i];
+			px[i] = (p[i].x >= 0 ? boxes.max[0] : boxes.min[0]).data();
+			py[i] = (p[i].y >= 0 ? boxes.max[1] : boxes.min[1]).data();
+			pz[i] = (p[i].z >= 0 ? boxes.max[2] : boxes.min[2]).data();
+		}
+		Mask(boxes.size(), mask, [&](std::size_t i) {
+			bool result = true;
+			for (std::size_t j = 0; j < 6; j++)
+				result &= p[j].x * px[j][i] + p[j].y * py[j][i] + p[j].z * pz[j][i] + p[j].w >= 0;
+			return static_cast<uint8_t>(result);
+		});
+	}
+
+	/**
+	 * Tests which spheres may be inside the frustum, the planes must be normalized. Large arrays are split across threads.
+	 * @param spheres The spheres.
+	 * @param mask The output mask, bit i is set when sphere i is not fully outside any plane.
+	 */
+	void Intersects(const SphereArray<T> &spheres, Span<uint64_t> mask) const {
+		Vector<T, 4> p[6];
+		std::copy(std::begin(planes), std::end(planes), p);
+		const auto *x = spheres.x.data(), *y = spheres.y.data(), *z = spheres.z.data(), *radius = spheres.radius.data();
+		Mask(spheres.size(), mask, [&](std::size_t i) {
+			bool result = true;
+			for (std::size_t j = 0; j < 6; j++)
+				result &= p[j].x * x[i] + p[j].y * y[i] + p[j].z * z[i] + p[j].w >= -radius[i];
+			return static_cast<uint8_t>(result);
+		});
+	}
+
+	/**
+	 * Gets the corner of a box furthest along a plane normal.
+	 */
+	static constexpr Vector<T, 3> PositiveVertex(const Vector<T, 4> &plane, const AABB<T, 3> &box) {
+		return {plane.x >= 0 ? box.max.x : box.min.x, plane.y >= 0 ? box.max.y : box.min.y, plane.z >= 0 ? box.max.z : box.min.z};
+	}
+
+	/**
+	 * Gets the corner of a box furthest against a plane normal.
+	 */
+	static constexpr Vector<T, 3> NegativeVertex(const Vector<T, 4> &plane, const AABB<T, 3> &box) {
+		return {plane.x >= 0 ? box.min.x : box.max.x, plane.y >= 0 ? box.min.y : box.max.y, plane.z >= 0 ? box.min.z : box.max.z};
+	}
+
+	/// Objects in an array before tests are split across threads.
+	static constexpr std::size_t ParallelThreshold = 65536;
+
+	/// Planes (a, b, c, d) with inward facing normals, a point p is inside a plane when a*p.x + b*p.y + c*p.z + d >= 0.
+	Vector<T, 4> planes[6];
+
+private:
+	/**
+	 * Packs a test over every object into mask words, words are spread across threads for large arrays.
+	 * @tparam Test Invocable as test(i) returning 1 when object i passes.
+	 */
+	template<typename Test>
+	static void Mask(std::size_t size, Span<uint64_t> mask, Test &&test) {
+		auto words = [&](std::size_t first, std::size_t last) {
+			uint8_t bytes[64];
+			for (auto word = first; word < last; word++) {
+				auto i = word * 64, n = std::min<std::size_t>(size - i, 64);
+				for (std::size_t j = 0; j < n; j++)
+					bytes[j] = test(i + j);
+				mask[word] = Maths::PackMask(bytes, n);
+			}
+		};
+		auto wordCount = (size + 63) / 64;
+		if (size >= ParallelThreshold)
+			Parallel::For(0, wordCount, ParallelThreshold / 64 / 4, words);
+		else
+			words(0, wordCount);
+	}
+};
+
+using Frustumf = Frustum<float>;
+using Frustumd = Frustum<double>;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <ostream>
+
+#include "Maths.hpp"
+
+namespace MathsCPP {
+/**
+ * @brief The IEEE binary16 format, 5 exponent bits and 10 mantissa bits, finite up to 65504 with about 3 decimal digits.
+ */
+struct HalfFormat {
+	static uint16_t FromFloat(float value) { return Maths::FloatToHalf(value); }
+	static float ToFloat(uint16_t bits) { return Maths::HalfToFloat(bits); }
+	static void Pack(const float *input, uint16_t *output, std::size_t count) { Maths::PackHalf(input, output, count); }
+	static void Unpack(const uint16_t *input, float *output, std::size_t count) { Maths::UnpackHalf(input, output, count); }
+
+	static constexpr int Digits = 11, Digits10 = 3, MaxDigits10 = 5;
+	static constexpr int MinExponent = -13, MinExponent10 = -4, MaxExponent = 16, MaxExponent10 = 4;
+	static constexpr uint16_t Min = 0x0400, Max = 0x7bff, Epsilon = 0x1400, RoundError = 0x3800;
+	static constexpr uint16_t Infinity = 0x7c00, QuietNaN = 0x7e00, SignalingNaN = 0x7d00, DenormMin = 0x0001;
+};
+
+/**
+ * @brief The bfloat16 format, the upper half of a float, 8 exponent bits and 7 mantissa bits, with the range of float and about 2 decimal digits.
+ */
+struct BFloat16Format {
+	static uint16_t FromFloat(float value) { return Maths::FloatToBFloat16(value); }
+	static float ToFloat(uint16_t bits) { return Maths::BFloat16ToFloat(bits); }
+	static void Pack(const float *input, uint16_t *output, std::size_t count) { Maths::PackBFloat16(input, output, count); }
+	static void Unpack(const uint16_t *input, float *output, std::size_t count) { Maths::UnpackBFloat16(input, output, count); }
+
+	static constexpr int Digits = 8, Digits10 = 2, MaxDigits10 = 4;
+	static constexpr int MinExponent = -125, MinExponent10 = -37, MaxExponent = 128, MaxExponent10 = 38;
+	static constexpr uint16_t Min = 0x0080, Max = 0x7f7f, Epsilon = 0x3c00, RoundError = 0x3f00;
+	static constexpr uint16_t Infinity = 0x7f80, QuietNaN = 0x7fc0, SignalingNaN = 0x7fa0, DenormMin = 0x0001;
+};
+
+/**
+ * @brief A 16 bit float for storage, values convert to float for arithmetic and round back to even when stored.
+ * Operations between two values of one format give that format, operations with any other number widen to float or wider.
+ * Arrays of them convert to and from float in one pass with copy_cast, using F16C for halves when the target has it.
+ * @tparam Format The bit layout, HalfFormat or BFloat16Format.
+ */
+template<typename Format>
+class Float16 {
+public:
+	constexpr Float16() = default;
+	Float16(float value) : bits(Format::FromFloat(value)) {}
+
+	/**
+	 * Creates a value from its bits without conversion.
+	 * @param bits The bits.
+	 * @return The value.
+	 */
+	static constexpr Float16 FromBits(uint16_t bits) {
+		Float16 result;
+		result.bits = bits;
+		return result;
+	}
+
+	constexpr uint16_t GetBits() const { return bits; }
+
+	operator float() const { return Format::ToFloat(bits); }
+
+	constexpr Float16 operator+() const { return *this; }
+	constexpr Float16 operator-() const { return FromBits(bits ^ 0x8000u); }
+
+	friend Float16 operator+(Float16 lhs, Float16 rhs) { return float(lhs) + float(rhs); }
+	friend Float16 operator-(Float16 lhs, Float16 rhs) { return float(lhs) - float(rhs); }
+	friend Float16 operator*(Float16 lhs, Float16 rhs) { return float(lhs) * float(rhs); }
+	friend Float16 operator/(Float16 lhs, Float16 rhs) { return float(lhs) / float(rhs); }
+
+	template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+	friend auto operator+(Float16 lhs, T rhs) { return float(lhs) + rhs; }
+	template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+	friend auto operator-(Float16 lhs, T rhs) { return float(lhs) - rhs; }
+	template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+	friend auto operator*(Float16 lhs, T rhs) { return float(lhs) * rhs; }
+	template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+	friend auto operator/(Float16 lhs, T rhs) { return float(lhs) / rhs; }
+
+	template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+	friend auto operator+(T lhs, Float16 rhs) { return lhs + float(rhs); }
+	template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+	friend auto operator-(T lhs, Float16 rhs) { return lhs - float(rhs); }
+	template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+	friend auto operator*(T lhs, Float16 rhs) { return lhs * float(rhs); }
+	template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+	friend auto operator/(T lhs, Float16 rhs) { return lhs / float(rhs); }
+
+	template<typename T>
+	Float16 &operator+=(const T &rhs) { return *this = *this + rhs; }
+	template<typename T>
+	Float16 &operator-=(const T &rhs) { return *this = *this - rhs; }
+	template<typename T>
+	Float16 &operator*=(const T &rhs) { return *this = *this * rhs; }
+	template<typename T>
+	Float16 &operator/=(const T &rhs) { return *this = *this / rhs; }
+
+	friend std::ostream &operator<<(std::ostream &stream, Float16 value) {
+		return stream << float(value);
+	}
+
+private:
+	uint16_t bits = 0;
+};
+
+template<typename Format>
+struct is_number<Float16<Format>> : std::true_type {};
+
+using Half = Float16<HalfFormat>;
+using BFloat16 = Float16<BFloat16Format>;
+}
+
+namespace std {
+template<typename Format>
+class numeric_limits<MathsCPP::Float16<Format>> {
+	using Type = MathsCPP::Float16<Format>;
+public:
+	static constexpr bool is_specialized = true;
+	static constexpr bool is_signed = true;
+	static constexpr bool is_integer = false;
+	static constexpr bool is_exact = false;
+	static constexpr bool has_infinity = true;
+	static constexpr bool has_quiet_NaN = true;
+	static constexpr bool has_signaling_NaN = true;
+	static constexpr float_denorm_style has_denorm = denorm_present;
+	static constexpr bool has_denorm_loss = false;
+	static constexpr float_round_style round_style = round_to_nearest;
+	static constexpr bool is_iec559 = false;
+	static constexpr bool is_bounded = true;
+	static constexpr bool is_modulo = false;
+	static constexpr int digits = Format::Digits;
+	static constexpr int digits10 = Format::Digits10;
+	static constexpr int max_digits10 = Format::MaxDigits10;
+	static constexpr int radix = 2;
+	static constexpr int min_exponent = Format::MinExponent;
+	static constexpr int min_exponent10 = Format::MinExponent10;
+	static constexpr int max_exponent = Format::MaxExponent;
+	static constexpr int max_exponent10 = Format::MaxExponent10;
+	static constexpr bool traps = false;
+	static constexpr bool tinyness_before = false;
+
+	static constexpr Type min() noexcept { return Type::FromBits(Format::Min); }
+	static constexpr Type max() noexcept { return Type::FromBits(Format::Max); }
+	static constexpr Type lowest() noexcept { return Type::FromBits(Format::Max | 0x8000u); }
+	static constexpr Type epsilon() noexcept { return Type::FromBits(Format::Epsilon); }
+	static constexpr Type round_error() noexcept { return Type::FromBits(Format::RoundError); }
+	static constexpr Type infinity() noexcept { return Type::FromBits(Format::Infinity); }
+	static constexpr Type quiet_NaN() noexcept { return Type::FromBits(Format::QuietNaN); }
+	static constexpr Type signaling_NaN() noexcept { return Type::FromBits(Format::SignalingNaN); }
+	static constexpr Type denorm_min() noexcept { return Type::FromBits(Format::DenormMin); }
+};
+
+template<typename Format>
+struct hash<MathsCPP::Float16<Format>> {
+	size_t operator()(MathsCPP::Float16<Format> value) const noexcept {
+		return static_cast<size_t>(MathsCPP::Maths::HashValues<MathsCPP::Float16<Format>, 1>(&value));
+	}
+};
+}
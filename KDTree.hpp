@@ -0,0 +1,364 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "AABB.hpp"
+#include "Parallel.hpp"
+
+namespace MathsCPP {
+/**
+ * @brief A static k-d tree over points, for nearest neighbour, radius and box queries.
+ * The tree is implicit: points are reordered so the node splitting a range is the median in its middle, with the lower half
+ * before it and the upper half after it, so no child links are stored. Ranges of a few points are left as unsorted leaves.
+ * @tparam T The value type.
+ * @tparam N Number of dimensions.
+ */
+template<typename T, std::size_t N>
+class KDTree {
+public:
+	/// The type distances are measured in, integer points use double so squared distances do not overflow.
+	using Scalar = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+	static constexpr uint32_t Invalid = ~uint32_t(0);
+
+	struct Neighbour {
+		/// The index of the point in the span the tree was built from, Invalid for unused results.
+		uint32_t index = Invalid;
+		Scalar distance2 = std::numeric_limits<Scalar>::infinity();
+	};
+
+	KDTree() = default;
+	explicit KDTree(Span<const Vector<T, N>> points) { Build(points); }
+
+	/**
+	 * Builds the tree, replacing any previous one. The top levels are split first, then the ranges below them are split concurrently.
+	 * @param input The points, they are copied into the tree and reported by their index in this span.
+	 */
+	void Build(Span<const Vector<T, N>> input) {
+		auto count = static_cast<uint32_t>(input.size());
+		std::vector<Entry> entries(count);
+		for (uint32_t i = 0; i < count; i++)
+			entries[i] = {input[i], i};
+		axes.assign(count, 0);
+
+		auto taskSize = std::max<uint32_t>(count / static_cast<uint32_t>(Parallel::GetThreadCount() * 8), ParallelGrain);
+		std::vector<std::pair<uint32_t, uint32_t>> tasks;
+		Split(entries.data(), 0, count, count > taskSize ? &tasks : nullptr, taskSize);
+		Parallel::For(0, tasks.size(), 1, [&](std::size_t begin, std::size_t end) {
+			for (auto i = begin; i < end; i++)
+				Split(entries.data(), tasks[i].first, tasks[i].second, nullptr, 0);
+		});
+
+		points.resize(count);
+		indices.resize(count);
+		for (uint32_t i = 0; i < count; i++) {
+			points[i] = entries[i].point;
+			indices[i] = entries[i].index;
+		}
+	}
+
+	/**
+	 * Finds the nearest points to a point.
+	 * @param query The point.
+	 * @param result Filled with the nearest points closest first, its size is the number of points to find.
+	 * @param maxDistance Only points closer than this are found.
+	 * @return The number of points found, the rest of result is left unused.
+	 */
+	std::size_t Nearest(const Vector<T, N> &query, Span<Neighbour> result, Scalar maxDistance = std::numeric_limits<Scalar>::infinity()) const {
+		BoundedQueue queue(result.data(), result.size(), maxDistance * maxDistance);
+		if (!result.empty())
+			Search(query, 0, static_cast<uint32_t>(points.size()), queue);
+		return Finish(queue, result);
+	}
+
+	/**
+	 * Finds the nearest points to a point.
+	 * @param query The point.
+	 * @param k The number of points to find.
+	 * @param maxDistance Only points closer than this are found.
+	 * @return The nearest points closest first, fewer than k when the tree is small or maxDistance is reached.
+	 */
+	std::vector<Neighbour> Nearest(const Vector<T, N> &query, std::size_t k, Scalar maxDistance = std::numeric_limits<Scalar>::infinity()) const {
+		std::vector<Neighbour> result(k);
+		result.resize(Nearest(query, result, maxDistance));
+		return result;
+	}
+
+	/**
+	 * Finds the nearest points to many points. Queries run in tree order so consecutive queries walk the same nodes, and each
+	 * starts with the search radius given by the previous query's neighbours, which prunes most of the tree before the first visit.
+	 * @param queries The points.
+	 * @param k The number of points to find for each query.
+	 * @param results Filled with k neighbours per query closest first, query i uses results [i * k, i * k + k).
+	 * Unused results have an Invalid index.
+	 */
+	void Nearest(Span<const Vector<T, N>> queries, std::size_t k, Span<Neighbour> results) const {
+		if (k == 0)
+			return;
+		std::vector<uint32_t> order(queries.size()), leaves(queries.size());
+		std::iota(order.begin(), order.end(), 0);
+		for (std::size_t i = 0; i < queries.size(); i++)
+			leaves[i] = Locate(queries[i]);
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return leaves[a] < leaves[b]; });
+
+		Parallel::For(0, order.size(), BatchGrain, [&](std::size_t begin, std::size_t end) {
+			std::vector<uint32_t> previous;
+			for (auto i = begin; i < end; i++) {
+				const auto &query = queries[order[i]];
+				Span<Neighbour> result(&results[order[i] * k], k);
+
+				// The previous neighbours are k distinct points, so the k nearest are no further than the furthest of them.
+				auto limit = std::numeric_limits<Scalar>::infinity();
+				if (previous.size() == k) {
+					limit = 0;
+					for (auto position : previous)
+						limit = std::max(limit, Distance2(query, points[position]));
+					limit = std::nextafter(limit, std::numeric_limits<Scalar>::infinity());
+				}
+
+				BoundedQueue queue(result.data(), k, limit);
+				Search(query, 0, static_cast<uint32_t>(points.size()), queue);
+				previous.assign(queue.size(), 0);
+				for (std::size_t j = 0; j < queue.size(); j++)
+					previous[j] = result[j].index;
+				Finish(queue, result);
+			}
+		});
+	}
+
+	/**
+	 * Calls a function for every point within a distance of a point, in no particular order.
+	 * @tparam Func Invocable as func(index, distance2).
+	 * @param center The point.
+	 * @param radius The distance, points at exactly this distance are included.
+	 * @param func The function.
+	 */
+	template<typename Func>
+	void Radius(const Vector<T, N> &center, Scalar radius, Func &&func) const {
+		if (!points.empty())
+			SearchRadius(center, radius * radius, 0, static_cast<uint32_t>(points.size()), func);
+	}
+
+	/**
+	 * Finds every point within a distance of a point.
+	 * @param center The point.
+	 * @param radius The distance, points at exactly this distance are included.
+	 * @return The points found, in no particular order.
+	 */
+	std::vector<Neighbour> Radius(const Vector<T, N> &center, Scalar radius) const {
+		std::vector<Neighbour> result;
+		Radius(center, radius, [&](uint32_t index, Scalar distance2) { result.push_back({index, distance2}); });
+		return result;
+	}
+
+	/**
+	 * Calls a function for every point inside a box, in no particular order.
+	 * @tparam Func Invocable as func(index).
+	 * @param box The box, faces are inclusive.
+	 * @param func The function.
+	 */
+	template<typename Func>
+	void Query(const AABB<T, N> &box, Func &&func) const {
+		if (!points.empty())
+			SearchBox(box, 0, static_cast<uint32_t>(points.size()), func);
+	}
+
+	/**
+	 * Finds every point inside a box.
+	 * @param box The box, faces are inclusive.
+	 * @return The indices of the points found, in no particular order.
+	 */
+	std::vector<uint32_t> Query(const AABB<T, N> &box) const {
+		std::vector<uint32_t> result;
+		Query(box, [&](uint32_t index) { result.emplace_back(index); });
+		return result;
+	}
+
+	std::size_t size() const { return points.size(); }
+
+private:
+	/// Ranges this small are scanned instead of split.
+	static constexpr uint32_t LeafSize = 8;
+	/// The fewest points worth splitting as a separate task.
+	static constexpr uint32_t ParallelGrain = 16384;
+	/// Queries per chunk in batched searches.
+	static constexpr std::size_t BatchGrain = 256;
+
+	struct Entry {
+		Vector<T, N> point;
+		uint32_t index;
+	};
+
+	/**
+	 * Keeps the closest points found so far in a max heap over caller owned storage, so the furthest is always the one to replace.
+	 * Neighbours hold tree positions while searching, Finish turns them into point indices.
+	 */
+	class BoundedQueue {
+	public:
+		BoundedQueue(Neighbour *data, std::size_t capacity, Scalar limit) : data(data), capacity(capacity), limit(limit) {}
+
+		/**
+		 * Gets the squared distance a point must be under to be kept.
+		 */
+		Scalar GetBound() const { return count < capacity ? limit : data[0].distance2; }
+
+		void Push(uint32_t position, Scalar distance2) {
+			if (!(distance2 < GetBound()))
+				return;
+			if (count == capacity)
+				std::pop_heap(data, data + count--, Less);
+			data[count++] = {position, distance2};
+			std::push_heap(data, data + count, Less);
+		}
+
+		std::size_t size() const { return count; }
+
+		Neighbour *data;
+		std::size_t capacity;
+		std::size_t count = 0;
+		Scalar limit;
+	};
+
+	static bool Less(const Neighbour &a, const Neighbour &b) { return a.distance2 < b.distance2; }
+
+	static Scalar Distance2(const Vector<T, N> &a, const Vector<T, N> &b) {
+		Scalar result = 0;
+		for (std::size_t i = 0; i < N; i++) {
+			auto d = static_cast<Scalar>(a[i]) - static_cast<Scalar>(b[i]);
+			result += d * d;
+		}
+		return result;
+	}
+
+	std::size_t Finish(BoundedQueue &queue, Span<Neighbour> result) const {
+		std::sort_heap(result.data(), result.data() + queue.size(), Less);
+		for (std::size_t i = 0; i < queue.size(); i++)
+			result[i].index = indices[result[i].index];
+		for (auto i = queue.size(); i < result.size(); i++)
+			result[i] = Neighbour();
+		return queue.size();
+	}
+
+	/**
+	 * Splits a range at the median of its widest axis, until ranges are leaves or small enough to queue as tasks.
+	 */
+	void Split(Entry *entries, uint32_t begin, uint32_t end, std::vector<std::pair<uint32_t, uint32_t>> *tasks, uint32_t taskSize) {
+		while (end - begin > LeafSize) {
+			if (tasks && end - begin <= taskSize) {
+				tasks->emplace_back(begin, end);
+				return;
+			}
+
+			auto min = entries[begin].point, max = min;
+			for (auto i = begin + 1; i < end; i++) {
+				min = min.Min(entries[i].point);
+				max = max.Max(entries[i].point);
+			}
+			auto extent = max - min;
+			auto axis = static_cast<uint8_t>(std::max_element(extent.begin(), extent.end()) - extent.begin());
+
+			auto middle = begin + (end - begin) / 2;
+			std::nth_element(entries + begin, entries + middle, entries + end, [axis](const Entry &a, const Entry &b) {
+				return a.point[axis] < b.point[axis];
+			});
+			axes[middle] = axis;
+			Split(entries, middle + 1, end, tasks, taskSize);
+			end = middle;
+		}
+	}
+
+	/**
+	 * Gets the first position of the leaf a point falls in.
+	 */
+	uint32_t Locate(const Vector<T, N> &query) const {
+		uint32_t begin = 0, end = static_cast<uint32_t>(points.size());
+		while (end - begin > LeafSize) {
+			auto middle = begin + (end - begin) / 2;
+			if (query[axes[middle]] < points[middle][axes[middle]])
+				end = middle;
+			else
+				begin = middle + 1;
+		}
+		return begin;
+	}
+
+	void Search(const Vector<T, N> &query, uint32_t begin, uint32_t end, BoundedQueue &queue) const {
+		if (end - begin <= LeafSize) {
+			for (auto i = begin; i < end; i++)
+				queue.Push(i, Distance2(query, points[i]));
+			return;
+		}
+
+		auto middle = begin + (end - begin) / 2;
+		auto axis = axes[middle];
+		auto d = static_cast<Scalar>(query[axis]) - static_cast<Scalar>(points[middle][axis]);
+		queue.Push(middle, Distance2(query, points[middle]));
+		if (d < 0) {
+			Search(query, begin, middle, queue);
+			if (d * d < queue.GetBound())
+				Search(query, middle + 1, end, queue);
+		} else {
+			Search(query, middle + 1, end, queue);
+			if (d * d < queue.GetBound())
+				Search(query, begin, middle, queue);
+		}
+	}
+
+	template<typename Func>
+	void SearchRadius(const Vector<T, N> &center, Scalar radius2, uint32_t begin, uint32_t end, Func &func) const {
+		if (end - begin <= LeafSize) {
+			for (auto i = begin; i < end; i++) {
+				auto distance2 = Distance2(center, points[i]);
+				if (distance2 <= radius2)
+					func(indices[i], distance2);
+			}
+			return;
+		}
+
+		auto middle = begin + (end - begin) / 2;
+		auto axis = axes[middle];
+		auto d = static_cast<Scalar>(center[axis]) - static_cast<Scalar>(points[middle][axis]);
+		auto distance2 = Distance2(center, points[middle]);
+		if (distance2 <= radius2)
+			func(indices[middle], distance2);
+		if (d <= 0 || d * d <= radius2)
+			SearchRadius(center, radius2, begin, middle, func);
+		if (d >= 0 || d * d <= radius2)
+			SearchRadius(center, radius2, middle + 1, end, func);
+	}
+
+	template<typename Func>
+	void SearchBox(const AABB<T, N> &box, uint32_t begin, uint32_t end, Func &func) const {
+		if (end - begin <= LeafSize) {
+			for (auto i = begin; i < end; i++) {
+				if (box.Contains(points[i]))
+					func(indices[i]);
+			}
+			return;
+		}
+
+		auto middle = begin + (end - begin) / 2;
+		auto axis = axes[middle];
+		if (box.Contains(points[middle]))
+			func(indices[middle]);
+		if (box.min[axis] <= points[middle][axis])
+			SearchBox(box, begin, middle, func);
+		if (box.max[axis] >= points[middle][axis])
+			SearchBox(box, middle + 1, end, func);
+	}
+
+	/// Points in tree order.
+	std::vector<Vector<T, N>> points;
+	/// The index each point had in the span the tree was built from.
+	std::vector<uint32_t> indices;
+	/// The axis split at each node, only set at the middle of ranges larger than a leaf.
+	std::vector<uint8_t> axes;
+};
+
+using KDTree2f = KDTree<float, 2>;
+using KDTree3f = KDTree<float, 3>;
+using KDTree3d = KDTree<double, 3>;
+}
@@ -1,29 +1,115 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <cmath>
+#include <cstring>
+#include <functional>
 #include <type_traits>
+#include <utility>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATHSCPP_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__F16C__) || defined(__AVX2__)
+#define MATHSCPP_F16C
+#include <immintrin.h>
+#endif
+/// Forces inlining of small kernels, loops only vectorize over calls that were inlined.
+#ifdef _MSC_VER
+#define MATHSCPP_INLINE __forceinline
+#else
+#define MATHSCPP_INLINE inline __attribute__((always_inline))
+#endif
 
 namespace MathsCPP {
 /**
- * A implementation of std::copy that static casts the input value type to the output value type.
- * @tparam InputIt, OutputIt Must meet the requirements of LegacyInputIterator and LegacyOutputIterator respectively.
- * @param first, last The range of elements to copy.
- * @param d_first The beginning of the destination range.
+ * @brief Whether a type can be the value type of vectors, matrices, quaternions and colours. These are the arithmetic
+ * types and the 16 bit float types in Half.hpp, which store reduced precision and compute in float.
+ * @tparam T The type.
  */
-template<typename InputIt, typename OutputIt>
-OutputIt copy_cast(InputIt first, InputIt last, OutputIt d_first) {
-	while (first != last) {
-		*d_first++ = static_cast<std::decay_t<decltype(*d_first)>>(*first++);
-	}
-	return d_first;
-}
+template<typename T>
+struct is_number : std::is_arithmetic<T> {};
+
+template<typename T>
+inline constexpr bool is_number_v = is_number<T>::value;
+
+template<typename Format>
+class Float16;
+
+/**
+ * @brief Describes types laid out as a fixed number of one number type with no padding, so ranges of them convert
+ * as one flat array. Types that are not flat have a void Value.
+ * @tparam T The type.
+ */
+template<typename T, typename = void>
+struct ArrayTraits {
+	using Value = void;
+	static constexpr std::size_t Count = 0;
+};
+
+template<typename T>
+struct ArrayTraits<T, std::enable_if_t<is_number_v<T>>> {
+	using Value = T;
+	static constexpr std::size_t Count = 1;
+};
+
+/**
+ * @brief A non-owning view over a contiguous range of elements, a minimal stand in for std::span.
+ * @tparam T The element type.
+ */
+template<typename T>
+class Span {
+public:
+	constexpr Span() = default;
+	constexpr Span(T *data, std::size_t size) : ptr(data), count(size) {}
+	template<std::size_t N>
+	constexpr Span(T (&array)[N]) : ptr(array), count(N) {}
+	template<typename Container, typename = std::enable_if_t<std::is_convertible_v<decltype(std::declval<Container &>().data()), T *>>>
+	constexpr Span(Container &container) : ptr(container.data()), count(container.size()) {}
+	template<typename T1, typename = std::enable_if_t<std::is_convertible_v<T1 *, T *>>>
+	constexpr Span(const Span<T1> &span) : ptr(span.data()), count(span.size()) {}
+
+	constexpr T &operator[](std::size_t i) const { return ptr[i]; }
+
+	constexpr T *data() const { return ptr; }
+	constexpr std::size_t size() const { return count; }
+	constexpr bool empty() const { return count == 0; }
+
+	constexpr T *begin() const { return ptr; }
+	constexpr T *end() const { return ptr + count; }
+
+	/**
+	 * Gets a view over part of this span.
+	 * @param offset The first element in the view.
+	 * @param size The number of elements in the view.
+	 * @return The sub span.
+	 */
+	constexpr Span subspan(std::size_t offset, std::size_t size) const { return {ptr + offset, size}; }
+
+private:
+	T *ptr = nullptr;
+	std::size_t count = 0;
+};
 
 class Maths {
 public:
 	template<typename T>
 	static constexpr T PI = static_cast<T>(3.14159265358979323846264338327950288L);
 
+	/// How closely the approximations in Maths::Fast follow the standard library, errors are absolute except for Rsqrt.
+	enum class Precision {
+		/// About 1e-5, 7e-5 for Acos and Asin, 2e-3 relative for Rsqrt.
+		Low,
+		/// A few ulp in float, about 2e-8 in double, 5e-6 relative for Rsqrt.
+		Medium,
+		/// A few ulp in float and double.
+		High
+	};
+
 	Maths() = delete;
 
 	/**
@@ -37,7 +123,8 @@ public:
 	template<typename T, typename K>
 	static auto CosFromSin(T sin, K angle) {
 		// sin(x)^2 + cos(x)^2 = 1
-		auto cos = std::sqrt(1 - sin * sin);
+		using std::sqrt;
+		auto cos = sqrt(1 - sin * sin);
 		auto a = angle + (PI<T> / 2);
 		auto b = a - static_cast<int32_t>(a / (2 * PI<T>)) * (2 * PI<T>);
 		if (b < 0)
@@ -47,6 +134,399 @@ public:
 		return cos;
 	}
 	
+	/**
+	 * Counts the number of zero bits below the lowest set bit.
+	 * @param mask The bit mask, must not be zero.
+	 * @return The index of the lowest set bit.
+	 */
+	static uint32_t CountTrailingZeros(uint64_t mask) noexcept {
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, mask);
+		return index;
+#else
+		return __builtin_ctzll(mask);
+#endif
+	}
+
+	/**
+	 * Packs 64 bytes that are each 0 or 1 into a bit mask.
+	 * @param bytes The bytes, only the first count are read.
+	 * @param count The number of bytes, at most 64.
+	 * @return The mask with bit i set when byte i is set.
+	 */
+	static uint64_t PackMask(const uint8_t *bytes, std::size_t count) noexcept {
+		uint64_t mask = 0;
+		std::size_t i = 0;
+#ifdef MATHSCPP_SSE2
+		for (; i + 16 <= count; i += 16) {
+			auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i));
+			mask |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(v, _mm_setzero_si128()))) << i;
+		}
+#endif
+		for (; i < count; i++)
+			mask |= static_cast<uint64_t>(bytes[i] != 0) << i;
+		return mask;
+	}
+
+	/**
+	 * Converts an array of values with static_cast.
+	 * @param input The values to convert.
+	 * @param output Where to write the converted values.
+	 * @param count The number of values.
+	 */
+	template<typename From, typename To>
+	static void Convert(const From *input, To *output, std::size_t count) noexcept {
+		for (std::size_t i = 0; i < count; i++)
+			output[i] = static_cast<To>(input[i]);
+	}
+
+	static void Convert(const double *input, float *output, std::size_t count) noexcept {
+		std::size_t i = 0;
+#ifdef MATHSCPP_SSE2
+		for (; i < (count & ~std::size_t(3)); i += 4)
+			_mm_storeu_ps(output + i, _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(input + i)), _mm_cvtpd_ps(_mm_loadu_pd(input + i + 2))));
+#endif
+		for (; i < count; i++)
+			output[i] = static_cast<float>(input[i]);
+	}
+
+	static void Convert(const float *input, double *output, std::size_t count) noexcept {
+		std::size_t i = 0;
+#ifdef MATHSCPP_SSE2
+		for (; i < (count & ~std::size_t(3)); i += 4) {
+			auto values = _mm_loadu_ps(input + i);
+			_mm_storeu_pd(output + i, _mm_cvtps_pd(values));
+			_mm_storeu_pd(output + i + 2, _mm_cvtps_pd(_mm_movehl_ps(values, values)));
+		}
+#endif
+		for (; i < count; i++)
+			output[i] = static_cast<double>(input[i]);
+	}
+
+	static void Convert(const int32_t *input, float *output, std::size_t count) noexcept {
+		std::size_t i = 0;
+#ifdef MATHSCPP_SSE2
+		for (; i < (count & ~std::size_t(3)); i += 4)
+			_mm_storeu_ps(output + i, _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i))));
+#endif
+		for (; i < count; i++)
+			output[i] = static_cast<float>(input[i]);
+	}
+
+	/**
+	 * Converts floats to integers rounding toward zero like static_cast, but values past the integer range saturate
+	 * to its ends and NaN becomes zero, where static_cast is undefined.
+	 * @param input The values to convert.
+	 * @param output Where to write the converted values.
+	 * @param count The number of values.
+	 */
+	static void Convert(const float *input, int32_t *output, std::size_t count) noexcept {
+		std::size_t i = 0;
+#ifdef MATHSCPP_SSE2
+		// Out of range lanes convert to INT32_MIN, flipping every bit of the positive ones gives INT32_MAX.
+		auto limit = _mm_set1_ps(2147483648.0f);
+		for (; i < (count & ~std::size_t(3)); i += 4) {
+			auto values = _mm_loadu_ps(input + i);
+			auto result = _mm_cvttps_epi32(values);
+			result = _mm_xor_si128(result, _mm_castps_si128(_mm_cmpge_ps(values, limit)));
+			result = _mm_and_si128(result, _mm_castps_si128(_mm_cmpord_ps(values, values)));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), result);
+		}
+#endif
+		for (; i < count; i++) {
+			auto value = input[i];
+			auto clamped = std::min(std::max(value, -2147483648.0f), 2147483520.0f);
+			output[i] = value != value ? 0 : value >= 2147483648.0f ? INT32_MAX : static_cast<int32_t>(clamped);
+		}
+	}
+
+	/**
+	 * Converts a float to the bits of the nearest IEEE half, rounding to even, with F16C when the target has it. Values past the half range become
+	 * infinity and NaN stays NaN.
+	 * @param value The float.
+	 * @return The half bits.
+	 */
+	static uint16_t FloatToHalf(float value) noexcept {
+#ifdef MATHSCPP_F16C
+		return static_cast<uint16_t>(_cvtss_sh(value, _MM_FROUND_TO_NEAREST_INT));
+#else
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		auto sign = bits & 0x80000000u;
+		bits ^= sign;
+
+		// Subnormal halves come from adding 0.5, which lines the mantissa up and rounds it in the float unit.
+		float magnitude;
+		std::memcpy(&magnitude, &bits, sizeof(magnitude));
+		auto subnormal = magnitude + 0.5f;
+		uint32_t subnormalBits;
+		std::memcpy(&subnormalBits, &subnormal, sizeof(subnormalBits));
+		subnormalBits -= 0x3f000000u;
+		// Normal halves rebias the exponent and round the dropped 13 bits to even.
+		auto normalBits = (bits + 0xc8000fffu + ((bits >> 13) & 1)) >> 13;
+		auto special = bits > 0x7f800000u ? 0x7e00u : 0x7c00u;
+
+		auto half = bits >= 0x47800000u ? special : bits < 0x38800000u ? subnormalBits : normalBits;
+		return static_cast<uint16_t>(half | (sign >> 16));
+#endif
+	}
+
+	/**
+	 * Converts the bits of an IEEE half to a float, exactly.
+	 * @param half The half bits.
+	 * @return The float.
+	 */
+	static float HalfToFloat(uint16_t half) noexcept {
+#ifdef MATHSCPP_F16C
+		return _cvtsh_ss(half);
+#else
+		uint32_t bits = (half & 0x7fffu) << 13;
+		auto exponent = bits & 0x0f800000u;
+		bits += 0x38000000u;
+		// Infinity and NaN need the largest float exponent, subnormals are normalized by subtracting 2^-14.
+		float subnormal;
+		auto subnormalBits = bits + 0x00800000u;
+		std::memcpy(&subnormal, &subnormalBits, sizeof(subnormal));
+		subnormal -= 6.103515625e-05f;
+		std::memcpy(&subnormalBits, &subnormal, sizeof(subnormalBits));
+		bits = exponent == 0x0f800000u ? bits + 0x38000000u : exponent == 0 ? subnormalBits : bits;
+		bits |= static_cast<uint32_t>(half & 0x8000u) << 16;
+		float result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+#endif
+	}
+
+	/**
+	 * Converts floats to IEEE half bits as FloatToHalf does, with F16C instructions when the target has them.
+	 * @param input The floats.
+	 * @param output The half bits.
+	 * @param count The number of values.
+	 */
+	static void PackHalf(const float *input, uint16_t *output, std::size_t count) noexcept {
+		std::size_t i = 0;
+#ifdef MATHSCPP_F16C
+		for (; i < (count & ~std::size_t(3)); i += 4)
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(output + i), _mm_cvtps_ph(_mm_loadu_ps(input + i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+		for (; i < count; i++)
+			output[i] = FloatToHalf(input[i]);
+	}
+
+	/**
+	 * Converts IEEE half bits to floats as HalfToFloat does, with F16C instructions when the target has them.
+	 * @param input The half bits.
+	 * @param output The floats.
+	 * @param count The number of values.
+	 */
+	static void UnpackHalf(const uint16_t *input, float *output, std::size_t count) noexcept {
+		std::size_t i = 0;
+#ifdef MATHSCPP_F16C
+		for (; i < (count & ~std::size_t(3)); i += 4)
+			_mm_storeu_ps(output + i, _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(input + i))));
+#endif
+		for (; i < count; i++)
+			output[i] = HalfToFloat(input[i]);
+	}
+
+	/**
+	 * Converts a float to the bits of the nearest bfloat16, rounding to even. NaN stays NaN, made quiet so rounding cannot
+	 * carry its payload into infinity.
+	 * @param value The float.
+	 * @return The bfloat16 bits, the upper half of the float bits.
+	 */
+	static uint16_t FloatToBFloat16(float value) noexcept {
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		auto rounded = (bits + 0x7fffu + ((bits >> 16) & 1)) >> 16;
+		return static_cast<uint16_t>((bits & 0x7fffffffu) > 0x7f800000u ? (bits >> 16) | 0x40u : rounded);
+	}
+
+	/**
+	 * Converts the bits of a bfloat16 to a float, exactly.
+	 * @param value The bfloat16 bits.
+	 * @return The float.
+	 */
+	static float BFloat16ToFloat(uint16_t value) noexcept {
+		auto bits = static_cast<uint32_t>(value) << 16;
+		float result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	/**
+	 * Converts floats to bfloat16 bits as FloatToBFloat16 does.
+	 * @param input The floats.
+	 * @param output The bfloat16 bits.
+	 * @param count The number of values.
+	 */
+	static void PackBFloat16(const float *input, uint16_t *output, std::size_t count) noexcept {
+		std::size_t i = 0;
+#ifdef MATHSCPP_SSE2
+		// Rounds in the integer unit, the arithmetic shift sign extends the upper halves so packing keeps their bits.
+		auto round = [](__m128 values) {
+			auto bits = _mm_castps_si128(values);
+			auto odd = _mm_and_si128(_mm_srli_epi32(bits, 16), _mm_set1_epi32(1));
+			auto rounded = _mm_add_epi32(bits, _mm_add_epi32(odd, _mm_set1_epi32(0x7fff)));
+			auto nan = _mm_castps_si128(_mm_cmpunord_ps(values, values));
+			auto quiet = _mm_or_si128(bits, _mm_set1_epi32(0x00400000));
+			return _mm_srai_epi32(_mm_or_si128(_mm_and_si128(nan, quiet), _mm_andnot_si128(nan, rounded)), 16);
+		};
+		for (; i < (count & ~std::size_t(7)); i += 8) {
+			auto low = round(_mm_loadu_ps(input + i)), high = round(_mm_loadu_ps(input + i + 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), _mm_packs_epi32(low, high));
+		}
+#endif
+		for (; i < count; i++)
+			output[i] = FloatToBFloat16(input[i]);
+	}
+
+	/**
+	 * Converts bfloat16 bits to floats as BFloat16ToFloat does.
+	 * @param input The bfloat16 bits.
+	 * @param output The floats.
+	 * @param count The number of values.
+	 */
+	static void UnpackBFloat16(const uint16_t *input, float *output, std::size_t count) noexcept {
+		std::size_t i = 0;
+#ifdef MATHSCPP_SSE2
+		for (; i < (count & ~std::size_t(7)); i += 8) {
+			auto values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+			_mm_storeu_ps(output + i, _mm_castsi128_ps(_mm_unpacklo_epi16(_mm_setzero_si128(), values)));
+			_mm_storeu_ps(output + i + 4, _mm_castsi128_ps(_mm_unpackhi_epi16(_mm_setzero_si128(), values)));
+		}
+#endif
+		for (; i < count; i++)
+			output[i] = BFloat16ToFloat(input[i]);
+	}
+
+	/**
+	 * Converts floats to a 16 bit float type with the packed kernel of its format.
+	 * @param input The values to convert.
+	 * @param output Where to write the converted values.
+	 * @param count The number of values.
+	 */
+	template<typename Format>
+	static void Convert(const float *input, Float16<Format> *output, std::size_t count) noexcept {
+		Format::Pack(input, reinterpret_cast<uint16_t *>(output), count);
+	}
+
+	template<typename Format>
+	static void Convert(const Float16<Format> *input, float *output, std::size_t count) noexcept {
+		Format::Unpack(reinterpret_cast<const uint16_t *>(input), output, count);
+	}
+
+	/**
+	 * Hints that memory will be read soon, so a random access can overlap with other work.
+	 * @param address The address to fetch into cache.
+	 */
+	static void Prefetch(const void *address) noexcept {
+#ifdef MATHSCPP_SSE2
+		_mm_prefetch(static_cast<const char *>(address), _MM_HINT_T0);
+#elif defined(__GNUC__)
+		__builtin_prefetch(address);
+#else
+		(void)address;
+#endif
+	}
+
+	/**
+	 * Multiplies two words into 128 bits and folds the halves together, every input bit affects every output bit.
+	 * @param a The first word.
+	 * @param b The second word.
+	 * @return The folded product.
+	 */
+	static uint64_t Mix(uint64_t a, uint64_t b) noexcept {
+#if defined(__SIZEOF_INT128__)
+		auto product = static_cast<unsigned __int128>(a) * b;
+		return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		uint64_t high;
+		auto low = _umul128(a, b, &high);
+		return low ^ high;
+#else
+		uint64_t aLow = a & 0xffffffff, aHigh = a >> 32, bLow = b & 0xffffffff, bHigh = b >> 32;
+		uint64_t ll = aLow * bLow, lh = aLow * bHigh, hl = aHigh * bLow, hh = aHigh * bHigh;
+		uint64_t middle = (ll >> 32) + (lh & 0xffffffff) + (hl & 0xffffffff);
+		uint64_t low = (ll & 0xffffffff) | (middle << 32);
+		uint64_t high = hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+		return low ^ high;
+#endif
+	}
+
+	/**
+	 * Hashes raw bytes. Each 16 bytes costs one wide multiply, and inputs of 32 bytes or more run two independent chains,
+	 * so hashing a matrix is a few multiplies deep instead of one step per element.
+	 * @param data The bytes.
+	 * @param size The number of bytes.
+	 * @param seed The seed, different seeds give unrelated hashes.
+	 * @return The hash.
+	 */
+	static uint64_t HashBytes(const void *data, std::size_t size, uint64_t seed = 0) noexcept {
+		auto bytes = static_cast<const uint8_t *>(data);
+		auto h0 = seed ^ HashSecret[0], h1 = seed ^ HashSecret[3];
+		std::size_t i = 0;
+		for (; i + 32 <= size; i += 32) {
+			h0 = Mix(Read64(bytes + i) ^ HashSecret[1], Read64(bytes + i + 8) ^ h0);
+			h1 = Mix(Read64(bytes + i + 16) ^ HashSecret[2], Read64(bytes + i + 24) ^ h1);
+		}
+		auto h = h0 ^ h1;
+		for (; i + 16 <= size; i += 16)
+			h = Mix(Read64(bytes + i) ^ HashSecret[1], Read64(bytes + i + 8) ^ h);
+
+		// The last 1 to 15 bytes are read as overlapping words so there are no per byte loops.
+		auto tail = bytes + i;
+		auto remaining = size - i;
+		uint64_t a = 0, b = 0;
+		if (remaining >= 8) {
+			a = Read64(tail);
+			b = Read64(tail + remaining - 8);
+		} else if (remaining >= 4) {
+			a = Read32(tail);
+			b = Read32(tail + remaining - 4);
+		} else if (remaining > 0) {
+			a = (static_cast<uint64_t>(tail[0]) << 16) | (static_cast<uint64_t>(tail[remaining >> 1]) << 8) | tail[remaining - 1];
+		}
+		h = Mix(a ^ HashSecret[1], b ^ h);
+		return Mix(h ^ HashSecret[0], size ^ HashSecret[3]);
+	}
+
+	/**
+	 * Hashes a fixed number of values by their bytes. Floating point zeros are made positive first so -0 and +0,
+	 * which compare equal, also hash equal.
+	 * @tparam T The value type.
+	 * @tparam Count The number of values.
+	 * @param values The values.
+	 * @param seed The seed.
+	 * @return The hash.
+	 */
+	template<typename T, std::size_t Count>
+	static uint64_t HashValues(const T *values, uint64_t seed = 0) noexcept {
+		if constexpr (!std::is_integral_v<T>) {
+			T canonical[Count];
+			for (std::size_t i = 0; i < Count; i++)
+				canonical[i] = values[i] == T(0) ? T(0) : values[i];
+			return HashBytes(canonical, sizeof(canonical), seed);
+		} else {
+			return HashBytes(values, Count * sizeof(T), seed);
+		}
+	}
+
+	/**
+	 * @brief A hash policy for unordered containers, it forwards to std::hash for the maths types and mixes plain numbers
+	 * whose std::hash is often the identity, which clusters badly in open addressing tables.
+	 */
+	struct Hash {
+		template<typename T>
+		std::size_t operator()(const T &value) const noexcept {
+			if constexpr (is_number_v<T>)
+				return static_cast<std::size_t>(HashValues<T, 1>(&value));
+			else
+				return std::hash<T>()(value);
+		}
+	};
+
 	/**
 	 * Combines a seed into a hash and modifies the seed by the new hash.
 	 * @param seed The seed.
@@ -57,5 +537,252 @@ public:
 		std::hash<T> hasher;
 		seed ^= hasher(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 	}
+
+	/**
+	 * @brief Branch free approximations of square roots and trigonometry that compilers can vectorize across loops.
+	 * Inputs must be finite, angles are reduced exactly while the quadrant count fits in 16 bits, magnitudes up to about 65536 * pi/2.
+	 */
+	class Fast {
+	public:
+		Fast() = delete;
+
+		/**
+		 * Approximates one over the square root, from an initial guess on the bits refined by Newton steps.
+		 * @tparam P The precision, each level adds Newton steps.
+		 * @param x The value, must be positive.
+		 * @return The reciprocal square root.
+		 */
+		template<Precision P = Precision::Medium, typename T>
+		MATHSCPP_INLINE static T Rsqrt(T x) noexcept {
+			static_assert(std::is_floating_point_v<T>, "Rsqrt needs a floating point type");
+			using Bits = std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t>;
+			Bits bits;
+			std::memcpy(&bits, &x, sizeof(bits));
+			bits = (sizeof(T) == sizeof(uint32_t) ? Bits(0x5f375a86) : Bits(0x5fe6eb50c7b537a9ull)) - (bits >> 1);
+			T y;
+			std::memcpy(&y, &bits, sizeof(y));
+			constexpr auto Steps = P == Precision::Low ? 1 : P == Precision::Medium ? 2 : sizeof(T) == sizeof(float) ? 3 : 4;
+			auto half = x * T(0.5);
+			for (int i = 0; i < Steps; i++)
+				y = y * (T(1.5) - half * y * y);
+			return y;
+		}
+
+		/**
+		 * Picks between two values with a bit mask, compilers keep ternaries on computed floats as branches when the
+		 * operands might trap, which stops loops vectorizing.
+		 */
+		template<typename T>
+		MATHSCPP_INLINE static T Select(bool condition, T a, T b) noexcept {
+			using Bits = std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t>;
+			Bits bitsA, bitsB;
+			std::memcpy(&bitsA, &a, sizeof(a));
+			std::memcpy(&bitsB, &b, sizeof(b));
+			auto mask = Bits(0) - static_cast<Bits>(condition);
+			auto bits = (bitsA & mask) | (bitsB & ~mask);
+			T result;
+			std::memcpy(&result, &bits, sizeof(result));
+			return result;
+		}
+
+		/**
+		 * Approximates the square root as x * Rsqrt(x).
+		 * @param x The value, must not be negative.
+		 * @return The square root, zero stays zero.
+		 */
+		template<Precision P = Precision::Medium, typename T>
+		MATHSCPP_INLINE static T Sqrt(T x) noexcept {
+			return x * Rsqrt<P>(x);
+		}
+
+		/**
+		 * Approximates the sine and cosine together, sharing the range reduction to [-pi/4, pi/4].
+		 * @param x The angle, in radians.
+		 * @param sin The sine.
+		 * @param cos The cosine.
+		 */
+		template<Precision P = Precision::Medium, typename T>
+		MATHSCPP_INLINE static void SinCos(T x, T &sin, T &cos) noexcept {
+			static_assert(std::is_floating_point_v<T>, "SinCos needs a floating point type");
+			// pi/2 split so each product with the quadrant is exact, then subtracted from largest to smallest.
+			constexpr T Pio2A = sizeof(T) == sizeof(float) ? T(1.5703125) : T(1.57079632673412561417e+00);
+			constexpr T Pio2B = sizeof(T) == sizeof(float) ? T(4.837512969970703125e-4) : T(6.07710050630396597660e-11);
+			constexpr T Pio2C = sizeof(T) == sizeof(float) ? T(7.54978995489188216e-8) : T(2.02226624879595063154e-21);
+			auto quadrant = static_cast<int32_t>(x * T(0.636619772367581343075535053490057448) + std::copysign(T(0.5), x));
+			auto k = static_cast<T>(quadrant);
+			auto r = ((x - k * Pio2A) - k * Pio2B) - k * Pio2C;
+			auto r2 = r * r;
+
+			T s, c;
+			if constexpr (P == Precision::Low) {
+				s = r + r * r2 * (T(-1.6662834e-1) + r2 * T(8.15299e-3));
+				c = 1 + r2 * (T(-4.9977631e-1) + r2 * T(4.048894e-2));
+			} else if constexpr (P == Precision::Medium) {
+				s = r + r * r2 * (T(-1.6666654611e-1) + r2 * (T(8.3321608736e-3) + r2 * T(-1.9515295891e-4)));
+				c = 1 - r2 * T(0.5) + r2 * r2 * (T(4.166664568298827e-2) + r2 * (T(-1.388731625493765e-3) + r2 * T(2.443315711809948e-5)));
+			} else {
+				s = r + r * r2 * (T(-1.66666666666666324348e-01) + r2 * (T(8.33333333332248946124e-03) + r2 * (T(-1.98412698298579493134e-04) +
+					r2 * (T(2.75573137070700676789e-06) + r2 * (T(-2.50507602534068634195e-08) + r2 * T(1.58969099521155010221e-10))))));
+				c = 1 - r2 * T(0.5) + r2 * r2 * (T(4.16666666666666019037e-02) + r2 * (T(-1.38888888888741095749e-03) + r2 * (T(2.48015872894767294178e-05) +
+					r2 * (T(-2.75573143513906633035e-07) + r2 * (T(2.08757232129817482790e-09) + r2 * T(-1.13596475577881948265e-11))))));
+			}
+
+			// Odd quadrants swap sine and cosine, then the signs follow the quadrant.
+			auto swap = (quadrant & 1) != 0;
+			sin = Select((quadrant & 2) != 0, -Select(swap, c, s), Select(swap, c, s));
+			cos = Select(((quadrant + 1) & 2) != 0, -Select(swap, s, c), Select(swap, s, c));
+		}
+
+		template<Precision P = Precision::Medium, typename T>
+		MATHSCPP_INLINE static T Sin(T x) noexcept {
+			T sin, cos;
+			SinCos<P>(x, sin, cos);
+			return sin;
+		}
+
+		template<Precision P = Precision::Medium, typename T>
+		MATHSCPP_INLINE static T Cos(T x) noexcept {
+			T sin, cos;
+			SinCos<P>(x, sin, cos);
+			return cos;
+		}
+
+		template<Precision P = Precision::Medium, typename T>
+		MATHSCPP_INLINE static T Atan(T x) noexcept {
+			auto a = std::abs(x);
+			auto invert = a > 1;
+			auto result = AtanUnit<P>(Select(invert, 1 / a, a));
+			return std::copysign(Select(invert, PI<T> / 2 - result, result), x);
+		}
+
+		/**
+		 * Approximates the angle of a point from the x axis, matching std::atan2 for signed zeros.
+		 * @param y The y coordinate.
+		 * @param x The x coordinate.
+		 * @return The angle in [-pi, pi], in radians.
+		 */
+		template<Precision P = Precision::Medium, typename T>
+		MATHSCPP_INLINE static T Atan2(T y, T x) noexcept {
+			auto ax = std::abs(x), ay = std::abs(y);
+			auto high = std::max(ax, ay), low = std::min(ax, ay);
+			auto result = AtanUnit<P>(Select(high == 0, T(0), low / high));
+			result = Select(ay > ax, PI<T> / 2 - result, result);
+			result = Select(std::signbit(x), PI<T> - result, result);
+			return std::copysign(result, y);
+		}
+
+		/**
+		 * Approximates the arc cosine, square roots are also approximated so the whole function vectorizes.
+		 * @param x The value, must be in [-1, 1].
+		 * @return The angle in [0, pi], in radians.
+		 */
+		template<Precision P = Precision::Medium, typename T>
+		MATHSCPP_INLINE static T Acos(T x) noexcept {
+			if constexpr (P == Precision::High) {
+				return Atan2<P>(Sqrt<Precision::High>((1 - x) * (1 + x)), x);
+			} else {
+				// acos(a) / sqrt(1 - a) is smooth over [0, 1], from Abramowitz and Stegun 4.4.45 and 4.4.46.
+				auto a = std::abs(x);
+				T poly;
+				if constexpr (P == Precision::Low) {
+					poly = T(1.5707288) + a * (T(-0.2121144) + a * (T(0.0742610) + a * T(-0.0187293)));
+				} else {
+					poly = T(1.5707963050) + a * (T(-0.2145988016) + a * (T(0.0889789874) + a * (T(-0.0501743046) + a * (T(0.0308918810) +
+						a * (T(-0.0170881256) + a * (T(0.0066700901) + a * T(-0.0012624911)))))));
+				}
+				auto result = Sqrt<Precision::High>(1 - a) * poly;
+				return Select(x < 0, PI<T> - result, result);
+			}
+		}
+
+		template<Precision P = Precision::Medium, typename T>
+		MATHSCPP_INLINE static T Asin(T x) noexcept {
+			return PI<T> / 2 - Acos<P>(x);
+		}
+
+	private:
+		/**
+		 * Approximates the arc tangent over [0, 1].
+		 */
+		template<Precision P, typename T>
+		MATHSCPP_INLINE static T AtanUnit(T t) noexcept {
+			if constexpr (P == Precision::Low) {
+				// Abramowitz and Stegun 4.4.49.
+				auto t2 = t * t;
+				return t * (T(0.9998660) + t2 * (T(-0.3302995) + t2 * (T(0.1801410) + t2 * (T(-0.0851330) + t2 * T(0.0208351)))));
+			} else {
+				// Values above tan(pi/8) use atan(t) = pi/4 + atan((t - 1) / (t + 1)).
+				auto reduce = t > T(0.414213562373095048801688724209698079);
+				auto u = Select(reduce, (t - 1) / (t + 1), t);
+				auto z = u * u;
+				T poly;
+				if constexpr (P == Precision::Medium) {
+					poly = T(-3.33329491539e-1) + z * (T(1.99777106478e-1) + z * (T(-1.38776856032e-1) + z * T(8.05374449538e-2)));
+				} else {
+					poly = T(-3.33333333333329318027e-01) + z * (T(1.99999999998764832476e-01) + z * (T(-1.42857142725034663711e-01) +
+						z * (T(1.11111104054623557880e-01) + z * (T(-9.09088713343650656196e-02) + z * (T(7.69187620504482999495e-02) +
+						z * (T(-6.66107313738753120669e-02) + z * (T(5.83357013379057348645e-02) + z * (T(-4.97687799461593236017e-02) +
+						z * (T(3.65315727442169155270e-02) + z * T(-1.62858201153657823623e-02))))))))));
+				}
+				auto result = u + u * z * poly;
+				return Select(reduce, PI<T> / 4 + result, result);
+			}
+		}
+	};
+
+private:
+	/// Odd constants with evenly mixed bits, from wyhash.
+	static constexpr uint64_t HashSecret[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+
+	static uint64_t Read64(const uint8_t *bytes) noexcept {
+		uint64_t value;
+		std::memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+
+	static uint64_t Read32(const uint8_t *bytes) noexcept {
+		uint32_t value;
+		std::memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
 };
+
+/**
+ * A implementation of std::copy that static casts the input value type to the output value type.
+ * Pointers to flat types, such as numbers or vectors and matrices of them, convert as one array through Maths::Convert,
+ * so they use its packed kernels and float to integer conversions saturate.
+ * @tparam InputIt, OutputIt Must meet the requirements of LegacyInputIterator and LegacyOutputIterator respectively.
+ * @param first, last The range of elements to copy.
+ * @param d_first The beginning of the destination range.
+ */
+template<typename InputIt, typename OutputIt>
+OutputIt copy_cast(InputIt first, InputIt last, OutputIt d_first) {
+	using From = std::remove_cv_t<std::remove_reference_t<decltype(*first)>>;
+	using To = std::remove_reference_t<decltype(*d_first)>;
+	using FromValue = typename ArrayTraits<From>::Value;
+	using ToValue = typename ArrayTraits<To>::Value;
+	if constexpr (std::is_pointer_v<InputIt> && std::is_pointer_v<OutputIt> && !std::is_void_v<FromValue> && !std::is_void_v<ToValue> &&
+		ArrayTraits<From>::Count == ArrayTraits<To>::Count && !std::is_const_v<To>) {
+		static_assert(sizeof(From) == sizeof(FromValue) * ArrayTraits<From>::Count && sizeof(To) == sizeof(ToValue) * ArrayTraits<To>::Count,
+			"Flat types must not have padding");
+		auto count = static_cast<std::size_t>(last - first);
+		Maths::Convert(reinterpret_cast<const FromValue *>(first), reinterpret_cast<ToValue *>(d_first), count * ArrayTraits<From>::Count);
+		return d_first + count;
+	} else {
+		while (first != last) {
+			*d_first++ = static_cast<std::decay_t<decltype(*d_first)>>(*first++);
+		}
+		return d_first;
+	}
+}
+
+/**
+ * Converts a span of flat types into another of the same size in one pass.
+ * @param input The values to convert.
+ * @param output Where to write the converted values, at least as large as input.
+ */
+template<typename From, typename To>
+void copy_cast(Span<const From> input, Span<To> output) {
+	copy_cast(input.data(), input.data() + input.size(), output.data());
+}
 }
@@ -9,6 +9,96 @@ enum class ForwardAxis { NegZ, PosZ };
 /// Should projection matrices map z into the range of [-1,1] or [0,1]?
 enum class ZRange { NegOneToOne, ZeroToOne };
 
+template<typename T>
+class Quaternion;
+
+namespace Detail {
+/**
+ * Writes the top three rows of translation * rotation * scale, row j column k goes to rows[(j * 4 + k) * stride].
+ * The stride lets batch loops write one array per entry, inlined there the kernel vectorizes across matrices.
+ */
+template<typename T>
+MATHSCPP_INLINE void ComposeTRS(T tx, T ty, T tz, T x, T y, T z, T w, T sx, T sy, T sz, T *rows, std::size_t stride) {
+	auto x2 = x + x, y2 = y + y, z2 = z + z;
+	auto xx = x * x2, yy = y * y2, zz = z * z2;
+	auto xy = x * y2, xz = x * z2, yz = y * z2;
+	auto wx = w * x2, wy = w * y2, wz = w * z2;
+	rows[0 * stride] = (1 - yy - zz) * sx;
+	rows[1 * stride] = (xy - wz) * sy;
+	rows[2 * stride] = (xz + wy) * sz;
+	rows[3 * stride] = tx;
+	rows[4 * stride] = (xy + wz) * sx;
+	rows[5 * stride] = (1 - xx - zz) * sy;
+	rows[6 * stride] = (yz - wx) * sz;
+	rows[7 * stride] = ty;
+	rows[8 * stride] = (xz - wy) * sx;
+	rows[9 * stride] = (yz + wx) * sy;
+	rows[10 * stride] = (1 - xx - yy) * sz;
+	rows[11 * stride] = tz;
+}
+
+/**
+ * Splits the top three rows of an affine matrix, laid out as ComposeTRS writes them, into translation, rotation and scale,
+ * written to trs[i * stride] in the order tx, ty, tz, x, y, z, w, sx, sy, sz.
+ * The rotation is the Gram-Schmidt orthonormalization of the columns and the scale is what remains on the diagonal, so shear
+ * is dropped, and a negative determinant is folded into the x scale. Every step is branch free so batch loops vectorize.
+ */
+template<typename T>
+MATHSCPP_INLINE void DecomposeTRS(const T *rows, std::size_t rowStride, T *trs, std::size_t stride) {
+	auto m = [&](std::size_t j, std::size_t k) { return rows[(j * 4 + k) * rowStride]; };
+	// The smallest normal keeps zero lengths finite, a zero column then gives a zero axis and a zero scale.
+	auto inverseLength = [](T x, T y, T z) { return Maths::Fast::Rsqrt<Maths::Precision::High>(x * x + y * y + z * z + std::numeric_limits<T>::min()); };
+
+	auto c0x = m(0, 0), c0y = m(1, 0), c0z = m(2, 0);
+	auto c1x = m(0, 1), c1y = m(1, 1), c1z = m(2, 1);
+	auto c2x = m(0, 2), c2y = m(1, 2), c2z = m(2, 2);
+	auto determinant = c0x * (c1y * c2z - c1z * c2y) + c0y * (c1z * c2x - c1x * c2z) + c0z * (c1x * c2y - c1y * c2x);
+	auto inverseX = std::copysign(inverseLength(c0x, c0y, c0z), determinant);
+	auto r0x = c0x * inverseX, r0y = c0y * inverseX, r0z = c0z * inverseX;
+	auto sx = r0x * c0x + r0y * c0y + r0z * c0z;
+	auto projection = r0x * c1x + r0y * c1y + r0z * c1z;
+	auto u1x = c1x - r0x * projection, u1y = c1y - r0y * projection, u1z = c1z - r0z * projection;
+	auto inverseY = inverseLength(u1x, u1y, u1z);
+	auto r1x = u1x * inverseY, r1y = u1y * inverseY, r1z = u1z * inverseY;
+	auto sy = r1x * c1x + r1y * c1y + r1z * c1z;
+	auto r2x = r0y * r1z - r0z * r1y, r2y = r0z * r1x - r0x * r1z, r2z = r0x * r1y - r0y * r1x;
+	auto sz = r2x * c2x + r2y * c2y + r2z * c2z;
+
+	// Shepperd's method, the largest of 4w^2, 4x^2, 4y^2 and 4z^2 picks the formula that does not cancel.
+	auto t0 = 1 + r0x + r1y + r2z, t1 = 1 + r0x - r1y - r2z, t2 = 1 - r0x + r1y - r2z, t3 = 1 - r0x - r1y + r2z;
+	auto xy = r1x + r0y, xz = r2x + r0z, yz = r2y + r1z;
+	auto wx = r1z - r2y, wy = r2x - r0z, wz = r0y - r1x;
+	auto qx = wx, qy = wy, qz = wz, qw = t0, t = t0;
+	auto pick = [&](T ti, T x, T y, T z, T w) {
+		auto larger = ti > t;
+		qx = Maths::Fast::Select(larger, x, qx);
+		qy = Maths::Fast::Select(larger, y, qy);
+		qz = Maths::Fast::Select(larger, z, qz);
+		qw = Maths::Fast::Select(larger, w, qw);
+		t = Maths::Fast::Select(larger, ti, t);
+	};
+	pick(t1, t1, xy, xz, wx);
+	pick(t2, xy, t2, yz, wy);
+	pick(t3, xz, yz, t3, wz);
+	// A zero matrix leaves nothing to pick from, normalizing rather than scaling by 1 / (2 sqrt(t)) keeps the rotation unit.
+	auto scale = Maths::Fast::Rsqrt<Maths::Precision::High>(qx * qx + qy * qy + qz * qz + qw * qw + std::numeric_limits<T>::min());
+	qx *= scale;
+	qy *= scale;
+	qz *= scale;
+	qw *= scale;
+	trs[0 * stride] = m(0, 3);
+	trs[1 * stride] = m(1, 3);
+	trs[2 * stride] = m(2, 3);
+	trs[3 * stride] = qx;
+	trs[4 * stride] = qy;
+	trs[5 * stride] = qz;
+	trs[6 * stride] = qw;
+	trs[7 * stride] = sx;
+	trs[8 * stride] = sy;
+	trs[9 * stride] = sz;
+}
+}
+
 /**
  * @brief Holds a row major MxN matrix.
  */
@@ -18,7 +108,7 @@ public:
 	constexpr Matrix() = default;
 	template<typename ...Args, typename = std::enable_if_t<sizeof...(Args) == M && std::conjunction_v<std::is_convertible<Args, Vector<T, N>>...>>>
 	constexpr Matrix(Args... args) : data{args...} {}
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1> && M == N>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1> && M == N>>
 	constexpr explicit Matrix(T1 s) {
 		for (std::size_t j = 0; j < M; j++)
 			at(j)[j] = static_cast<T>(s);
@@ -136,7 +226,7 @@ public:
 		return result;
 	}
 
-	template<typename = std::enable_if_t<N == 4 && M == 4>>
+	template<std::size_t N1 = N, std::size_t M1 = M, typename = std::enable_if_t<N1 == 4 && M1 == 4>>
 	static Matrix<T, 4, 4> FrustumMatrix(T x0, T x1, T y0, T y1, T n, T f, ForwardAxis a = ForwardAxis::NegZ, ZRange z = ZRange::NegOneToOne) {
 		const T s = a == ForwardAxis::PosZ ? T(1) : T(-1);
 		const T o = z == ZRange::NegOneToOne ? n : T(0);
@@ -148,13 +238,98 @@ public:
 		};
 	}
 
-	template<typename = std::enable_if_t<N == 4 && M == 4>>
+	template<std::size_t N1 = N, std::size_t M1 = M, typename = std::enable_if_t<N1 == 4 && M1 == 4>>
 	static Matrix<T, 4, 4> PerspectiveMatrix(T fovy, T aspect, T n, T f, ForwardAxis a = ForwardAxis::NegZ, ZRange z = ZRange::NegOneToOne) {
 		T y = n * std::tan(fovy / 2);
 		T x = y * aspect;
 		return FrustumMatrix(-x, x, -y, y, n, f, a, z);
 	}
 
+	/**
+	 * Creates the transform that scales, then rotates, then translates, writing each entry directly.
+	 * @param translation The translation.
+	 * @param rotation The rotation, must be normalized.
+	 * @param scale The scale.
+	 * @return The matrix, it transforms column vectors as Matrix * Vector does.
+	 */
+	template<std::size_t N1 = N, std::size_t M1 = M, typename = std::enable_if_t<N1 == 4 && M1 == 4>>
+	static Matrix<T, 4, 4> FromTRS(const Vector<T, 3> &translation, const Quaternion<T> &rotation, const Vector<T, 3> &scale = Vector<T, 3>(1)) {
+		Matrix<T, 4, 4> result;
+		T rows[12];
+		Detail::ComposeTRS(translation.x, translation.y, translation.z, rotation.x, rotation.y, rotation.z, rotation.w, scale.x, scale.y, scale.z, rows, 1);
+		for (std::size_t j = 0; j < 3; j++) {
+			for (std::size_t i = 0; i < 4; i++)
+				result[j][i] = rows[j * 4 + i];
+		}
+		result[3][3] = 1;
+		return result;
+	}
+
+	/**
+	 * Creates many transforms, as FromTRS does for one.
+	 * @param translations The translations.
+	 * @param rotations The rotations, the same size as translations.
+	 * @param scales The scales, the same size as translations.
+	 * @param results The matrices, the same size as translations.
+	 */
+	template<std::size_t N1 = N, std::size_t M1 = M, typename = std::enable_if_t<N1 == 4 && M1 == 4>>
+	static void FromTRS(Span<const Vector<T, 3>> translations, Span<const Quaternion<T>> rotations, Span<const Vector<T, 3>> scales, Span<Matrix> results) {
+		// Each matrix is written straight from its inputs, a structure of arrays pass only adds transposes to a loop bound by the stores.
+		Parallel::For(0, results.size(), BatchGrain, [&](std::size_t begin, std::size_t end) {
+			for (auto i = begin; i < end; i++)
+				results[i] = FromTRS(translations[i], rotations[i], scales[i]);
+		});
+	}
+
+	/**
+	 * Splits an affine transform into the translation, rotation and scale FromTRS would build it from, the bottom row is ignored.
+	 * Shear is dropped: the rotation is the Gram-Schmidt orthonormalization of the columns and the scale is what remains on the diagonal.
+	 * A mirroring transform gets a negative x scale.
+	 * @param translation The translation.
+	 * @param rotation The rotation, normalized.
+	 * @param scale The scale.
+	 * @return If the transform could be split, false when a scale is zero, the outputs are then finite but the rotation is arbitrary.
+	 */
+	template<std::size_t N1 = N, std::size_t M1 = M, typename = std::enable_if_t<N1 == 4 && M1 == 4>>
+	bool Decompose(Vector<T, 3> &translation, Quaternion<T> &rotation, Vector<T, 3> &scale) const {
+		T trs[10];
+		Detail::DecomposeTRS(&at(0)[0], 1, trs, 1);
+		translation = {trs[0], trs[1], trs[2]};
+		rotation = {trs[3], trs[4], trs[5], trs[6]};
+		scale = {trs[7], trs[8], trs[9]};
+		return scale.x != 0 && scale.y != 0 && scale.z != 0;
+	}
+
+	/**
+	 * Splits many affine transforms, as Decompose does for one.
+	 * @param matrices The matrices.
+	 * @param translations The translations, the same size as matrices.
+	 * @param rotations The rotations, the same size as matrices.
+	 * @param scales The scales, the same size as matrices.
+	 */
+	template<std::size_t N1 = N, std::size_t M1 = M, typename = std::enable_if_t<N1 == 4 && M1 == 4>>
+	static void Decompose(Span<const Matrix> matrices, Span<Vector<T, 3>> translations, Span<Quaternion<T>> rotations, Span<Vector<T, 3>> scales) {
+		Parallel::For(0, matrices.size(), BatchGrain, [&](std::size_t begin, std::size_t end) {
+			T rows[12][BatchBlock]{}, trs[10][BatchBlock]{};
+			for (auto block = begin; block < end; block += BatchBlock) {
+				auto count = std::min(BatchBlock, end - block);
+				for (std::size_t i = 0; i < count; i++) {
+					for (std::size_t j = 0; j < 3; j++) {
+						for (std::size_t k = 0; k < 4; k++)
+							rows[j * 4 + k][i] = matrices[block + i][j][k];
+					}
+				}
+				for (std::size_t i = 0; i < BatchBlock; i++)
+					Detail::DecomposeTRS(&rows[0][i], BatchBlock, &trs[0][i], BatchBlock);
+				for (std::size_t i = 0; i < count; i++) {
+					translations[block + i] = {trs[0][i], trs[1][i], trs[2][i]};
+					rotations[block + i] = {trs[3][i], trs[4][i], trs[5][i], trs[6][i]};
+					scales[block + i] = {trs[7][i], trs[8][i], trs[9][i]};
+				}
+			}
+		});
+	}
+
 	// TODO: Rotate, Translate, OrthographicMatrix, ViewMatrix, Project, Unproject, LookAt
 
 	template<typename T1>
@@ -263,7 +438,7 @@ public:
 		return result;
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator*(const Matrix &lhs, T1 rhs) {
 		Matrix<decltype(lhs[0][0] * rhs), N, M> result;
 		for (std::size_t j = 0; j < M; j++)
@@ -271,7 +446,7 @@ public:
 		return result;
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator/(const Matrix &lhs, T1 rhs) {
 		Matrix<decltype(lhs[0][0] / rhs), N, M> result;
 		for (std::size_t j = 0; j < M; j++)
@@ -279,7 +454,7 @@ public:
 		return result;
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator*(T1 lhs, const Matrix &rhs) {
 		Matrix<decltype(lhs * rhs[0][0]), N, M> result;
 		for (std::size_t j = 0; j < M; j++)
@@ -287,7 +462,7 @@ public:
 		return result;
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator/(T1 lhs, const Matrix &rhs) {
 		Matrix<decltype(lhs / rhs[0][0]), N, M> result;
 		for (std::size_t j = 0; j < M; j++)
@@ -324,6 +499,17 @@ public:
 	static const Matrix Identity;
 
 	Vector<T, N> data[M]{};
+
+private:
+	/// Matrices converted per pass of the batch kernels, small enough for the entry arrays to stay on the stack.
+	static constexpr std::size_t BatchBlock = 64;
+	static constexpr std::size_t BatchGrain = 1 << 14;
+};
+
+template<typename T, std::size_t N, std::size_t M>
+struct ArrayTraits<Matrix<T, N, M>> {
+	using Value = T;
+	static constexpr std::size_t Count = N * M;
 };
 
 template<typename T, std::size_t N, std::size_t M>
@@ -339,10 +525,7 @@ namespace std {
 template<typename T, size_t N, size_t M>
 struct hash<MathsCPP::Matrix<T, N, M>> {
 	size_t operator()(const MathsCPP::Matrix<T, N, M> &matrix) const noexcept {
-		size_t seed = 0;
-		for (size_t i = 0; i < M; i++)
-			MathsCPP::Maths::HashCombine(seed, matrix[i]);
-		return seed;
+		return static_cast<size_t>(MathsCPP::Maths::HashValues<T, N * M>(matrix[0].begin()));
 	}
 };
 }
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "Maths.hpp"
+#include "Parallel.hpp"
+#include "Vector.hpp"
+
+namespace MathsCPP {
+/**
+ * @brief Utilities over indexed mesh data.
+ */
+class Mesh {
+public:
+	Mesh() = delete;
+
+	/**
+	 * Finds duplicate vertices, vertices weld when they round to the same point on a grid with epsilon spacing.
+	 * Small inputs go through a flat hash table, large inputs on many threads sort the keys instead, both give the same remap.
+	 * @param vertices The vertices.
+	 * @param epsilon The grid spacing, with zero only vertices with equal values weld.
+	 * @return The unique vertex for each vertex, unique vertices are numbered from zero in the order they first appear,
+	 * so the unique count is one more than the largest entry.
+	 */
+	static std::vector<uint32_t> WeldVertices(Span<const Vector3f> vertices, float epsilon) {
+		return Weld(vertices, epsilon);
+	}
+
+	static std::vector<uint32_t> WeldVertices(Span<const Vector3d> vertices, double epsilon) {
+		return Weld(vertices, epsilon);
+	}
+
+private:
+	/// Vertices before welding sorts on many threads instead of hashing.
+	static constexpr std::size_t ParallelThreshold = 1 << 22;
+	/// Vertices per chunk when keys are computed or sorted concurrently.
+	static constexpr std::size_t ParallelGrain = 1 << 16;
+	/// Vertices ahead of the current one whose table slot is prefetched.
+	static constexpr std::size_t PrefetchDistance = 16;
+	static constexpr uint32_t Empty = ~uint32_t(0);
+
+	/// Quantized or raw bits per axis, as wide as the value type so exact welding never aliases.
+	template<typename U>
+	struct Key {
+		U x, y, z;
+
+		bool operator==(const Key &other) const { return x == other.x && y == other.y && z == other.z; }
+		bool operator<(const Key &other) const { return x != other.x ? x < other.x : y != other.y ? y < other.y : z < other.z; }
+	};
+
+	template<typename U>
+	struct Slot {
+		Key<U> key;
+		/// The unique vertex for the key, Empty for unused slots.
+		uint32_t unique = Empty;
+	};
+
+	template<typename T, typename U = std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t>>
+	static U Quantize(T value, T invEpsilon) {
+		if (invEpsilon == 0) {
+			// Exact welding keys on the bits, with -0 made positive since it equals +0.
+			if (value == 0)
+				value = 0;
+			U result;
+			std::memcpy(&result, &value, sizeof(result));
+			return result;
+		}
+		using Signed = std::make_signed_t<U>;
+		auto rounded = std::floor(value * invEpsilon + T(0.5));
+		// Out of range and NaN values are pinned to the ends of the integer range rather than overflowing the cast.
+		auto lowest = static_cast<T>(std::numeric_limits<Signed>::min());
+		auto highest = std::nextafter(-lowest, T(0));
+		rounded = rounded >= lowest ? std::min(rounded, highest) : lowest;
+		return static_cast<U>(static_cast<Signed>(rounded));
+	}
+
+	template<typename U>
+	static std::size_t Hash(const Key<U> &key, uint32_t bits) {
+		auto mixed = Maths::Mix(static_cast<uint64_t>(key.x) ^ (static_cast<uint64_t>(key.y) << 32 | static_cast<uint64_t>(key.y) >> 32), static_cast<uint64_t>(key.z) ^ 0x9E3779B97F4A7C15ull);
+		return static_cast<std::size_t>(mixed >> (64 - bits));
+	}
+
+	template<typename T>
+	static std::vector<uint32_t> Weld(Span<const Vector<T, 3>> vertices, T epsilon) {
+		auto count = vertices.size();
+		auto invEpsilon = epsilon > 0 ? 1 / epsilon : T(0);
+		using U = decltype(Quantize(epsilon, epsilon));
+		std::vector<Key<U>> keys(count);
+		Parallel::For(0, count, ParallelGrain, [&](std::size_t begin, std::size_t end) {
+			for (auto i = begin; i < end; i++) {
+				const auto &v = vertices[i];
+				keys[i] = {Quantize(v.x, invEpsilon), Quantize(v.y, invEpsilon), Quantize(v.z, invEpsilon)};
+			}
+		});
+
+		if (count >= ParallelThreshold && Parallel::GetThreadCount() > 1)
+			return WeldSorted(keys);
+		return WeldHashed(keys);
+	}
+
+	template<typename U>
+	static std::vector<uint32_t> WeldHashed(const std::vector<Key<U>> &keys) {
+		auto count = keys.size();
+		std::vector<uint32_t> remap(count);
+		std::vector<Key<U>> uniqueKeys;
+		std::vector<Slot<U>> slots;
+		uint32_t bits = 0;
+		// Grows the table to keep it at most half full, reinserting the unique keys found so far.
+		auto grow = [&]() {
+			bits = std::max<uint32_t>(bits + 1, 10);
+			slots.assign(std::size_t(1) << bits, Slot<U>());
+			auto mask = slots.size() - 1;
+			for (uint32_t unique = 0; unique < uniqueKeys.size(); unique++) {
+				auto i = Hash(uniqueKeys[unique], bits);
+				while (slots[i].unique != Empty)
+					i = (i + 1) & mask;
+				slots[i] = {uniqueKeys[unique], unique};
+			}
+		};
+		grow();
+
+		for (std::size_t v = 0; v < count; v++) {
+			if (v + PrefetchDistance < count)
+				Maths::Prefetch(&slots[Hash(keys[v + PrefetchDistance], bits)]);
+			if ((uniqueKeys.size() + 1) * 2 > slots.size())
+				grow();
+			auto mask = slots.size() - 1;
+			auto i = Hash(keys[v], bits);
+			while (slots[i].unique != Empty && !(slots[i].key == keys[v]))
+				i = (i + 1) & mask;
+			if (slots[i].unique == Empty) {
+				slots[i] = {keys[v], static_cast<uint32_t>(uniqueKeys.size())};
+				uniqueKeys.emplace_back(keys[v]);
+			}
+			remap[v] = slots[i].unique;
+		}
+		return remap;
+	}
+
+	/**
+	 * Sorts vertices by key so duplicates are adjacent, then numbers the first vertex of each run in vertex order.
+	 */
+	template<typename U>
+	static std::vector<uint32_t> WeldSorted(const std::vector<Key<U>> &keys) {
+		auto count = keys.size();
+		struct Entry {
+			Key<U> key;
+			uint32_t vertex;
+
+			bool operator<(const Entry &other) const { return key < other.key || (key == other.key && vertex < other.vertex); }
+		};
+		std::vector<Entry> entries(count);
+		Parallel::For(0, count, ParallelGrain, [&](std::size_t begin, std::size_t end) {
+			for (auto i = begin; i < end; i++)
+				entries[i] = {keys[i], static_cast<uint32_t>(i)};
+		});
+
+		// Sort chunks concurrently, then merge pairs of neighbouring runs concurrently until one run is left.
+		auto chunks = (count + ParallelGrain - 1) / ParallelGrain;
+		Parallel::For(0, chunks, 1, [&](std::size_t begin, std::size_t end) {
+			for (auto chunk = begin; chunk < end; chunk++)
+				std::sort(entries.begin() + chunk * ParallelGrain, entries.begin() + std::min(count, (chunk + 1) * ParallelGrain));
+		});
+		for (auto width = ParallelGrain; width < count; width *= 2) {
+			auto pairs = (count + 2 * width - 1) / (2 * width);
+			Parallel::For(0, pairs, 1, [&](std::size_t begin, std::size_t end) {
+				for (auto pair = begin; pair < end; pair++) {
+					auto first = pair * 2 * width, middle = std::min(count, first + width), last = std::min(count, first + 2 * width);
+					std::inplace_merge(entries.begin() + first, entries.begin() + middle, entries.begin() + last);
+				}
+			});
+		}
+
+		// Each vertex points at the first vertex of its run, which is the lowest index since ties sort by index.
+		std::vector<uint32_t> first(count);
+		std::vector<uint8_t> isFirst(count, 0);
+		uint32_t head = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			if (i == 0 || !(entries[i].key == entries[i - 1].key)) {
+				head = entries[i].vertex;
+				isFirst[head] = 1;
+			}
+			first[entries[i].vertex] = head;
+		}
+
+		// Number the first vertices in vertex order, then map every vertex through its first vertex. The numbers are kept apart
+		// from the remap being written, so no chunk reads an entry another chunk is writing.
+		std::vector<uint32_t> number(count), remap(count);
+		uint32_t unique = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			if (isFirst[i])
+				number[i] = unique++;
+		}
+		Parallel::For(0, count, ParallelGrain, [&](std::size_t begin, std::size_t end) {
+			for (auto i = begin; i < end; i++)
+				remap[i] = number[first[i]];
+		});
+		return remap;
+	}
+};
+}
@@ -0,0 +1,334 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace MathsCPP {
+/**
+ * @brief Runs loops across the available hardware threads, on a pool of workers that steal work from each other.
+ * A loop is halved recursively, a thread pushes the second half onto its own deque and carries on with the first,
+ * idle threads steal the oldest and so largest halves from the other end of the deque (Chase-Lev).
+ * The calling thread takes part, and loops may run inside loops.
+ *
+ * Batch functions across the library run through For with a grain per type, sized so a chunk is tens of microseconds of work
+ * and worth handing to another thread. An input of one grain or less is a single chunk and runs on the calling thread without
+ * touching the pool, so batch functions cost nothing extra on small inputs and need no separate serial path.
+ */
+class Parallel {
+public:
+	Parallel() = delete;
+
+	/**
+	 * Gets the number of threads loops are split across.
+	 * @return The thread count, at least one.
+	 */
+	static std::size_t GetThreadCount() {
+		static const std::size_t Count = std::max(std::thread::hardware_concurrency(), 1u);
+		return Count;
+	}
+
+	/**
+	 * Calls a function over a range split into chunks, chunks run concurrently and in no particular order.
+	 * The function is always called with single chunks, which depend only on the range and grain and not on the thread count.
+	 * @tparam Func Invocable as func(chunkBegin, chunkEnd).
+	 * @param begin The start of the range.
+	 * @param end The end of the range.
+	 * @param grain The size of each chunk, the last chunk may be smaller.
+	 * @param func The function.
+	 */
+	template<typename Func>
+	static void For(std::size_t begin, std::size_t end, std::size_t grain, Func &&func) {
+		if (begin >= end)
+			return;
+		grain = std::max<std::size_t>(grain, 1);
+		auto chunks = (end - begin + grain - 1) / grain;
+		Job job{begin, end, grain, const_cast<void *>(static_cast<const void *>(std::addressof(func))),
+			[](void *context, std::size_t chunkBegin, std::size_t chunkEnd) {
+				(*static_cast<std::remove_reference_t<Func> *>(context))(chunkBegin, chunkEnd);
+			}};
+		if (chunks == 1 || GetThreadCount() == 1) {
+			job.Run(0, chunks);
+			return;
+		}
+		Pool::Get().Run(job, chunks);
+	}
+
+	/**
+	 * Maps chunks of a range to values and combines them, chunks are split as in For.
+	 * Values are combined pairwise in a fixed tree over the chunks, so results are reproducible for any thread count,
+	 * including floating point sums.
+	 * @tparam Value The result type.
+	 * @tparam Func Invocable as func(chunkBegin, chunkEnd) returning a Value.
+	 * @tparam Combine Invocable as combine(lhs, rhs) returning a Value, lhs covers the earlier chunks.
+	 * @param begin The start of the range.
+	 * @param end The end of the range.
+	 * @param grain The size of each chunk, the last chunk may be smaller.
+	 * @param identity The result for an empty range.
+	 * @param func The function mapping each chunk.
+	 * @param combine The function combining two results.
+	 * @return The combined result.
+	 */
+	template<typename Value, typename Func, typename Combine>
+	static Value Reduce(std::size_t begin, std::size_t end, std::size_t grain, Value identity, Func &&func, Combine &&combine) {
+		if (begin >= end)
+			return identity;
+		grain = std::max<std::size_t>(grain, 1);
+		auto chunks = (end - begin + grain - 1) / grain;
+		std::vector<Value> partials(chunks, identity);
+		For(begin, end, grain, [&](std::size_t chunkBegin, std::size_t chunkEnd) {
+			partials[(chunkBegin - begin) / grain] = func(chunkBegin, chunkEnd);
+		});
+		for (std::size_t width = 1; width < chunks; width *= 2) {
+			for (std::size_t i = 0; i + width < chunks; i += 2 * width)
+				partials[i] = combine(partials[i], partials[i + width]);
+		}
+		return partials[0];
+	}
+
+private:
+	/// A loop, with its function behind a type erased call.
+	struct Job {
+		std::size_t begin, end, grain;
+		void *context;
+		void (*call)(void *context, std::size_t chunkBegin, std::size_t chunkEnd);
+
+		void Run(std::size_t firstChunk, std::size_t lastChunk) const {
+			for (auto chunk = firstChunk; chunk < lastChunk; chunk++) {
+				auto chunkBegin = begin + chunk * grain;
+				call(context, chunkBegin, std::min(chunkBegin + grain, end));
+			}
+		}
+	};
+
+	/// Chunks of a loop waiting on a deque, it lives on the stack of the thread that pushed it until done is set.
+	struct Task {
+		const Job *job;
+		std::size_t firstChunk, lastChunk;
+		std::atomic<bool> done{false};
+	};
+
+	/**
+	 * @brief A fixed size Chase-Lev deque, the owning thread pushes and pops at the bottom while other threads steal from the top.
+	 * Memory orders follow Le, Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak Memory Models".
+	 */
+	class Deque {
+	public:
+		/**
+		 * Pushes a task, only from the owning thread.
+		 * @param task The task.
+		 * @return False when the deque is full, the task should then be run directly.
+		 */
+		bool Push(Task *task) {
+			auto b = bottom.load(std::memory_order_relaxed);
+			auto t = top.load(std::memory_order_acquire);
+			if (b - t >= Capacity)
+				return false;
+			tasks[b & (Capacity - 1)].store(task, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * Pops the newest task, only from the owning thread.
+		 * @return The task, or null when it is empty.
+		 */
+		Task *Pop() {
+			auto b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			auto t = top.load(std::memory_order_relaxed);
+			if (t > b) {
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+			auto task = tasks[b & (Capacity - 1)].load(std::memory_order_relaxed);
+			if (t == b) {
+				// The last task, a thief may be taking it at the same time.
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					task = nullptr;
+				bottom.store(b + 1, std::memory_order_relaxed);
+			}
+			return task;
+		}
+
+		/**
+		 * Steals the oldest task, from any thread.
+		 * @return The task, or null when it is empty or another thread took it first.
+		 */
+		Task *Steal() {
+			auto t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			auto b = bottom.load(std::memory_order_acquire);
+			if (t >= b)
+				return nullptr;
+			auto task = tasks[t & (Capacity - 1)].load(std::memory_order_relaxed);
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+			return task;
+		}
+
+	private:
+		/// Loops push at most one task per halving, so this covers deep nesting of large loops.
+		static constexpr std::int64_t Capacity = 256;
+
+		alignas(64) std::atomic<std::int64_t> top{0};
+		alignas(64) std::atomic<std::int64_t> bottom{0};
+		std::atomic<Task *> tasks[Capacity] = {};
+	};
+
+	/**
+	 * @brief The worker threads and their deques, started on the first loop with more than one chunk.
+	 * Threads outside the pool that run loops borrow one of a few spare deques for the length of the loop.
+	 */
+	class Pool {
+	public:
+		Pool() :
+			workerCount(GetThreadCount() - 1),
+			deques(std::make_unique<Deque[]>(workerCount + CallerSlots)) {
+			workers.reserve(workerCount);
+			for (std::size_t i = 0; i < workerCount; i++)
+				workers.emplace_back([this, i]() { Work(i); });
+		}
+
+		~Pool() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+			}
+			wake.notify_all();
+			for (auto &worker : workers)
+				worker.join();
+		}
+
+		static Pool &Get() {
+			static Pool pool;
+			return pool;
+		}
+
+		void Run(const Job &job, std::size_t chunks) {
+			auto &local = Local();
+			if (local) {
+				Execute(job, 0, chunks, *local);
+				return;
+			}
+			for (std::size_t slot = 0; slot < CallerSlots; slot++) {
+				if (callerSlots[slot].exchange(true, std::memory_order_acquire))
+					continue;
+				local = &deques[workerCount + slot];
+				Execute(job, 0, chunks, *local);
+				local = nullptr;
+				callerSlots[slot].store(false, std::memory_order_release);
+				return;
+			}
+			// More threads are running loops at once than there are spare deques.
+			job.Run(0, chunks);
+		}
+
+	private:
+		/// Threads outside the pool that can run loops at the same time.
+		static constexpr std::size_t CallerSlots = 8;
+		/// Failed rounds of stealing before a worker sleeps.
+		static constexpr std::size_t SpinCount = 64;
+
+		/// The deque of the current thread, null for threads outside the pool that are not running a loop.
+		static Deque *&Local() {
+			thread_local Deque *deque = nullptr;
+			return deque;
+		}
+
+		void Execute(const Job &job, std::size_t firstChunk, std::size_t lastChunk, Deque &local) {
+			while (lastChunk - firstChunk > 1) {
+				auto middleChunk = firstChunk + (lastChunk - firstChunk) / 2;
+				Task second{&job, middleChunk, lastChunk};
+				if (!local.Push(&second)) {
+					Execute(job, middleChunk, lastChunk, local);
+					lastChunk = middleChunk;
+					continue;
+				}
+				Notify();
+				Execute(job, firstChunk, middleChunk, local);
+				// Everything pushed since was popped again, so the bottom task is the second half unless it was stolen.
+				if (local.Pop() == &second) {
+					firstChunk = middleChunk;
+					continue;
+				}
+				while (!second.done.load(std::memory_order_acquire)) {
+					if (!StealAndRun(local))
+						std::this_thread::yield();
+				}
+				return;
+			}
+			job.Run(firstChunk, lastChunk);
+		}
+
+		bool StealAndRun(Deque &local) {
+			thread_local uint32_t random = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+			random ^= random << 13;
+			random ^= random >> 17;
+			random ^= random << 5;
+			auto count = workerCount + CallerSlots;
+			for (std::size_t i = 0, start = random % count; i < count; i++) {
+				auto &victim = deques[(start + i) % count];
+				if (&victim == &local)
+					continue;
+				if (auto task = victim.Steal()) {
+					Execute(*task->job, task->firstChunk, task->lastChunk, local);
+					task->done.store(true, std::memory_order_release);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/// Wakes a sleeping worker after a push, the epoch lets a worker that is about to sleep see the push instead.
+		void Notify() {
+			epoch.fetch_add(1);
+			if (sleeping.load() > 0) {
+				std::lock_guard<std::mutex> lock(mutex);
+				wake.notify_one();
+			}
+		}
+
+		void Work(std::size_t index) {
+			auto &local = deques[index];
+			Local() = &local;
+			for (std::size_t failed = 0;;) {
+				auto seen = epoch.load();
+				if (StealAndRun(local)) {
+					failed = 0;
+					continue;
+				}
+				if (++failed < SpinCount) {
+					std::this_thread::yield();
+					continue;
+				}
+				failed = 0;
+				std::unique_lock<std::mutex> lock(mutex);
+				if (stopping)
+					return;
+				sleeping.fetch_add(1);
+				wake.wait(lock, [&]() { return stopping || epoch.load() != seen; });
+				sleeping.fetch_sub(1);
+			}
+		}
+
+		std::size_t workerCount;
+		std::unique_ptr<Deque[]> deques;
+		std::atomic<bool> callerSlots[CallerSlots] = {};
+		std::vector<std::thread> workers;
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::atomic<uint64_t> epoch{0};
+		std::atomic<std::size_t> sleeping{0};
+		bool stopping = false;
+	};
+};
+}
@@ -0,0 +1,405 @@
+#pragma once
+
+#include <vector>
+
+#include "Rectangle.hpp"
+
+namespace MathsCPP {
+/**
+ * @brief A loose quadtree spatial index over rectangles.
+ * Each rectangle belongs to one cell, chosen by its size and centre, and every node's loose bounds are twice its cell size.
+ * A rectangle is kept in the deepest existing node on the path to its cell, a node is only split once it holds more than the split threshold of
+ * rectangles that belong deeper, and a subtree is merged back into its root once it holds half that many. This keeps sparse areas shallow and a
+ * moving rectangle only changes node when its centre crosses a cell edge.
+ * Nodes and entries are pooled in flat arrays and recycled through free lists.
+ * @tparam T The rectangle value type.
+ */
+template<typename T>
+class QuadTree {
+public:
+	using Handle = uint32_t;
+	static constexpr Handle Invalid = ~Handle(0);
+
+	/**
+	 * Creates a new quadtree.
+	 * @param bounds The area covered by the tree, rectangles outside of it are kept in the root node.
+	 * @param maxDepth The deepest level nodes may be created at, at most 30.
+	 * @param splitThreshold How many rectangles that belong deeper a node holds before it is split, at least 1.
+	 */
+	explicit QuadTree(const Rectangle<T> &bounds, uint32_t maxDepth = 10, uint32_t splitThreshold = 32) :
+		origin(static_cast<Scalar>(bounds.x), static_cast<Scalar>(bounds.y)),
+		size(static_cast<Scalar>(std::max(bounds.w, bounds.h))),
+		maxDepth(std::min(maxDepth, 30u)),
+		splitThreshold(std::max(splitThreshold, 1u)) {
+		nodes.emplace_back();
+	}
+
+	/**
+	 * Inserts a rectangle into the tree.
+	 * @param rect The rectangle.
+	 * @return The handle used to move or remove the rectangle.
+	 */
+	Handle Insert(const Rectangle<T> &rect) {
+		Handle handle;
+		if (freeEntry != Invalid) {
+			handle = freeEntry;
+			freeEntry = entries[handle].slot;
+		} else {
+			handle = static_cast<Handle>(entries.size());
+			entries.emplace_back();
+		}
+
+		Link(handle, rect, Locate(rect));
+		count++;
+		return handle;
+	}
+
+	/**
+	 * Removes a rectangle from the tree, the handle may be reused by later inserts.
+	 * @param handle The rectangle handle.
+	 */
+	void Remove(Handle handle) {
+		Unlink(handle);
+		entries[handle].slot = freeEntry;
+		freeEntry = handle;
+		count--;
+	}
+
+	/**
+	 * Moves a rectangle, this only relinks the entry when its centre or size moves it into a different cell.
+	 * @param handle The rectangle handle.
+	 * @param rect The new rectangle.
+	 */
+	void Move(Handle handle, const Rectangle<T> &rect) {
+		const auto &entry = entries[handle];
+		auto cell = Locate(rect);
+		if (cell.level == entry.cell.level && cell.x == entry.cell.x && cell.y == entry.cell.y) {
+			nodes[entry.node].rects[entry.slot] = rect;
+			return;
+		}
+		Unlink(handle);
+		Link(handle, rect, cell);
+	}
+
+	/**
+	 * Removes all rectangles and nodes.
+	 */
+	void Clear() {
+		for (auto &node : nodes) {
+			node.rects.clear();
+			node.handles.clear();
+		}
+		nodes.resize(1);
+		nodes[0] = {};
+		entries.clear();
+		freeNode = Invalid;
+		freeEntry = Invalid;
+		count = 0;
+	}
+
+	/**
+	 * Calls a function with the handle of every rectangle that overlaps a region.
+	 * @tparam Func Invocable as func(Handle).
+	 * @param region The region.
+	 * @param func The function.
+	 */
+	template<typename Func>
+	void Query(const Rectangle<T> &region, Func &&func) const {
+		Visit(static_cast<Scalar>(region.x), static_cast<Scalar>(region.y),
+			static_cast<Scalar>(region.x + region.w), static_cast<Scalar>(region.y + region.h), [&](const Rectangle<T> &rect) {
+			return rect.Intersects(region);
+		}, func);
+	}
+
+	/**
+	 * Calls a function with the handle of every rectangle that contains a point.
+	 * @tparam Func Invocable as func(Handle).
+	 * @param point The point.
+	 * @param func The function.
+	 */
+	template<typename Func>
+	void Query(const Vector<T, 2> &point, Func &&func) const {
+		Visit(static_cast<Scalar>(point.x), static_cast<Scalar>(point.y), static_cast<Scalar>(point.x), static_cast<Scalar>(point.y), [&](const Rectangle<T> &rect) {
+			return rect.Contains(point);
+		}, func);
+	}
+
+	/**
+	 * Gets the handles of every rectangle that overlaps a region.
+	 * @param region The region.
+	 * @return The overlapping handles.
+	 */
+	std::vector<Handle> Query(const Rectangle<T> &region) const {
+		std::vector<Handle> result;
+		Query(region, [&](Handle handle) { result.emplace_back(handle); });
+		return result;
+	}
+
+	/**
+	 * Gets the handles of every rectangle that contains a point.
+	 * @param point The point.
+	 * @return The containing handles.
+	 */
+	std::vector<Handle> Query(const Vector<T, 2> &point) const {
+		std::vector<Handle> result;
+		Query(point, [&](Handle handle) { result.emplace_back(handle); });
+		return result;
+	}
+
+	const Rectangle<T> &GetRectangle(Handle handle) const { return nodes[entries[handle].node].rects[entries[handle].slot]; }
+	std::size_t GetSize() const { return count; }
+	std::size_t GetNodeCount() const { return nodes.size(); }
+
+private:
+	using Scalar = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+
+	struct Cell {
+		uint32_t level = 0;
+		uint32_t x = 0, y = 0;
+	};
+
+	struct Node {
+		Handle children[4] = {Invalid, Invalid, Invalid, Invalid};
+		Handle parent = Invalid;
+		uint32_t level = 0;
+		/// Number of entries in this node and all of its descendants.
+		uint32_t count = 0;
+		/// Number of entries in this node whose cell is deeper than it.
+		uint32_t deeper = 0;
+		/// Entries are stored contiguously so a query scans a node without chasing pointers.
+		std::vector<Rectangle<T>> rects;
+		std::vector<Handle> handles;
+	};
+
+	struct Entry {
+		/// The cell the rectangle belongs to, it is stored in this cell's node or the deepest existing node above it.
+		Cell cell;
+		Handle node = Invalid;
+		/// Index into the node arrays, or the next free entry once removed.
+		uint32_t slot = Invalid;
+	};
+
+	/**
+	 * Finds the deepest cell whose loose bounds fully contain a rectangle.
+	 * @param rect The rectangle.
+	 * @return The cell, rectangles centred outside of the tree bounds go to the root.
+	 */
+	Cell Locate(const Rectangle<T> &rect) const {
+		auto extent = static_cast<Scalar>(std::max(rect.w, rect.h));
+		auto cx = static_cast<Scalar>(rect.x) + static_cast<Scalar>(rect.w) / 2 - origin.x;
+		auto cy = static_cast<Scalar>(rect.y) + static_cast<Scalar>(rect.h) / 2 - origin.y;
+		if (!(cx >= 0 && cy >= 0 && cx < size && cy < size))
+			return {};
+
+		Cell cell;
+		auto cellSize = size;
+		while (cell.level < maxDepth && cellSize / 2 >= extent) {
+			cellSize /= 2;
+			cell.level++;
+		}
+		auto cells = static_cast<Scalar>(1u << cell.level);
+		cell.x = std::min(static_cast<uint32_t>(cx / size * cells), (1u << cell.level) - 1);
+		cell.y = std::min(static_cast<uint32_t>(cy / size * cells), (1u << cell.level) - 1);
+		return cell;
+	}
+
+	Handle AllocateNode(Handle parent) {
+		Handle index;
+		if (freeNode != Invalid) {
+			index = freeNode;
+			freeNode = nodes[index].parent;
+			std::fill(std::begin(nodes[index].children), std::end(nodes[index].children), Invalid);
+		} else {
+			index = static_cast<Handle>(nodes.size());
+			nodes.emplace_back();
+		}
+		nodes[index].parent = parent;
+		nodes[index].level = nodes[parent].level + 1;
+		return index;
+	}
+
+	static uint32_t Quadrant(const Cell &cell, uint32_t level) {
+		auto shift = cell.level - level - 1;
+		return ((cell.x >> shift) & 1) | (((cell.y >> shift) & 1) << 1);
+	}
+
+	bool HasChildren(Handle index) const {
+		const auto &children = nodes[index].children;
+		return (children[0] & children[1] & children[2] & children[3]) != Invalid;
+	}
+
+	/// Appends an entry to a node's arrays, node counts are left to the caller.
+	void Attach(Handle index, Handle handle, const Rectangle<T> &rect) {
+		auto &node = nodes[index];
+		auto &entry = entries[handle];
+		entry.node = index;
+		entry.slot = static_cast<uint32_t>(node.handles.size());
+		node.rects.emplace_back(rect);
+		node.handles.emplace_back(handle);
+		node.deeper += entry.cell.level > node.level;
+	}
+
+	/// Removes an entry from its node's arrays, node counts are left to the caller.
+	void Detach(Handle handle) {
+		auto &entry = entries[handle];
+		auto &node = nodes[entry.node];
+		auto last = node.handles.back();
+		node.rects[entry.slot] = node.rects.back();
+		node.handles[entry.slot] = last;
+		entries[last].slot = entry.slot;
+		node.rects.pop_back();
+		node.handles.pop_back();
+		node.deeper -= entry.cell.level > node.level;
+		entry.node = Invalid;
+	}
+
+	/**
+	 * Moves every entry that belongs deeper than a node into its children, creating them as needed, and splits any child that is then over the threshold.
+	 * @param index The node.
+	 */
+	void Split(Handle index) {
+		auto level = nodes[index].level;
+		for (std::size_t i = 0; i < nodes[index].handles.size();) {
+			auto handle = nodes[index].handles[i];
+			if (entries[handle].cell.level == level) {
+				i++;
+				continue;
+			}
+			auto quadrant = Quadrant(entries[handle].cell, level);
+			auto child = nodes[index].children[quadrant];
+			if (child == Invalid) {
+				child = AllocateNode(index);
+				nodes[index].children[quadrant] = child;
+			}
+			// Detaching swaps the last entry into slot i, so i is not advanced.
+			auto rect = nodes[index].rects[i];
+			Detach(handle);
+			Attach(child, handle, rect);
+			nodes[child].count++;
+		}
+		// Splitting a child can grow the node pool, so children are read by quadrant rather than through a reference.
+		for (uint32_t quadrant = 0; quadrant < 4; quadrant++) {
+			auto child = nodes[index].children[quadrant];
+			if (child != Invalid && nodes[child].deeper > splitThreshold)
+				Split(child);
+		}
+	}
+
+	/**
+	 * Moves every entry below a node up into it and gives its descendants back to the pool.
+	 * @param index The node.
+	 */
+	void Merge(Handle index) {
+		for (auto &child : nodes[index].children) {
+			if (child == Invalid)
+				continue;
+			Absorb(index, child);
+			child = Invalid;
+		}
+	}
+
+	void Absorb(Handle into, Handle index) {
+		auto &node = nodes[index];
+		for (std::size_t i = 0; i < node.handles.size(); i++)
+			Attach(into, node.handles[i], node.rects[i]);
+		node.rects.clear();
+		node.handles.clear();
+		node.count = 0;
+		node.deeper = 0;
+		for (auto child : node.children) {
+			if (child != Invalid)
+				Absorb(into, child);
+		}
+		node.parent = freeNode;
+		freeNode = index;
+	}
+
+	void Link(Handle handle, const Rectangle<T> &rect, const Cell &cell) {
+		entries[handle].cell = cell;
+		Handle index = 0;
+		nodes[index].count++;
+		for (uint32_t level = 0; level < cell.level; level++) {
+			auto child = nodes[index].children[Quadrant(cell, level)];
+			if (child == Invalid)
+				break;
+			index = child;
+			nodes[index].count++;
+		}
+
+		Attach(index, handle, rect);
+		if (nodes[index].deeper > splitThreshold)
+			Split(index);
+	}
+
+	void Unlink(Handle handle) {
+		auto index = entries[handle].node;
+		Detach(handle);
+
+		// Walk back up to the root, the highest node left at half the split threshold or less takes back all of its descendants' entries.
+		Handle merged = Invalid;
+		for (; index != Invalid; index = nodes[index].parent) {
+			if (--nodes[index].count <= splitThreshold / 2 && HasChildren(index))
+				merged = index;
+		}
+		if (merged != Invalid)
+			Merge(merged);
+	}
+
+	template<typename Pred, typename Func>
+	void Visit(Scalar minX, Scalar minY, Scalar maxX, Scalar maxY, Pred &&pred, Func &&func) const {
+		struct Item {
+			Handle node;
+			Scalar x, y, size;
+		};
+		Item stack[4 * 32 + 1];
+		std::size_t top = 0;
+		stack[top++] = {0, origin.x, origin.y, size};
+
+		while (top != 0) {
+			auto item = stack[--top];
+			const auto &node = nodes[item.node];
+			if (node.count == 0)
+				continue;
+
+			// Test entries in blocks without branching on the result, then only walk the hits.
+			for (std::size_t i = 0; i < node.rects.size(); i += 64) {
+				auto n = std::min<std::size_t>(node.rects.size() - i, 64);
+				uint64_t mask = 0;
+				for (std::size_t j = 0; j < n; j++)
+					mask |= static_cast<uint64_t>(pred(node.rects[i + j])) << j;
+				for (; mask != 0; mask &= mask - 1)
+					func(node.handles[i + Maths::CountTrailingZeros(mask)]);
+			}
+
+			auto half = item.size / 2;
+			for (uint32_t quadrant = 0; quadrant < 4; quadrant++) {
+				auto child = node.children[quadrant];
+				if (child == Invalid)
+					continue;
+				auto x = item.x + ((quadrant & 1) ? half : 0);
+				auto y = item.y + ((quadrant & 2) ? half : 0);
+				// Loose bounds extend half a cell past each edge of the child cell.
+				auto loose = half / 2;
+				if (x - loose > maxX || x + half + loose < minX || y - loose > maxY || y + half + loose < minY)
+					continue;
+				stack[top++] = {child, x, y, half};
+			}
+		}
+	}
+
+	Vector<Scalar, 2> origin;
+	Scalar size;
+	uint32_t maxDepth;
+	uint32_t splitThreshold;
+
+	std::vector<Node> nodes;
+	std::vector<Entry> entries;
+	Handle freeNode = Invalid;
+	Handle freeEntry = Invalid;
+	std::size_t count = 0;
+};
+
+using QuadTreef = QuadTree<float>;
+using QuadTreed = QuadTree<double>;
+using QuadTreei = QuadTree<int32_t>;
+}
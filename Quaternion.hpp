@@ -8,17 +8,18 @@ class Quaternion {
 public:
 	constexpr Quaternion() = default;
 	constexpr Quaternion(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr explicit Quaternion(T1 s) { std::fill(begin(), end(), static_cast<T>(s)); }
 	template<typename T1>
 	constexpr Quaternion(const Quaternion<T1> &q) { copy_cast(q.begin(), q.end(), begin()); }
 	template<typename T1>
 	constexpr explicit Quaternion(const Vector<T1, 3> &v) {
-		auto sx = std::sin(v.x * 0.5f);
+		using std::sin;
+		auto sx = sin(v.x * 0.5f);
 		auto cx = Maths::CosFromSin(sx, v.x * 0.5f);
-		auto sy = std::sin(v.y * 0.5f);
+		auto sy = sin(v.y * 0.5f);
 		auto cy = Maths::CosFromSin(sy, v.y * 0.5f);
-		auto sz = std::sin(v.z * 0.5f);
+		auto sz = sin(v.z * 0.5f);
 		auto cz = Maths::CosFromSin(sz, v.z * 0.5f);
 
 		auto cycz = cy * cz;
@@ -122,7 +123,8 @@ public:
 	 * @return The length.
 	 */
 	auto Length() const {
-		return std::sqrt(Length2());
+		using std::sqrt;
+		return sqrt(Length2());
 	}
 
 	/**
@@ -133,6 +135,34 @@ public:
 		return *this / Length();
 	}
 
+	/**
+	 * Gets the length of this quaternion using Maths::Fast::Sqrt.
+	 * @tparam P The precision.
+	 * @return The length.
+	 */
+	template<Maths::Precision P = Maths::Precision::Medium>
+	auto LengthFast() const {
+		return Maths::Fast::Sqrt<P>(Length2());
+	}
+
+	/**
+	 * Gets the unit quaternion with the same rotation, multiplying by Maths::Fast::Rsqrt instead of dividing by the length.
+	 * @tparam P The precision.
+	 * @return The normalized quaternion.
+	 */
+	template<Maths::Precision P = Maths::Precision::Medium>
+	auto NormalizeFast() const {
+		return *this * Maths::Fast::Rsqrt<P>(Length2());
+	}
+
+	/**
+	 * Gets the conjugate of this quaternion, for a normalized quaternion this is the inverse rotation.
+	 * @return The conjugate.
+	 */
+	constexpr Quaternion Conjugate() const {
+		return {-x, -y, -z, w};
+	}
+
 	/**
 	 * Calculates the slerp between this quaternion and another quaternion, they must be normalized!
 	 * @param other The other quaternion.
@@ -141,16 +171,17 @@ public:
 	 */
 	template<typename T1, typename T2>
 	auto Slerp(const Quaternion<T1> &other, T2 t) const {
+		using std::abs, std::sqrt, std::atan2, std::sin;
 		auto cosom = x * other.x + y * other.y + z * other.z + w * other.w;
-		auto absCosom = std::abs(cosom);
+		auto absCosom = abs(cosom);
 		T2 scale0, scale1;
 
 		if (1 - absCosom > 1E-6) {
 			auto sinSqr = 1 - absCosom * absCosom;
-			auto sinom = 1 / std::sqrt(sinSqr);
-			auto omega = std::atan2(sinSqr * sinom, absCosom);
-			scale0 = std::sin((1 - t) * omega) * sinom;
-			scale1 = std::sin(t * omega) * sinom;
+			auto sinom = 1 / sqrt(sinSqr);
+			auto omega = atan2(sinSqr * sinom, absCosom);
+			scale0 = sin((1 - t) * omega) * sinom;
+			scale1 = sin(t * omega) * sinom;
 		} else {
 			scale0 = 1 - t;
 			scale1 = t;
@@ -160,65 +191,50 @@ public:
 	
 		return (scale0 * *this) + (scale1 * other);
 	}
+
+	/**
+	 * Calculates the slerp between this quaternion and another quaternion using Maths::Fast, they must be normalized!
+	 * @tparam P The precision.
+	 * @param other The other quaternion.
+	 * @param t The progression.
+	 * @return Left slerp right.
+	 */
+	template<Maths::Precision P = Maths::Precision::Medium, typename T1, typename T2>
+	auto SlerpFast(const Quaternion<T1> &other, T2 t) const {
+		auto cosom = x * other.x + y * other.y + z * other.z + w * other.w;
+		auto absCosom = std::abs(cosom);
+		T2 scale0, scale1;
+
+		if (1 - absCosom > 1E-6) {
+			auto sinSqr = 1 - absCosom * absCosom;
+			auto sinom = Maths::Fast::Rsqrt<P>(sinSqr);
+			auto omega = Maths::Fast::Atan2<P>(sinSqr * sinom, absCosom);
+			scale0 = Maths::Fast::Sin<P>((1 - t) * omega) * sinom;
+			scale1 = Maths::Fast::Sin<P>(t * omega) * sinom;
+		} else {
+			scale0 = 1 - t;
+			scale1 = t;
+		}
+
+		scale1 = cosom >= 0.0f ? scale1 : -scale1;
+
+		return (scale0 * *this) + (scale1 * other);
+	}
 	
 	/**
-	 * Converts this quaternion to a 4x4 matrix.
+	 * Converts this quaternion to a 4x4 matrix for row vectors, the transpose of ToRotationMatrix.
 	 * @return The rotation matrix which represents the exact same rotation as this quaternion.
 	 */
 	auto ToMatrix() const {
-		auto w2 = w * w;
-		auto x2 = x * x;
-		auto y2 = y * y;
-		auto z2 = z * z;
-		auto zw = z * w;
-		auto xy = x * y;
-		auto xz = x * z;
-		auto yw = y * w;
-		auto yz = y * z;
-		auto xw = x * w;
-
-		Matrix<T, 4, 4> result;
-		result[0][0] = w2 + x2 - z2 - y2;
-		result[0][1] = xy + zw + zw + xy;
-		result[0][2] = xz - yw + xz - yw;
-		result[1][0] = -zw + xy - zw + xy;
-		result[1][1] = y2 - z2 + w2 - x2;
-		result[1][2] = yz + yz + xw + xw;
-		result[2][0] = yw + xz + xz + yw;
-		result[2][1] = yz + yz - xw - xw;
-		result[2][2] = z2 - y2 - x2 + w2;
-		return result;
+		return ToRotationMatrix().Transpose();
 	}
 
 	/**
-	 * Converts this quaternion to a 3x3 matrix representing the exact same
-	 * rotation as this quaternion.
+	 * Converts this quaternion to a 4x4 matrix that rotates column vectors, as Matrix * Vector does, matching Quaternion * Vector.
 	 * @return The rotation matrix which represents the exact same rotation as this quaternion.
 	 */
 	auto ToRotationMatrix() const {
-		auto xy = x * y;
-		auto xz = x * z;
-		auto xw = x * w;
-		auto yz = y * z;
-		auto yw = y * w;
-		auto zw = z * w;
-		auto x2 = x * x;
-		auto y2 = y * y;
-		auto z2 = z * z;
-
-		Matrix<T, 4, 4> result;
-		result[0][0] = 1 - 2 * (y2 + z2);
-		result[0][1] = 2 * (xy - zw);
-		result[0][2] = 2 * (xz + yw);
-		//result[0][3] = 0;
-		result[1][0] = 2 * (xy + zw);
-		result[1][1] = 1 - 2 * (x2 + z2);
-		result[1][2] = 2 * (yz - xw);
-		//result[1][3] = 0;
-		result[2][0] = 2 * (xz - yw);
-		result[2][1] = 2 * (yz + xw);
-		result[2][2] = 1 - 2 * (x2 + y2);
-		return result;
+		return Matrix<T, 4, 4>::FromTRS({}, *this);
 	}
 
 	/**
@@ -233,10 +249,26 @@ public:
 		return result;
 	}
 
+	/**
+	 * Converts this quaternion to euler angles using Maths::Fast::Atan2 and Maths::Fast::Asin.
+	 * @tparam P The precision.
+	 * @return The euler angle representation of this quaternion.
+	 */
+	template<Maths::Precision P = Maths::Precision::Medium>
+	auto ToEulerFast() const {
+		Vector3f result;
+		result.x = Maths::Fast::Atan2<P>(2.0f * (x * w - y * z), 1.0f - 2.0f * (x * x + y * y));
+		// Rounding can push the sine just past one, where the approximation has no meaning.
+		result.y = Maths::Fast::Asin<P>(std::clamp<T>(2 * (x * z + y * w), -1, 1));
+		result.z = Maths::Fast::Atan2<P>(2.0f * (z * w - x * y), 1.0f - 2.0f * (y * y + z * z));
+		return result;
+	}
+
 	template<typename T1>
 	constexpr friend auto operator==(const Quaternion &lhs, const Quaternion<T1> &rhs) {
+		using std::abs;
 		for (std::size_t i = 0; i < 4; i++) {
-			if (std::abs(lhs[i] - rhs[i]) > 0.0001f)
+			if (abs(lhs[i] - rhs[i]) > 0.0001f)
 				return false;
 		}
 		return true;
@@ -244,8 +276,9 @@ public:
 
 	template<typename T1>
 	constexpr friend auto operator!=(const Quaternion &lhs, const Quaternion<T1> &rhs) {
+		using std::abs;
 		for (std::size_t i = 0; i < 4; i++) {
-			if (std::abs(lhs[i] - rhs[i]) <= 0.0001f)
+			if (abs(lhs[i] - rhs[i]) <= 0.0001f)
 				return true;
 		}
 		return false;
@@ -299,7 +332,7 @@ public:
 		return rhs + 2.0f * (cross1 * lhs.w + cross2);
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator*(const Quaternion &lhs, T1 rhs) {
 		Quaternion<decltype(lhs[0] * rhs)> result;
 		for (std::size_t i = 0; i < 4; i++)
@@ -307,7 +340,7 @@ public:
 		return result;
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator/(const Quaternion &lhs, T1 rhs) {
 		Quaternion<decltype(lhs[0] / rhs)> result;
 		for (std::size_t i = 0; i < 4; i++)
@@ -320,7 +353,7 @@ public:
 		return rhs * lhs;
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator*(T1 lhs, const Quaternion &rhs) {
 		Quaternion<decltype(lhs *rhs[0])> result;
 		for (std::size_t i = 0; i < 4; i++)
@@ -328,7 +361,7 @@ public:
 		return result;
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator/(T1 lhs, const Quaternion &rhs) {
 		Quaternion<decltype(lhs / rhs[0])> result;
 		for (std::size_t i = 0; i < 4; i++)
@@ -369,6 +402,12 @@ public:
 	T x{}, y{}, z{}, w{1};
 };
 
+template<typename T>
+struct ArrayTraits<Quaternion<T>> {
+	using Value = T;
+	static constexpr std::size_t Count = 4;
+};
+
 template<typename T>
 const Quaternion<T> Quaternion<T>::Zero = Quaternion<T>(0);
 template<typename T>
@@ -378,4 +417,5 @@ const Quaternion<T> Quaternion<T>::Infinity = Quaternion<T>(std::numeric_limits<
 
 using Quaternionf = Quaternion<float>;
 using Quaterniond = Quaternion<double>;
+using Quaternionh = Quaternion<Half>;
 }
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <limits>
+
+#include "Vector.hpp"
+
+namespace MathsCPP {
+/**
+ * @brief Holds a ray with the range of distances along it that count as hits.
+ * @tparam T The value type.
+ */
+template<typename T>
+class Ray {
+public:
+	constexpr Ray() = default;
+	constexpr Ray(const Vector<T, 3> &origin, const Vector<T, 3> &direction, T tMin = 0, T tMax = std::numeric_limits<T>::infinity()) :
+		origin(origin), direction(direction), tMin(tMin), tMax(tMax) {}
+
+	/**
+	 * Gets the point at a distance along this ray, measured in lengths of the direction.
+	 * @param t The distance.
+	 * @return The point.
+	 */
+	constexpr Vector<T, 3> GetPoint(T t) const { return origin + direction * t; }
+
+	friend std::ostream &operator<<(std::ostream &stream, const Ray &ray) {
+		return stream << ray.origin << " -> " << ray.direction << " [" << ray.tMin << ", " << ray.tMax << "]";
+	}
+
+	Vector<T, 3> origin;
+	Vector<T, 3> direction;
+	T tMin = 0;
+	T tMax = std::numeric_limits<T>::infinity();
+};
+
+/**
+ * @brief Holds a group of rays with each component in its own array, so one operation can run across every ray at once.
+ * Rays that start near each other and point the same way traverse the same nodes, which is what makes packets pay off.
+ * @tparam T The value type.
+ * @tparam K Number of rays, usually the SIMD width.
+ */
+template<typename T, std::size_t K>
+class RayPacket {
+public:
+	constexpr RayPacket() = default;
+
+	/**
+	 * Sets one ray in this packet.
+	 * @param lane The lane to set.
+	 * @param ray The ray.
+	 */
+	constexpr void Set(std::size_t lane, const Ray<T> &ray) {
+		for (std::size_t i = 0; i < 3; i++) {
+			origin[i][lane] = ray.origin[i];
+			direction[i][lane] = ray.direction[i];
+		}
+		tMin[lane] = ray.tMin;
+		tMax[lane] = ray.tMax;
+	}
+
+	/**
+	 * Gets one ray in this packet.
+	 * @param lane The lane to get.
+	 * @return The ray.
+	 */
+	constexpr Ray<T> Get(std::size_t lane) const {
+		return {{origin[0][lane], origin[1][lane], origin[2][lane]}, {direction[0][lane], direction[1][lane], direction[2][lane]}, tMin[lane], tMax[lane]};
+	}
+
+	constexpr auto size() const { return K; }
+
+	T origin[3][K]{};
+	T direction[3][K]{};
+	T tMin[K]{};
+	/// Unused lanes are left with tMax below tMin so they never hit.
+	T tMax[K]{};
+};
+
+using Rayf = Ray<float>;
+using Rayd = Ray<double>;
+
+using RayPacket4f = RayPacket<float, 4>;
+using RayPacket8f = RayPacket<float, 8>;
+}
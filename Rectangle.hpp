@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "Vector.hpp"
 
 namespace MathsCPP {
@@ -49,11 +51,71 @@ public:
 		return lhs = lhs * rhs;
 	}
 
+	/**
+	 * Gets if this rectangle overlaps another rectangle, rectangles that only share an edge do not overlap.
+	 * @param other The other rectangle.
+	 * @return If the rectangles overlap.
+	 */
+	template<typename T1>
+	constexpr bool Intersects(const Rectangle<T1> &other) const {
+		return (x < other.x + other.w) & (other.x < x + w) & (y < other.y + other.h) & (other.y < y + h);
+	}
+
+	/**
+	 * Gets if a point is inside this rectangle, the right and bottom edges are exclusive.
+	 * @param point The point.
+	 * @return If the point is inside.
+	 */
+	template<typename T1>
+	constexpr bool Contains(const Vector<T1, 2> &point) const {
+		return (x <= point.x) & (point.x < x + w) & (y <= point.y) & (point.y < y + h);
+	}
+
+	/**
+	 * Gets if another rectangle is fully inside this rectangle, edges may touch.
+	 * @param other The other rectangle.
+	 * @return If the other rectangle is inside.
+	 */
+	template<typename T1>
+	constexpr bool Contains(const Rectangle<T1> &other) const {
+		return (x <= other.x) & (other.x + other.w <= x + w) & (y <= other.y) & (other.y + other.h <= y + h);
+	}
+
+	/**
+	 * Gets the overlapping area of this rectangle and another rectangle.
+	 * @param other The other rectangle.
+	 * @return The overlap, this has a zero width or height when the rectangles do not intersect.
+	 */
+	template<typename T1>
+	constexpr auto Intersection(const Rectangle<T1> &other) const {
+		using THighestP = decltype(x + other.x);
+		auto x0 = std::max<THighestP>(x, other.x);
+		auto y0 = std::max<THighestP>(y, other.y);
+		auto x1 = std::min<THighestP>(x + w, other.x + other.w);
+		auto y1 = std::min<THighestP>(y + h, other.y + other.h);
+		return Rectangle<THighestP>(x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0);
+	}
+
+	/**
+	 * Gets the smallest rectangle that contains this rectangle and another rectangle.
+	 * @param other The other rectangle.
+	 * @return The bounding rectangle.
+	 */
+	template<typename T1>
+	constexpr auto Union(const Rectangle<T1> &other) const {
+		using THighestP = decltype(x + other.x);
+		auto x0 = std::min<THighestP>(x, other.x);
+		auto y0 = std::min<THighestP>(y, other.y);
+		auto x1 = std::max<THighestP>(x + w, other.x + other.w);
+		auto y1 = std::max<THighestP>(y + h, other.y + other.h);
+		return Rectangle<THighestP>(x0, y0, x1 - x0, y1 - y0);
+	}
+
 	constexpr const Vector<T, 2> &xy() const { return *reinterpret_cast<const Vector<T, 2> *>(this); }
 	constexpr Vector<T, 2> &xy() { return *reinterpret_cast<Vector<T, 2> *>(this); }
 
-	constexpr const Vector<T, 2> &wh() const { return *reinterpret_cast<const Vector<T, 2> *>(this + (2 * sizeof(T))); }
-	constexpr Vector<T, 2> &wh() { return *reinterpret_cast<Vector<T, 2> *>(this + (2 * sizeof(T))); }
+	constexpr const Vector<T, 2> &wh() const { return *reinterpret_cast<const Vector<T, 2> *>(&w); }
+	constexpr Vector<T, 2> &wh() { return *reinterpret_cast<Vector<T, 2> *>(&w); }
 
 	T x{}, y{};
 	T w{}, h{};
@@ -63,16 +125,187 @@ using Rectanglef = Rectangle<float>;
 using Rectangled = Rectangle<double>;
 using Rectanglei = Rectangle<int32_t>;
 using Rectangleui = Rectangle<uint32_t>;
+
+/**
+ * @brief Holds rectangles in a structure of arrays layout so one rectangle can be tested against many at once.
+ * Batch tests either write one bit per rectangle into a mask of GetMaskSize() words, or append the indices of passing rectangles.
+ * @tparam T The value type.
+ */
+template<typename T>
+class RectangleArray {
+public:
+	RectangleArray() = default;
+	explicit RectangleArray(Span<const Rectangle<T>> rects) {
+		Reserve(rects.size());
+		for (const auto &rect : rects)
+			Add(rect);
+	}
+
+	void Add(const Rectangle<T> &rect) {
+		x.emplace_back(rect.x);
+		y.emplace_back(rect.y);
+		w.emplace_back(rect.w);
+		h.emplace_back(rect.h);
+	}
+
+	void Set(std::size_t i, const Rectangle<T> &rect) {
+		x[i] = rect.x, y[i] = rect.y, w[i] = rect.w, h[i] = rect.h;
+	}
+
+	Rectangle<T> Get(std::size_t i) const { return {x[i], y[i], w[i], h[i]}; }
+
+	void Reserve(std::size_t size) {
+		x.reserve(size), y.reserve(size), w.reserve(size), h.reserve(size);
+	}
+
+	void Clear() {
+		x.clear(), y.clear(), w.clear(), h.clear();
+	}
+
+	std::size_t size() const { return x.size(); }
+	std::size_t GetMaskSize() const { return (size() + 63) / 64; }
+
+	/**
+	 * Tests which rectangles overlap a rectangle.
+	 * @param rect The rectangle.
+	 * @param mask The output mask, bit i is set when rectangle i overlaps.
+	 */
+	void Intersects(const Rectangle<T> &rect, Span<uint64_t> mask) const {
+		Mask(mask, IntersectsTest(rect));
+	}
+
+	/**
+	 * Finds the rectangles that overlap a rectangle.
+	 * @param rect The rectangle.
+	 * @param indices The indices of overlapping rectangles are appended to this.
+	 * @return The number of indices appended.
+	 */
+	std::size_t Intersects(const Rectangle<T> &rect, std::vector<uint32_t> &indices) const {
+		return Compact(indices, IntersectsTest(rect));
+	}
+
+	/**
+	 * Tests which rectangles contain a point.
+	 * @param point The point.
+	 * @param mask The output mask, bit i is set when rectangle i contains the point.
+	 */
+	void Contains(const Vector<T, 2> &point, Span<uint64_t> mask) const {
+		Mask(mask, ContainsTest(point));
+	}
+
+	/**
+	 * Finds the rectangles that contain a point.
+	 * @param point The point.
+	 * @param indices The indices of containing rectangles are appended to this.
+	 * @return The number of indices appended.
+	 */
+	std::size_t Contains(const Vector<T, 2> &point, std::vector<uint32_t> &indices) const {
+		return Compact(indices, ContainsTest(point));
+	}
+
+	/**
+	 * Tests which rectangles fully contain a rectangle.
+	 * @param rect The rectangle.
+	 * @param mask The output mask, bit i is set when rectangle i contains the rectangle.
+	 */
+	void Contains(const Rectangle<T> &rect, Span<uint64_t> mask) const {
+		Mask(mask, ContainsTest(rect));
+	}
+
+	/**
+	 * Finds the rectangles that fully contain a rectangle.
+	 * @param rect The rectangle.
+	 * @param indices The indices of containing rectangles are appended to this.
+	 * @return The number of indices appended.
+	 */
+	std::size_t Contains(const Rectangle<T> &rect, std::vector<uint32_t> &indices) const {
+		return Compact(indices, ContainsTest(rect));
+	}
+
+	/**
+	 * Gets the union of every rectangle.
+	 * @return The bounding rectangle, or an empty rectangle if there are none.
+	 */
+	Rectangle<T> Union() const {
+		if (size() == 0)
+			return {};
+		T x0 = x[0], y0 = y[0], x1 = x[0] + w[0], y1 = y[0] + h[0];
+		for (std::size_t i = 1; i < size(); i++) {
+			x0 = std::min(x0, x[i]);
+			y0 = std::min(y0, y[i]);
+			x1 = std::max<T>(x1, x[i] + w[i]);
+			y1 = std::max<T>(y1, y[i] + h[i]);
+		}
+		return {x0, y0, x1 - x0, y1 - y0};
+	}
+
+	std::vector<T> x, y;
+	std::vector<T> w, h;
+
+private:
+	// The tests copy the array pointers so the compiler can vectorize the loops in Mask and Compact.
+	auto IntersectsTest(const Rectangle<T> &rect) const {
+		return [px = x.data(), py = y.data(), pw = w.data(), ph = h.data(), x0 = rect.x, y0 = rect.y, x1 = rect.x + rect.w, y1 = rect.y + rect.h](std::size_t i) {
+			return static_cast<uint8_t>((px[i] < x1) & (x0 < px[i] + pw[i]) & (py[i] < y1) & (y0 < py[i] + ph[i]));
+		};
+	}
+
+	auto ContainsTest(const Vector<T, 2> &point) const {
+		return [px = x.data(), py = y.data(), pw = w.data(), ph = h.data(), x0 = point.x, y0 = point.y](std::size_t i) {
+			return static_cast<uint8_t>((px[i] <= x0) & (x0 < px[i] + pw[i]) & (py[i] <= y0) & (y0 < py[i] + ph[i]));
+		};
+	}
+
+	auto ContainsTest(const Rectangle<T> &rect) const {
+		return [px = x.data(), py = y.data(), pw = w.data(), ph = h.data(), x0 = rect.x, y0 = rect.y, x1 = rect.x + rect.w, y1 = rect.y + rect.h](std::size_t i) {
+			return static_cast<uint8_t>((px[i] <= x0) & (x1 <= px[i] + pw[i]) & (py[i] <= y0) & (y1 <= py[i] + ph[i]));
+		};
+	}
+
+	/**
+	 * Runs a test over a block of rectangles into bytes, whole blocks have a constant trip count so the loop vectorizes
+	 * even once inlined into a large caller.
+	 */
+	template<typename Test>
+	static uint64_t TestBlock(Test &test, std::size_t i, std::size_t n) {
+		uint8_t bytes[64];
+		if (n == 64) {
+			for (std::size_t j = 0; j < 64; j++)
+				bytes[j] = test(i + j);
+			return Maths::PackMask(bytes, 64);
+		}
+		for (std::size_t j = 0; j < n; j++)
+			bytes[j] = test(i + j);
+		return Maths::PackMask(bytes, n);
+	}
+
+	template<typename Test>
+	void Mask(Span<uint64_t> mask, Test &&test) const {
+		for (std::size_t i = 0; i < size(); i += 64)
+			mask[i / 64] = TestBlock(test, i, std::min<std::size_t>(size() - i, 64));
+	}
+
+	template<typename Test>
+	std::size_t Compact(std::vector<uint32_t> &indices, Test &&test) const {
+		auto start = indices.size();
+		for (std::size_t i = 0; i < size(); i += 64) {
+			for (auto mask = TestBlock(test, i, std::min<std::size_t>(size() - i, 64)); mask != 0; mask &= mask - 1)
+				indices.emplace_back(static_cast<uint32_t>(i + Maths::CountTrailingZeros(mask)));
+		}
+		return indices.size() - start;
+	}
+};
+
+using RectangleArrayf = RectangleArray<float>;
+using RectangleArrayd = RectangleArray<double>;
+using RectangleArrayi = RectangleArray<int32_t>;
 }
 
 namespace std {
 template<typename T>
 struct hash<MathsCPP::Rectangle<T>> {
 	size_t operator()(const MathsCPP::Rectangle<T> &rectangle) const noexcept {
-		size_t seed = 0;
-		MathsCPP::Maths::HashCombine(seed, rectangle.xy());
-		MathsCPP::Maths::HashCombine(seed, rectangle.wh());
-		return seed;
+		return static_cast<size_t>(MathsCPP::Maths::HashValues<T, 4>(&rectangle.x));
 	}
 };
 }
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+#include "Rectangle.hpp"
+
+namespace MathsCPP {
+/**
+ * @brief Packs rectangles into one or more fixed size pages using a bottom-left skyline, for building texture atlases.
+ * Each page keeps the top edge of its packed area as a list of horizontal segments, a rectangle is placed where it leaves its
+ * top lowest, ties going to the narrowest segment it starts on and then to the leftmost position.
+ */
+class RectanglePacker {
+public:
+	struct Placement {
+		/// The placed rectangle, without padding.
+		Rectanglei rect;
+		uint32_t page = 0;
+		/// If the rectangle was rotated by 90 degrees to fit, the rect size is then swapped from the requested size.
+		bool rotated = false;
+	};
+
+	/**
+	 * Creates a new packer.
+	 * @param pageSize The size of each page.
+	 * @param padding The space kept to the right and below every rectangle, padding that would fall past the page edge is dropped.
+	 * @param allowRotation If rectangles may be rotated by 90 degrees when that fits better.
+	 * @param maxPages The most pages that will be opened.
+	 */
+	explicit RectanglePacker(const Vector2i &pageSize, int32_t padding = 0, bool allowRotation = false, uint32_t maxPages = 1) :
+		pageSize(pageSize),
+		padding(padding),
+		allowRotation(allowRotation),
+		maxPages(maxPages) {
+	}
+
+	/**
+	 * Places a single rectangle, earlier placements are never moved.
+	 * @param size The rectangle size.
+	 * @return The placement, or nothing if the rectangle is empty or does not fit in any page.
+	 */
+	std::optional<Placement> Insert(const Vector2i &size) {
+		if (size.x <= 0 || size.y <= 0)
+			return std::nullopt;
+		auto w = size.x + padding, h = size.y + padding;
+
+		for (uint32_t page = 0; page < maxPages; page++) {
+			if (page == pages.size())
+				pages.emplace_back(pageSize.x);
+			auto &skyline = pages[page];
+			// Skip pages with no room left for this height, or that already rejected a rectangle no larger than this one.
+			if (skyline.minY + std::min(size.y, allowRotation ? size.x : size.y) > pageSize.y || skyline.Rejects(w, h, allowRotation))
+				continue;
+
+			auto fit = Find(skyline, w, h);
+			auto rotated = false;
+			if (allowRotation && w != h) {
+				auto fitRotated = Find(skyline, h, w);
+				if (fitRotated.Better(fit)) {
+					fit = fitRotated;
+					rotated = true;
+				}
+			}
+			if (fit.index == Invalid) {
+				skyline.rejected = {w, h};
+				continue;
+			}
+
+			auto placed = rotated ? Vector2i(h, w) : Vector2i(w, h);
+			Place(skyline, fit, Vector2i(std::min(placed.x, pageSize.x - fit.x), placed.y));
+			usedArea += static_cast<uint64_t>(size.x) * static_cast<uint64_t>(size.y);
+			return Placement{Rectanglei(fit.x, fit.y, placed.x - padding, placed.y - padding), page, rotated};
+		}
+		return std::nullopt;
+	}
+
+	/**
+	 * Places many rectangles, they are inserted tallest first which packs tighter than the given order.
+	 * With rotation rectangles tend to be laid flat, so they are ordered by their shorter side instead.
+	 * @param sizes The rectangle sizes.
+	 * @return The placements in the same order as sizes, with nothing for rectangles that are empty or did not fit.
+	 */
+	std::vector<std::optional<Placement>> Insert(Span<const Vector2i> sizes) {
+		std::vector<uint32_t> order(sizes.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+			auto ka = allowRotation ? std::min(sizes[a].x, sizes[a].y) : sizes[a].y;
+			auto kb = allowRotation ? std::min(sizes[b].x, sizes[b].y) : sizes[b].y;
+			return ka != kb ? ka > kb : std::max(sizes[a].x, sizes[a].y) > std::max(sizes[b].x, sizes[b].y);
+		});
+
+		std::vector<std::optional<Placement>> result(sizes.size());
+		for (auto i : order)
+			result[i] = Insert(sizes[i]);
+		return result;
+	}
+
+	/**
+	 * Removes every placement and page.
+	 */
+	void Clear() {
+		pages.clear();
+		usedArea = 0;
+	}
+
+	/**
+	 * Gets the fraction of the opened pages covered by rectangles, not counting padding.
+	 * @return The occupancy in the range [0, 1].
+	 */
+	float GetOccupancy() const {
+		if (pages.empty())
+			return 0.0f;
+		return static_cast<float>(static_cast<double>(usedArea) / (static_cast<double>(pageSize.x) * static_cast<double>(pageSize.y) * pages.size()));
+	}
+
+	std::size_t GetPageCount() const { return pages.size(); }
+	const Vector2i &GetPageSize() const { return pageSize; }
+
+private:
+	static constexpr uint32_t Invalid = ~uint32_t(0);
+
+	struct Segment {
+		int32_t x, y, w;
+	};
+
+	struct Skyline {
+		explicit Skyline(int32_t width) : segments{{0, 0, width}} {}
+
+		bool Rejects(int32_t w, int32_t h, bool rotate) const {
+			return (w >= rejected.x && h >= rejected.y) || (rotate && h >= rejected.x && w >= rejected.y);
+		}
+
+		std::vector<Segment> segments;
+		/// The last size that did not fit, the skyline only grows so anything at least this large will not fit either.
+		Vector2i rejected = Vector2i(std::numeric_limits<int32_t>::max());
+		/// The lowest segment, pages are skipped when even this cannot fit a rectangle.
+		int32_t minY = 0;
+	};
+
+	struct Fit {
+		uint32_t index = Invalid;
+		int32_t x = 0, y = 0;
+		int32_t top = std::numeric_limits<int32_t>::max();
+		int32_t segmentWidth = std::numeric_limits<int32_t>::max();
+
+		bool Better(const Fit &other) const {
+			if (top != other.top)
+				return top < other.top;
+			return segmentWidth < other.segmentWidth;
+		}
+	};
+
+	Fit Find(const Skyline &skyline, int32_t w, int32_t h) const {
+		Fit best;
+		const auto &segments = skyline.segments;
+		for (uint32_t i = 0; i < segments.size(); i++) {
+			// Padding may hang past the right and bottom edges of the page.
+			auto x = segments[i].x;
+			if (x + w - padding > pageSize.x)
+				break;
+
+			// The rectangle rests on the highest segment it spans.
+			auto y = segments[i].y;
+			auto covered = 0, span = std::min(w, pageSize.x - x);
+			for (auto j = i; covered < span; j++) {
+				y = std::max(y, segments[j].y);
+				covered += segments[j].w;
+			}
+			if (y + h - padding > pageSize.y)
+				continue;
+
+			Fit fit{i, x, y, y + h, segments[i].w};
+			if (fit.Better(best))
+				best = fit;
+		}
+		return best;
+	}
+
+	static void Place(Skyline &skyline, const Fit &fit, const Vector2i &size) {
+		auto &segments = skyline.segments;
+		segments.insert(segments.begin() + fit.index, Segment{fit.x, fit.y + size.y, size.x});
+
+		// Trim or remove the segments now underneath the new one.
+		auto right = fit.x + size.x;
+		auto i = fit.index + 1;
+		while (i < segments.size() && segments[i].x < right) {
+			auto shrink = right - segments[i].x;
+			if (shrink < segments[i].w) {
+				segments[i].x += shrink;
+				segments[i].w -= shrink;
+				break;
+			}
+			segments.erase(segments.begin() + i);
+		}
+
+		// Merge neighbours at the same height.
+		for (auto j = fit.index > 0 ? fit.index - 1 : 0; j + 1 < segments.size() && j <= fit.index + 1;) {
+			if (segments[j].y == segments[j + 1].y) {
+				segments[j].w += segments[j + 1].w;
+				segments.erase(segments.begin() + j + 1);
+			} else {
+				j++;
+			}
+		}
+
+		skyline.minY = segments[0].y;
+		for (const auto &segment : segments)
+			skyline.minY = std::min(skyline.minY, segment.y);
+	}
+
+	Vector2i pageSize;
+	int32_t padding;
+	bool allowRotation;
+	uint32_t maxPages;
+
+	std::vector<Skyline> pages;
+	uint64_t usedArea = 0;
+};
+}
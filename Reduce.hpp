@@ -0,0 +1,242 @@
+#pragma once
+
+#include "AABB.hpp"
+#include "Matrix.hpp"
+
+namespace MathsCPP {
+/// How Reduce sums floating point values, both give the same bits for any thread count.
+enum class Summation {
+	/// Plain sums in several lanes per chunk, with lanes and chunks then combined pairwise.
+	Pairwise,
+	/// Kahan compensated sums in every lane, with lanes and chunks combined by exact two-sums, about twice the cost.
+	Kahan
+};
+
+/**
+ * @brief Reductions over many vectors, spread over independent lanes within a chunk so they vectorize, with chunks run across threads.
+ * Chunks have a fixed size and are combined in a fixed tree, so results are the same bits on any number of threads.
+ */
+class Reduce {
+public:
+	Reduce() = delete;
+
+	/**
+	 * Sums vectors.
+	 * @param vectors The vectors.
+	 * @param summation How floating point values are summed.
+	 * @return The sum, zero when there are no vectors.
+	 */
+	template<typename T, std::size_t N>
+	static Vector<T, N> Sum(Span<const Vector<T, N>> vectors, Summation summation = Summation::Pairwise) {
+		return SumEach<N, T>(vectors.size(), summation, [&](std::size_t i, T (&values)[N]) {
+			for (std::size_t j = 0; j < N; j++)
+				values[j] = vectors[i][j];
+		});
+	}
+
+	/**
+	 * Averages vectors, the centroid of points.
+	 * @param vectors The vectors.
+	 * @param summation How floating point values are summed.
+	 * @return The mean, zero when there are no vectors.
+	 */
+	template<typename T, std::size_t N>
+	static Vector<T, N> Mean(Span<const Vector<T, N>> vectors, Summation summation = Summation::Pairwise) {
+		if (vectors.empty())
+			return {};
+		return Sum(vectors, summation) / static_cast<T>(vectors.size());
+	}
+
+	/**
+	 * Finds the smallest value of each component, as Bounds(vectors).min.
+	 * @param vectors The vectors.
+	 * @return The smallest components, the largest value of T when there are no vectors.
+	 */
+	template<typename T, std::size_t N>
+	static Vector<T, N> ComponentMin(Span<const Vector<T, N>> vectors) {
+		return Bounds(vectors).min;
+	}
+
+	/**
+	 * Finds the largest value of each component, as Bounds(vectors).max.
+	 * @param vectors The vectors.
+	 * @return The largest components, the lowest value of T when there are no vectors.
+	 */
+	template<typename T, std::size_t N>
+	static Vector<T, N> ComponentMax(Span<const Vector<T, N>> vectors) {
+		return Bounds(vectors).max;
+	}
+
+	/**
+	 * Finds the box around points, minimums and maximums are found together in one pass.
+	 * @param vectors The points.
+	 * @return The bounds, AABB::Empty when there are no points.
+	 */
+	template<typename T, std::size_t N>
+	static AABB<T, N> Bounds(Span<const Vector<T, N>> vectors) {
+		return Parallel::Reduce(0, vectors.size(), Grain, AABB<T, N>::Empty, [&](std::size_t begin, std::size_t end) {
+			T mins[N][Lanes], maxs[N][Lanes];
+			for (std::size_t j = 0; j < N; j++) {
+				for (std::size_t l = 0; l < Lanes; l++) {
+					mins[j][l] = std::numeric_limits<T>::max();
+					maxs[j][l] = std::numeric_limits<T>::lowest();
+				}
+			}
+			auto i = begin;
+			for (; i + Lanes <= end; i += Lanes) {
+				for (std::size_t l = 0; l < Lanes; l++) {
+					for (std::size_t j = 0; j < N; j++) {
+						auto value = vectors[i + l][j];
+						// Written as comparisons rather than std::min and std::max so they become packed min and max.
+						mins[j][l] = value < mins[j][l] ? value : mins[j][l];
+						maxs[j][l] = value > maxs[j][l] ? value : maxs[j][l];
+					}
+				}
+			}
+			for (std::size_t l = 0; i + l < end; l++) {
+				for (std::size_t j = 0; j < N; j++) {
+					auto value = vectors[i + l][j];
+					mins[j][l] = value < mins[j][l] ? value : mins[j][l];
+					maxs[j][l] = value > maxs[j][l] ? value : maxs[j][l];
+				}
+			}
+			AABB<T, N> result = AABB<T, N>::Empty;
+			for (std::size_t j = 0; j < N; j++) {
+				for (std::size_t l = 0; l < Lanes; l++) {
+					result.min[j] = std::min(result.min[j], mins[j][l]);
+					result.max[j] = std::max(result.max[j], maxs[j][l]);
+				}
+			}
+			return result;
+		}, [](const AABB<T, N> &lhs, const AABB<T, N> &rhs) {
+			AABB<T, N> result;
+			for (std::size_t j = 0; j < N; j++) {
+				result.min[j] = std::min(lhs.min[j], rhs.min[j]);
+				result.max[j] = std::max(lhs.max[j], rhs.max[j]);
+			}
+			return result;
+		});
+	}
+
+	/**
+	 * Finds the covariance of points about their mean, in two passes so large offsets from the origin do not cancel.
+	 * @param vectors The points.
+	 * @param summation How floating point values are summed.
+	 * @return The covariance divided by the point count, zero when there are no points.
+	 */
+	template<typename T, std::size_t N>
+	static Matrix<T, N, N> Covariance(Span<const Vector<T, N>> vectors, Summation summation = Summation::Pairwise) {
+		static_assert(std::is_floating_point_v<T>, "Covariance needs a floating point type");
+		Matrix<T, N, N> result;
+		if (vectors.empty())
+			return result;
+		// Only the lower triangle is summed, as a flat list of products.
+		constexpr std::size_t Products = N * (N + 1) / 2;
+		auto mean = Mean(vectors, summation);
+		auto sum = SumEach<Products, T>(vectors.size(), summation, [&](std::size_t i, T (&values)[Products]) {
+			T offset[N];
+			for (std::size_t j = 0; j < N; j++)
+				offset[j] = vectors[i][j] - mean[j];
+			for (std::size_t j = 0, p = 0; j < N; j++) {
+				for (std::size_t k = 0; k <= j; k++, p++)
+					values[p] = offset[j] * offset[k];
+			}
+		});
+		auto scale = 1 / static_cast<T>(vectors.size());
+		for (std::size_t j = 0, p = 0; j < N; j++) {
+			for (std::size_t k = 0; k <= j; k++, p++)
+				result[j][k] = result[k][j] = sum[p] * scale;
+		}
+		return result;
+	}
+
+private:
+	/// Vectors per chunk, fixed so chunks and the order they are combined in never depend on the thread count.
+	static constexpr std::size_t Grain = 1 << 12;
+	/// Independent sums per component within a chunk, so consecutive vectors go to different registers.
+	static constexpr std::size_t Lanes = 8;
+
+	/// A sum and the error it lost, the exact total being sum - compensation.
+	template<typename T, std::size_t K>
+	struct Partial {
+		Vector<T, K> sum;
+		Vector<T, K> compensation;
+	};
+
+	template<bool Compensated, typename T>
+	MATHSCPP_INLINE static void Add(T &sum, T &compensation, T value) {
+		if constexpr (Compensated) {
+			auto y = value - compensation;
+			auto t = sum + y;
+			compensation = (t - sum) - y;
+			sum = t;
+		} else {
+			sum += value;
+		}
+	}
+
+	template<bool Compensated, typename T>
+	MATHSCPP_INLINE static void Combine(T &sum, T &compensation, T otherSum, T otherCompensation) {
+		if constexpr (Compensated) {
+			// A two-sum, the rounding error of adding the sums is carried into the compensation exactly.
+			auto t = sum + otherSum;
+			auto b = t - sum;
+			auto error = (sum - (t - b)) + (otherSum - b);
+			compensation = compensation + otherCompensation - error;
+			sum = t;
+		} else {
+			sum += otherSum;
+		}
+	}
+
+	/**
+	 * Sums K values made for each of count elements by func(i, values).
+	 */
+	template<std::size_t K, typename T, typename Func>
+	static Vector<T, K> SumEach(std::size_t count, Summation summation, Func &&func) {
+		if constexpr (std::is_floating_point_v<T>) {
+			if (summation == Summation::Kahan) {
+				auto total = SumChunks<true, K, T>(count, func);
+				return total.sum - total.compensation;
+			}
+		}
+		return SumChunks<false, K, T>(count, func).sum;
+	}
+
+	template<bool Compensated, std::size_t K, typename T, typename Func>
+	static Partial<T, K> SumChunks(std::size_t count, Func &func) {
+		return Parallel::Reduce(0, count, Grain, Partial<T, K>(), [&](std::size_t begin, std::size_t end) {
+			T sums[K][Lanes]{}, compensations[K][Lanes]{}, values[K];
+			auto i = begin;
+			for (; i + Lanes <= end; i += Lanes) {
+				for (std::size_t l = 0; l < Lanes; l++) {
+					func(i + l, values);
+					for (std::size_t k = 0; k < K; k++)
+						Add<Compensated>(sums[k][l], compensations[k][l], values[k]);
+				}
+			}
+			for (std::size_t l = 0; i + l < end; l++) {
+				func(i + l, values);
+				for (std::size_t k = 0; k < K; k++)
+					Add<Compensated>(sums[k][l], compensations[k][l], values[k]);
+			}
+			for (std::size_t width = 1; width < Lanes; width *= 2) {
+				for (std::size_t l = 0; l + width < Lanes; l += 2 * width) {
+					for (std::size_t k = 0; k < K; k++)
+						Combine<Compensated>(sums[k][l], compensations[k][l], sums[k][l + width], compensations[k][l + width]);
+				}
+			}
+			Partial<T, K> result;
+			for (std::size_t k = 0; k < K; k++) {
+				result.sum[k] = sums[k][0];
+				result.compensation[k] = compensations[k][0];
+			}
+			return result;
+		}, [](Partial<T, K> lhs, const Partial<T, K> &rhs) {
+			for (std::size_t k = 0; k < K; k++)
+				Combine<Compensated>(lhs.sum[k], lhs.compensation[k], rhs.sum[k], rhs.compensation[k]);
+			return lhs;
+		});
+	}
+};
+}
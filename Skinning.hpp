@@ -0,0 +1,355 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "DualQuaternion.hpp"
+#include "Maths.hpp"
+#include "Matrix.hpp"
+#include "Parallel.hpp"
+#include "Vector.hpp"
+
+namespace MathsCPP {
+/**
+ * @brief Holds vertex positions and normals in a structure of arrays layout, the streams skinning reads and writes.
+ * @tparam T The value type.
+ */
+template<typename T>
+class VertexStreams {
+public:
+	VertexStreams() = default;
+	explicit VertexStreams(std::size_t size) { Resize(size); }
+
+	void Add(const Vector<T, 3> &position, const Vector<T, 3> &normal) {
+		x.emplace_back(position.x), y.emplace_back(position.y), z.emplace_back(position.z);
+		nx.emplace_back(normal.x), ny.emplace_back(normal.y), nz.emplace_back(normal.z);
+	}
+
+	void Set(std::size_t i, const Vector<T, 3> &position, const Vector<T, 3> &normal) {
+		x[i] = position.x, y[i] = position.y, z[i] = position.z;
+		nx[i] = normal.x, ny[i] = normal.y, nz[i] = normal.z;
+	}
+
+	Vector<T, 3> GetPosition(std::size_t i) const { return {x[i], y[i], z[i]}; }
+	Vector<T, 3> GetNormal(std::size_t i) const { return {nx[i], ny[i], nz[i]}; }
+
+	void Resize(std::size_t size) {
+		x.resize(size), y.resize(size), z.resize(size);
+		nx.resize(size), ny.resize(size), nz.resize(size);
+	}
+
+	void Reserve(std::size_t size) {
+		x.reserve(size), y.reserve(size), z.reserve(size);
+		nx.reserve(size), ny.reserve(size), nz.reserve(size);
+	}
+
+	void Clear() {
+		x.clear(), y.clear(), z.clear();
+		nx.clear(), ny.clear(), nz.clear();
+	}
+
+	std::size_t size() const { return x.size(); }
+
+	std::vector<T> x, y, z;
+	std::vector<T> nx, ny, nz;
+};
+
+/**
+ * @brief Holds the bones that influence each vertex and their weights, one stream per influence slot.
+ * Vertices with fewer influences fill the spare slots with zero weights, weights of a vertex should sum to one.
+ * @tparam T The value type.
+ * @tparam Influences The influence slots per vertex, from 1 to 8.
+ */
+template<typename T, std::size_t Influences>
+class SkinWeights {
+	static_assert(Influences >= 1 && Influences <= 8, "Skinning supports 1 to 8 influences per vertex");
+public:
+	void Add(const std::array<uint16_t, Influences> &vertexBones, const std::array<T, Influences> &vertexWeights) {
+		for (std::size_t j = 0; j < Influences; j++) {
+			bones[j].emplace_back(vertexBones[j]);
+			weights[j].emplace_back(vertexWeights[j]);
+		}
+	}
+
+	void Reserve(std::size_t size) {
+		for (std::size_t j = 0; j < Influences; j++)
+			bones[j].reserve(size), weights[j].reserve(size);
+	}
+
+	void Clear() {
+		for (std::size_t j = 0; j < Influences; j++)
+			bones[j].clear(), weights[j].clear();
+	}
+
+	std::size_t size() const { return bones[0].size(); }
+
+	std::array<std::vector<uint16_t>, Influences> bones;
+	std::array<std::vector<T>, Influences> weights;
+};
+
+/**
+ * @brief Deforms vertex streams by a bone palette, with linear blend skinning of matrices or dual quaternion skinning.
+ * Vertices are processed in blocks, the blended transform of each vertex in a block is gathered from the palette into one
+ * array per component, with SSE2 for floats, so the transforming loops vectorize across vertices, and blocks are split across cores.
+ */
+class Skinning {
+public:
+	Skinning() = delete;
+
+	/**
+	 * Skins vertices by blending bone matrices, the result of each vertex is the weighted sum of its bone transforms.
+	 * Normals use the blended matrix and are renormalized, which is exact for bones without non-uniform scale.
+	 * @param bones The bone matrices, transforming column vectors as Matrix * Vector does, only the top three rows are read.
+	 * @param weights The influences of each vertex.
+	 * @param input The vertices in bind pose.
+	 * @param output The skinned vertices, resized to the input and may be the input.
+	 */
+	template<typename T, std::size_t Influences>
+	static void LinearBlend(Span<const Matrix<T, 4, 4>> bones, const SkinWeights<T, Influences> &weights, const VertexStreams<T> &input,
+		VertexStreams<T> &output) {
+		std::vector<T> palette(bones.size() * LinearStride);
+		for (std::size_t b = 0; b < bones.size(); b++) {
+			for (std::size_t j = 0; j < 3; j++) {
+				for (std::size_t i = 0; i < 4; i++)
+					palette[b * LinearStride + j * 4 + i] = bones[b][j][i];
+			}
+		}
+		output.Resize(input.size());
+		Parallel::For(0, input.size(), ParallelGrain, [&](std::size_t begin, std::size_t end) {
+			LinearBlendChunk(palette.data(), weights, input, output, begin, end);
+		});
+	}
+
+	/**
+	 * Skins vertices by blending bone dual quaternions, which keeps the volume that linear blending loses around twisting joints.
+	 * Each blend takes the shortest path from the influences blended before it, so antipodal bone rotations do not cancel.
+	 * @param bones The bone transforms, must be normalized.
+	 * @param weights The influences of each vertex.
+	 * @param input The vertices in bind pose.
+	 * @param output The skinned vertices, resized to the input and may be the input.
+	 */
+	template<typename T, std::size_t Influences>
+	static void DualQuaternionBlend(Span<const DualQuaternion<T>> bones, const SkinWeights<T, Influences> &weights, const VertexStreams<T> &input,
+		VertexStreams<T> &output) {
+		std::vector<T> palette(bones.size() * DualQuaternionStride);
+		for (std::size_t b = 0; b < bones.size(); b++)
+			std::copy(bones[b].begin(), bones[b].end(), palette.data() + b * DualQuaternionStride);
+		output.Resize(input.size());
+		Parallel::For(0, input.size(), ParallelGrain, [&](std::size_t begin, std::size_t end) {
+			DualQuaternionBlendChunk(palette.data(), weights, input, output, begin, end);
+		});
+	}
+
+private:
+	/// Vertices per chunk when skinning is split across cores.
+	static constexpr std::size_t ParallelGrain = 1 << 14;
+	/// Vertices whose blended transforms are held at once, small enough for the block arrays to stay in the L1 cache.
+	static constexpr std::size_t Block = 64;
+	/// Values per bone in the flattened palettes.
+	static constexpr std::size_t LinearStride = 12, DualQuaternionStride = 8;
+	/// Position and normal components per vertex.
+	static constexpr std::size_t Streams = 6;
+
+	/// One over the length of a vector, the smallest normal value is added rather than taken as a maximum so the loops stay branch free.
+	template<typename T>
+	MATHSCPP_INLINE static T InverseLength(T x, T y, T z, T w = 0) {
+		return Maths::Fast::Rsqrt<Maths::Precision::High>(x * x + y * y + z * z + w * w + std::numeric_limits<T>::min());
+	}
+
+	// Blocks are copied through local arrays, so the transform loops need no run time checks for the output overlapping the input.
+	template<typename T>
+	static void LoadBlock(const VertexStreams<T> &streams, std::size_t first, std::size_t n, T (&block)[Streams][Block]) {
+		const std::vector<T> *sources[Streams] = {&streams.x, &streams.y, &streams.z, &streams.nx, &streams.ny, &streams.nz};
+		for (std::size_t s = 0; s < Streams; s++)
+			std::copy_n(sources[s]->data() + first, n, block[s]);
+	}
+
+	template<typename T>
+	static void StoreBlock(const T (&block)[Streams][Block], std::size_t first, std::size_t n, VertexStreams<T> &streams) {
+		std::vector<T> *targets[Streams] = {&streams.x, &streams.y, &streams.z, &streams.nx, &streams.ny, &streams.nz};
+		for (std::size_t s = 0; s < Streams; s++)
+			std::copy_n(block[s], n, targets[s]->data() + first);
+	}
+
+	/**
+	 * Sums the weighted palette entries of each vertex in a block, entry k of vertex v goes to m[k][v].
+	 */
+	template<typename T, std::size_t Influences>
+	static void GatherLinear(const T *palette, const SkinWeights<T, Influences> &weights, std::size_t first, std::size_t n, T (&m)[LinearStride][Block]) {
+		std::size_t start = 0;
+#ifdef MATHSCPP_SSE2
+		if constexpr (std::is_same_v<T, float>)
+			start = PackedGatherLinear(palette, weights, first, n, m);
+#endif
+		for (std::size_t k = 0; k < LinearStride; k++)
+			std::fill(m[k] + start, m[k] + n, T(0));
+		for (std::size_t j = 0; j < Influences; j++) {
+			auto bones = weights.bones[j].data() + first;
+			auto w = weights.weights[j].data() + first;
+			for (auto v = start; v < n; v++) {
+				auto bone = palette + bones[v] * LinearStride;
+				for (std::size_t k = 0; k < LinearStride; k++)
+					m[k][v] += w[v] * bone[k];
+			}
+		}
+	}
+
+	template<typename T, std::size_t Influences>
+	static void GatherDualQuaternion(const T *palette, const SkinWeights<T, Influences> &weights, std::size_t first, std::size_t n,
+		T (&q)[DualQuaternionStride][Block]) {
+		std::size_t start = 0;
+#ifdef MATHSCPP_SSE2
+		if constexpr (std::is_same_v<T, float>)
+			start = PackedGatherDualQuaternion(palette, weights, first, n, q);
+#endif
+		for (std::size_t k = 0; k < DualQuaternionStride; k++)
+			std::fill(q[k] + start, q[k] + n, T(0));
+		for (std::size_t j = 0; j < Influences; j++) {
+			auto bones = weights.bones[j].data() + first;
+			auto w = weights.weights[j].data() + first;
+			for (auto v = start; v < n; v++) {
+				auto bone = palette + bones[v] * DualQuaternionStride;
+				// Flipping the weight by the sign of the dot product keeps the blend in one hemisphere.
+				auto dot = q[0][v] * bone[0] + q[1][v] * bone[1] + q[2][v] * bone[2] + q[3][v] * bone[3];
+				auto weight = std::copysign(w[v], dot);
+				for (std::size_t k = 0; k < DualQuaternionStride; k++)
+					q[k][v] += weight * bone[k];
+			}
+		}
+	}
+
+#ifdef MATHSCPP_SSE2
+	// The palette rows of a vertex are summed in registers, four vertices at a time, then transposed into the block.
+	template<std::size_t Influences>
+	static std::size_t PackedGatherLinear(const float *palette, const SkinWeights<float, Influences> &weights, std::size_t first, std::size_t n,
+		float (&m)[LinearStride][Block]) {
+		std::size_t v = 0;
+		for (; v < (n & ~std::size_t(3)); v += 4) {
+			__m128 rows[3][4];
+			for (std::size_t l = 0; l < 4; l++) {
+				auto r0 = _mm_setzero_ps(), r1 = _mm_setzero_ps(), r2 = _mm_setzero_ps();
+				for (std::size_t j = 0; j < Influences; j++) {
+					auto bone = palette + weights.bones[j][first + v + l] * LinearStride;
+					auto w = _mm_set1_ps(weights.weights[j][first + v + l]);
+					r0 = _mm_add_ps(r0, _mm_mul_ps(w, _mm_loadu_ps(bone)));
+					r1 = _mm_add_ps(r1, _mm_mul_ps(w, _mm_loadu_ps(bone + 4)));
+					r2 = _mm_add_ps(r2, _mm_mul_ps(w, _mm_loadu_ps(bone + 8)));
+				}
+				rows[0][l] = r0, rows[1][l] = r1, rows[2][l] = r2;
+			}
+			for (std::size_t r = 0; r < 3; r++)
+				StoreTransposed(rows[r], m, r * 4, v);
+		}
+		return v;
+	}
+
+	template<std::size_t Influences>
+	static std::size_t PackedGatherDualQuaternion(const float *palette, const SkinWeights<float, Influences> &weights, std::size_t first, std::size_t n,
+		float (&q)[DualQuaternionStride][Block]) {
+		auto signMask = _mm_set1_ps(-0.0f);
+		std::size_t v = 0;
+		for (; v < (n & ~std::size_t(3)); v += 4) {
+			__m128 rows[2][4];
+			for (std::size_t l = 0; l < 4; l++) {
+				auto real = _mm_setzero_ps(), dual = _mm_setzero_ps();
+				for (std::size_t j = 0; j < Influences; j++) {
+					auto bone = palette + weights.bones[j][first + v + l] * DualQuaternionStride;
+					auto boneReal = _mm_loadu_ps(bone);
+					// The dot product is summed into every lane and its sign moved onto the weight.
+					auto dot = _mm_mul_ps(real, boneReal);
+					dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(2, 3, 0, 1)));
+					dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(1, 0, 3, 2)));
+					auto w = _mm_xor_ps(_mm_set1_ps(weights.weights[j][first + v + l]), _mm_and_ps(dot, signMask));
+					real = _mm_add_ps(real, _mm_mul_ps(w, boneReal));
+					dual = _mm_add_ps(dual, _mm_mul_ps(w, _mm_loadu_ps(bone + 4)));
+				}
+				rows[0][l] = real, rows[1][l] = dual;
+			}
+			StoreTransposed(rows[0], q, 0, v);
+			StoreTransposed(rows[1], q, 4, v);
+		}
+		return v;
+	}
+
+	/// Writes four rows of four values as columns, lane k of row l goes to block[row + k][v + l].
+	template<std::size_t Rows>
+	MATHSCPP_INLINE static void StoreTransposed(__m128 (&rows)[4], float (&block)[Rows][Block], std::size_t row, std::size_t v) {
+		auto a = rows[0], b = rows[1], c = rows[2], d = rows[3];
+		_MM_TRANSPOSE4_PS(a, b, c, d);
+		_mm_storeu_ps(&block[row][v], a);
+		_mm_storeu_ps(&block[row + 1][v], b);
+		_mm_storeu_ps(&block[row + 2][v], c);
+		_mm_storeu_ps(&block[row + 3][v], d);
+	}
+#endif
+
+	template<typename T, std::size_t Influences>
+	static void LinearBlendChunk(const T *palette, const SkinWeights<T, Influences> &weights, const VertexStreams<T> &input,
+		VertexStreams<T> &output, std::size_t begin, std::size_t end) {
+		T m[LinearStride][Block], vertices[Streams][Block];
+		for (auto first = begin; first < end; first += Block) {
+			auto n = std::min(end - first, Block);
+			GatherLinear(palette, weights, first, n, m);
+
+			LoadBlock(input, first, n, vertices);
+			for (std::size_t v = 0; v < n; v++) {
+				auto x = vertices[0][v], y = vertices[1][v], z = vertices[2][v];
+				auto nx = vertices[3][v], ny = vertices[4][v], nz = vertices[5][v];
+				vertices[0][v] = m[0][v] * x + m[1][v] * y + m[2][v] * z + m[3][v];
+				vertices[1][v] = m[4][v] * x + m[5][v] * y + m[6][v] * z + m[7][v];
+				vertices[2][v] = m[8][v] * x + m[9][v] * y + m[10][v] * z + m[11][v];
+				auto sx = m[0][v] * nx + m[1][v] * ny + m[2][v] * nz;
+				auto sy = m[4][v] * nx + m[5][v] * ny + m[6][v] * nz;
+				auto sz = m[8][v] * nx + m[9][v] * ny + m[10][v] * nz;
+				auto scale = InverseLength(sx, sy, sz);
+				vertices[3][v] = sx * scale;
+				vertices[4][v] = sy * scale;
+				vertices[5][v] = sz * scale;
+			}
+			StoreBlock(vertices, first, n, output);
+		}
+	}
+
+	template<typename T, std::size_t Influences>
+	static void DualQuaternionBlendChunk(const T *palette, const SkinWeights<T, Influences> &weights, const VertexStreams<T> &input,
+		VertexStreams<T> &output, std::size_t begin, std::size_t end) {
+		T q[DualQuaternionStride][Block], vertices[Streams][Block];
+		for (auto first = begin; first < end; first += Block) {
+			auto n = std::min(end - first, Block);
+			GatherDualQuaternion(palette, weights, first, n, q);
+
+			LoadBlock(input, first, n, vertices);
+			for (std::size_t v = 0; v < n; v++) {
+				auto scale = InverseLength(q[0][v], q[1][v], q[2][v], q[3][v]);
+				auto rx = q[0][v] * scale, ry = q[1][v] * scale, rz = q[2][v] * scale, rw = q[3][v] * scale;
+				auto dx = q[4][v] * scale, dy = q[5][v] * scale, dz = q[6][v] * scale, dw = q[7][v] * scale;
+				// The translation is twice the vector part of dual * conjugate(real).
+				auto tx = 2 * (rw * dx - dw * rx + ry * dz - rz * dy);
+				auto ty = 2 * (rw * dy - dw * ry + rz * dx - rx * dz);
+				auto tz = 2 * (rw * dz - dw * rz + rx * dy - ry * dx);
+
+				auto x = vertices[0][v], y = vertices[1][v], z = vertices[2][v];
+				auto nx = vertices[3][v], ny = vertices[4][v], nz = vertices[5][v];
+				// Rotates as v + 2 r x (r x v + w v), the same as Quaternion * Vector.
+				auto cx = ry * z - rz * y + rw * x, cy = rz * x - rx * z + rw * y, cz = rx * y - ry * x + rw * z;
+				vertices[0][v] = x + 2 * (ry * cz - rz * cy) + tx;
+				vertices[1][v] = y + 2 * (rz * cx - rx * cz) + ty;
+				vertices[2][v] = z + 2 * (rx * cy - ry * cx) + tz;
+				cx = ry * nz - rz * ny + rw * nx, cy = rz * nx - rx * nz + rw * ny, cz = rx * ny - ry * nx + rw * nz;
+				vertices[3][v] = nx + 2 * (ry * cz - rz * cy);
+				vertices[4][v] = ny + 2 * (rz * cx - rx * cz);
+				vertices[5][v] = nz + 2 * (rx * cy - ry * cx);
+			}
+			StoreBlock(vertices, first, n, output);
+		}
+	}
+};
+
+using VertexStreamsf = VertexStreams<float>;
+using VertexStreamsd = VertexStreams<double>;
+}
@@ -0,0 +1,406 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "Matrix.hpp"
+
+namespace MathsCPP {
+namespace Detail {
+/// The type a sparse matrix with these entries multiplies, the entry type itself for scalars and a column for square blocks.
+template<typename Block>
+struct SparseOperand {
+	using Type = Block;
+};
+
+template<typename T, std::size_t N>
+struct SparseOperand<Matrix<T, N, N>> {
+	using Type = Vector<T, N>;
+};
+
+template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+constexpr T SparseDot(T lhs, T rhs) { return lhs * rhs; }
+
+template<typename T, std::size_t N>
+constexpr T SparseDot(const Vector<T, N> &lhs, const Vector<T, N> &rhs) { return lhs.Dot(rhs); }
+
+template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+constexpr T SparseTranspose(T value) { return value; }
+
+template<typename T, std::size_t N>
+constexpr Matrix<T, N, N> SparseTranspose(const Matrix<T, N, N> &value) { return value.Transpose(); }
+
+template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+constexpr T SparseInverse(T value) { return value != 0 ? 1 / value : T(0); }
+
+template<typename T, std::size_t N>
+constexpr Matrix<T, N, N> SparseInverse(const Matrix<T, N, N> &value) { return value.Inverse(); }
+}
+
+/**
+ * @brief A matrix with few nonzero entries, in compressed sparse row (CSR) storage, sized at runtime.
+ * Each row keeps its nonzero entries sorted by column, rows are found through an offset table.
+ * The compressed sparse column (CSC) storage of a matrix is the CSR storage of its transpose, see Transpose.
+ * @tparam T The value type.
+ * @tparam Block The type of each entry, T for scalar matrices or a square Matrix<T, B, B> for block sparse matrices.
+ */
+template<typename T, typename Block = T>
+class SparseMatrix {
+public:
+	/// The type multiplied by this matrix, T for scalar matrices or Vector<T, B> for block sparse matrices.
+	using Operand = typename Detail::SparseOperand<Block>::Type;
+
+	/// A coordinate (COO) entry, in block rows and columns for block sparse matrices.
+	struct Triplet {
+		uint32_t row = 0;
+		uint32_t column = 0;
+		Block value{};
+	};
+
+	SparseMatrix() = default;
+	/**
+	 * Compresses coordinate entries, duplicate entries at the same row and column are summed. Rows are sorted concurrently.
+	 * @param rows The number of rows.
+	 * @param columns The number of columns.
+	 * @param triplets The entries in any order, each must be inside the matrix.
+	 */
+	SparseMatrix(std::size_t rows, std::size_t columns, Span<const Triplet> triplets) :
+		rowCount(rows),
+		columnCount(columns),
+		rowOffsets(rows + 1) {
+		// A counting sort by row, stable so duplicates are summed in the order they were given.
+		for (const auto &triplet : triplets)
+			rowOffsets[triplet.row + 1]++;
+		std::partial_sum(rowOffsets.begin(), rowOffsets.end(), rowOffsets.begin());
+		std::vector<std::pair<uint32_t, Block>> entries(triplets.size());
+		{
+			auto next = rowOffsets;
+			for (const auto &triplet : triplets)
+				entries[next[triplet.row]++] = {triplet.column, triplet.value};
+		}
+
+		std::vector<std::size_t> counts(rows + 1);
+		Parallel::For(0, rows, RowGrain, [&](std::size_t begin, std::size_t end) {
+			for (auto row = begin; row < end; row++) {
+				auto first = entries.begin() + rowOffsets[row], last = entries.begin() + rowOffsets[row + 1];
+				std::stable_sort(first, last, [](const auto &a, const auto &b) { return a.first < b.first; });
+				auto out = first;
+				for (auto it = first; it != last; ++it) {
+					if (out != first && (out - 1)->first == it->first)
+						(out - 1)->second = (out - 1)->second + it->second;
+					else
+						*out++ = *it;
+				}
+				counts[row + 1] = out - first;
+			}
+		});
+		std::partial_sum(counts.begin(), counts.end(), counts.begin());
+
+		columnIndices.resize(counts[rows]);
+		values.resize(counts[rows]);
+		Parallel::For(0, rows, RowGrain, [&](std::size_t begin, std::size_t end) {
+			for (auto row = begin; row < end; row++) {
+				for (auto k = counts[row]; k < counts[row + 1]; k++) {
+					const auto &entry = entries[rowOffsets[row] + k - counts[row]];
+					columnIndices[k] = entry.first;
+					values[k] = entry.second;
+				}
+			}
+		});
+		rowOffsets = std::move(counts);
+	}
+
+	std::size_t GetRows() const { return rowCount; }
+	std::size_t GetColumns() const { return columnCount; }
+	std::size_t GetNonZeroCount() const { return values.size(); }
+
+	/// Where each row starts in the column indices and values, with one more entry for the end of the last row.
+	const std::vector<std::size_t> &GetRowOffsets() const { return rowOffsets; }
+	const std::vector<uint32_t> &GetColumnIndices() const { return columnIndices; }
+	const std::vector<Block> &GetValues() const { return values; }
+
+	/**
+	 * Gets an entry by searching its row.
+	 * @param row The row.
+	 * @param column The column.
+	 * @return The entry, zero when it is not stored.
+	 */
+	Block Get(std::size_t row, std::size_t column) const {
+		auto first = columnIndices.begin() + rowOffsets[row], last = columnIndices.begin() + rowOffsets[row + 1];
+		auto it = std::lower_bound(first, last, static_cast<uint32_t>(column));
+		return it != last && *it == column ? values[it - columnIndices.begin()] : Block{};
+	}
+
+	/**
+	 * Gets the entries on the diagonal.
+	 * @return The diagonal, as long as the smaller of the row and column counts.
+	 */
+	std::vector<Block> GetDiagonal() const {
+		std::vector<Block> result(std::min(rowCount, columnCount));
+		Parallel::For(0, result.size(), RowGrain, [&](std::size_t begin, std::size_t end) {
+			for (auto row = begin; row < end; row++)
+				result[row] = Get(row, row);
+		});
+		return result;
+	}
+
+	/**
+	 * Transposes this matrix, which also converts it between CSR and CSC storage.
+	 * @return The transpose, blocks are transposed too.
+	 */
+	SparseMatrix Transpose() const {
+		SparseMatrix result;
+		result.rowCount = columnCount;
+		result.columnCount = rowCount;
+		result.rowOffsets.assign(columnCount + 1, 0);
+		for (auto column : columnIndices)
+			result.rowOffsets[column + 1]++;
+		std::partial_sum(result.rowOffsets.begin(), result.rowOffsets.end(), result.rowOffsets.begin());
+		result.columnIndices.resize(values.size());
+		result.values.resize(values.size());
+		// Visiting rows in order leaves every row of the transpose sorted by column.
+		auto next = result.rowOffsets;
+		for (std::size_t row = 0; row < rowCount; row++) {
+			for (auto k = rowOffsets[row]; k < rowOffsets[row + 1]; k++) {
+				auto index = next[columnIndices[k]]++;
+				result.columnIndices[index] = static_cast<uint32_t>(row);
+				result.values[index] = Detail::SparseTranspose(values[k]);
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * Multiplies a dense vector (SpMV), rows run across threads.
+	 * @param x The vector, as long as the column count.
+	 * @param y The product, as long as the row count, it must not be the same memory as x.
+	 */
+	void Multiply(Span<const Operand> x, Span<Operand> y) const {
+		Parallel::For(0, rowCount, RowGrain, [&](std::size_t begin, std::size_t end) {
+			for (auto row = begin; row < end; row++)
+				y[row] = MultiplyRow(row, x);
+		});
+	}
+
+	/**
+	 * Multiplies a dense matrix of K columns stored row by row (SpMM), rows run across threads.
+	 * Each entry of this matrix is loaded once for all K columns.
+	 * @param x The dense matrix, with K operands for each column of this matrix.
+	 * @param y The product, with K operands for each row of this matrix, it must not be the same memory as x.
+	 */
+	template<std::size_t K>
+	void Multiply(Span<const std::array<Operand, K>> x, Span<std::array<Operand, K>> y) const {
+		Parallel::For(0, rowCount, RowGrain, [&](std::size_t begin, std::size_t end) {
+			for (auto row = begin; row < end; row++) {
+				std::array<Operand, K> sum{};
+				for (auto k = rowOffsets[row]; k < rowOffsets[row + 1]; k++) {
+					const auto &value = values[k];
+					const auto &operands = x[columnIndices[k]];
+					for (std::size_t i = 0; i < K; i++)
+						sum[i] += value * operands[i];
+				}
+				y[row] = sum;
+			}
+		});
+	}
+
+	/**
+	 * Multiplies another sparse matrix, rows of the product are found concurrently by accumulating rows of the right matrix.
+	 * @param other The right matrix, with as many rows as this matrix has columns.
+	 * @return The product, entries that cancel to zero are still stored.
+	 */
+	SparseMatrix Multiply(const SparseMatrix &other) const {
+		static constexpr auto Unset = ~std::size_t(0);
+		SparseMatrix result;
+		result.rowCount = rowCount;
+		result.columnCount = other.columnCount;
+		// Chunks are large enough that the dense scratch row of each is allocated only a few times per thread.
+		auto grain = std::max<std::size_t>(RowGrain, rowCount / (Parallel::GetThreadCount() * 4) + 1);
+
+		// The first pass counts the columns of each product row, the second fills them in.
+		std::vector<std::size_t> counts(rowCount + 1);
+		Parallel::For(0, rowCount, grain, [&](std::size_t begin, std::size_t end) {
+			std::vector<std::size_t> marker(other.columnCount, Unset);
+			for (auto row = begin; row < end; row++) {
+				std::size_t count = 0;
+				for (auto k = rowOffsets[row]; k < rowOffsets[row + 1]; k++) {
+					auto middle = columnIndices[k];
+					for (auto l = other.rowOffsets[middle]; l < other.rowOffsets[middle + 1]; l++) {
+						auto column = other.columnIndices[l];
+						if (marker[column] != row) {
+							marker[column] = row;
+							count++;
+						}
+					}
+				}
+				counts[row + 1] = count;
+			}
+		});
+		std::partial_sum(counts.begin(), counts.end(), counts.begin());
+		result.columnIndices.resize(counts[rowCount]);
+		result.values.resize(counts[rowCount]);
+
+		Parallel::For(0, rowCount, grain, [&](std::size_t begin, std::size_t end) {
+			std::vector<std::size_t> slot(other.columnCount, Unset);
+			for (auto row = begin; row < end; row++) {
+				auto first = counts[row], last = first;
+				for (auto k = rowOffsets[row]; k < rowOffsets[row + 1]; k++) {
+					auto middle = columnIndices[k];
+					for (auto l = other.rowOffsets[middle]; l < other.rowOffsets[middle + 1]; l++) {
+						auto column = other.columnIndices[l];
+						auto product = values[k] * other.values[l];
+						if (slot[column] == Unset || slot[column] < first) {
+							slot[column] = last;
+							result.columnIndices[last] = column;
+							result.values[last++] = product;
+						} else {
+							result.values[slot[column]] = result.values[slot[column]] + product;
+						}
+					}
+				}
+				// Columns were appended in the order they were first reached, rows are stored sorted.
+				std::vector<std::pair<uint32_t, Block>> entries(last - first);
+				for (auto k = first; k < last; k++)
+					entries[k - first] = {result.columnIndices[k], result.values[k]};
+				std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+				for (auto k = first; k < last; k++) {
+					result.columnIndices[k] = entries[k - first].first;
+					result.values[k] = entries[k - first].second;
+				}
+			}
+		});
+		result.rowOffsets = std::move(counts);
+		return result;
+	}
+
+	/// Multiplies a dense vector, as Multiply does into existing memory.
+	friend std::vector<Operand> operator*(const SparseMatrix &lhs, Span<const Operand> rhs) {
+		std::vector<Operand> result(lhs.rowCount);
+		lhs.Multiply(rhs, result);
+		return result;
+	}
+
+	friend SparseMatrix operator*(const SparseMatrix &lhs, const SparseMatrix &rhs) {
+		return lhs.Multiply(rhs);
+	}
+
+private:
+	template<typename, typename> friend class ConjugateGradient;
+
+	/// Rows per chunk in the products.
+	static constexpr std::size_t RowGrain = 1 << 12;
+
+	Operand MultiplyRow(std::size_t row, Span<const Operand> x) const {
+		Operand sum{};
+		for (auto k = rowOffsets[row]; k < rowOffsets[row + 1]; k++)
+			sum += values[k] * x[columnIndices[k]];
+		return sum;
+	}
+
+	std::size_t rowCount = 0;
+	std::size_t columnCount = 0;
+	std::vector<std::size_t> rowOffsets = {0};
+	std::vector<uint32_t> columnIndices;
+	std::vector<Block> values;
+};
+
+/// A sparse matrix of square blocks, in block compressed sparse row (BSR) storage, multiplying vectors of B components.
+template<typename T, std::size_t B = 3>
+using BlockSparseMatrix = SparseMatrix<T, Matrix<T, B, B>>;
+
+/**
+ * @brief Solves sparse symmetric positive definite systems with the conjugate gradient method, preconditioned by the inverse
+ * of the diagonal, or of the diagonal blocks for block sparse matrices.
+ * Vector updates and dot products run across threads, dot products are summed over fixed chunks in a fixed tree,
+ * so results do not depend on the thread count.
+ * @tparam T The value type.
+ * @tparam Block The type of each matrix entry.
+ */
+template<typename T, typename Block = T>
+class ConjugateGradient {
+	static_assert(std::is_floating_point_v<T>, "ConjugateGradient needs a floating point type");
+public:
+	using System = SparseMatrix<T, Block>;
+	using Operand = typename System::Operand;
+
+	struct Result {
+		std::size_t iterations = 0;
+		/// The norm of the final residual relative to the norm of the right hand side.
+		T residual = 0;
+		bool converged = false;
+	};
+
+	/**
+	 * Solves matrix * x = b.
+	 * @param matrix The square symmetric positive definite matrix.
+	 * @param b The right hand side, as long as the row count.
+	 * @param x The initial guess, then the solution.
+	 * @param tolerance Stops once the residual norm is at most this fraction of the right hand side norm.
+	 * @param maxIterations Stops after this many iterations even when not converged.
+	 * @return The iterations taken and final relative residual.
+	 */
+	static Result Solve(const System &matrix, Span<const Operand> b, Span<Operand> x, T tolerance = T(1e-6), std::size_t maxIterations = 1000) {
+		auto n = matrix.GetRows();
+		auto diagonal = matrix.GetDiagonal();
+		std::vector<Block> inverseDiagonal(n);
+		std::vector<Operand> r(n), z(n), p(n), ap(n);
+		auto bNorm2 = Sum(n, [&](std::size_t row) {
+			inverseDiagonal[row] = Detail::SparseInverse(diagonal[row]);
+			return Vector<T, 2>(Detail::SparseDot(b[row], b[row]), 0);
+		})[0];
+		auto rz = Sum(n, [&](std::size_t row) {
+			r[row] = b[row] - matrix.MultiplyRow(row, x);
+			z[row] = inverseDiagonal[row] * r[row];
+			p[row] = z[row];
+			return Vector<T, 2>(Detail::SparseDot(r[row], z[row]), Detail::SparseDot(r[row], r[row]));
+		});
+
+		Result result;
+		auto threshold = tolerance * tolerance * bNorm2;
+		auto rNorm2 = rz[1];
+		while (rNorm2 > threshold && result.iterations < maxIterations) {
+			result.iterations++;
+			auto pap = Sum(n, [&](std::size_t row) {
+				ap[row] = matrix.MultiplyRow(row, p);
+				return Vector<T, 2>(Detail::SparseDot(p[row], ap[row]), 0);
+			})[0];
+			auto alpha = rz[0] / pap;
+			auto next = Sum(n, [&](std::size_t row) {
+				x[row] += alpha * p[row];
+				r[row] -= alpha * ap[row];
+				z[row] = inverseDiagonal[row] * r[row];
+				return Vector<T, 2>(Detail::SparseDot(r[row], z[row]), Detail::SparseDot(r[row], r[row]));
+			});
+			auto beta = next[0] / rz[0];
+			rz = next;
+			rNorm2 = rz[1];
+			Parallel::For(0, n, System::RowGrain, [&](std::size_t begin, std::size_t end) {
+				for (auto row = begin; row < end; row++)
+					p[row] = z[row] + beta * p[row];
+			});
+		}
+		result.residual = bNorm2 > 0 ? std::sqrt(rNorm2 / bNorm2) : std::sqrt(rNorm2);
+		result.converged = rNorm2 <= threshold;
+		return result;
+	}
+
+private:
+	/**
+	 * Calls a function on every row and sums what it returns, per chunk of rows then pairwise across chunks.
+	 */
+	template<typename Func>
+	static Vector<T, 2> Sum(std::size_t n, Func &&func) {
+		return Parallel::Reduce(0, n, System::RowGrain, Vector<T, 2>(), [&](std::size_t begin, std::size_t end) {
+			Vector<T, 2> sum;
+			for (auto row = begin; row < end; row++)
+				sum += func(row);
+			return sum;
+		}, [](const Vector<T, 2> &lhs, const Vector<T, 2> &rhs) { return lhs + rhs; });
+	}
+};
+}
@@ -0,0 +1,377 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "Parallel.hpp"
+#include "Vector.hpp"
+
+namespace MathsCPP {
+/**
+ * @brief A uniform grid over points where only occupied cells are stored, for particle neighbour searches.
+ * Cells are found through an open addressing table keyed on the packed integer cell coordinates, and each rebuild
+ * counting sorts the points by cell so the points of a cell are contiguous.
+ * @tparam T The value type.
+ * @tparam N Number of dimensions, 2 or 3.
+ */
+template<typename T, std::size_t N>
+class SpatialHashGrid {
+	static_assert(std::is_floating_point_v<T>, "SpatialHashGrid requires a floating point type");
+	static_assert(N == 2 || N == 3, "SpatialHashGrid supports 2 or 3 dimensions");
+public:
+	using Cell = Vector<int32_t, N>;
+	static constexpr uint32_t Invalid = ~uint32_t(0);
+
+	/**
+	 * Creates a new grid.
+	 * @param cellSize The width of each cell, usually the largest query radius.
+	 */
+	explicit SpatialHashGrid(T cellSize) :
+		cellSize(cellSize),
+		invCellSize(1 / cellSize) {
+	}
+
+	/**
+	 * Rebuilds the grid over a new set of points, replacing the previous set.
+	 * @param points The points, they are copied in cell order and reported by their index in this span.
+	 */
+	void Build(Span<const Vector<T, N>> points) {
+		auto count = static_cast<uint32_t>(points.size());
+		if (++generation == 0) {
+			// The generation wrapped, stale slots could now look current so clear them properly.
+			std::fill(slots.begin(), slots.end(), Slot());
+			generation = 1;
+		}
+		cellKeys.clear();
+		cellStart.clear();
+		pointCells.resize(count);
+
+		// Cell keys are found in their own pass so it vectorizes.
+		keys.resize(count);
+		Parallel::For(0, count, ChunkSize, [&](std::size_t begin, std::size_t end) {
+			// Plain pointers and a local scale, the compiler cannot prove the keys do not overwrite the captured members.
+			auto source = points.data();
+			auto destination = keys.data();
+			auto scale = invCellSize;
+			for (auto i = begin; i < end; i++) {
+				uint64_t key = 0;
+				for (std::size_t j = 0; j < N; j++)
+					key |= (static_cast<uint64_t>(static_cast<uint32_t>(Floor(source[i][j] * scale))) & KeyMask) << (j * KeyBits);
+				destination[i] = key;
+			}
+		});
+
+		// Find the cell of each point, the table slot for a later point is prefetched to hide the random access.
+		// Neighbouring points often share a cell so the last lookup is reused. This pass grows the table so it stays serial.
+		auto lastKey = ~uint64_t(0);
+		auto lastCell = Invalid;
+		for (uint32_t i = 0; i < count; i++) {
+			if (i + PrefetchDistance < count && !slots.empty())
+				Maths::Prefetch(&slots[Hash(keys[i + PrefetchDistance])]);
+			if (keys[i] != lastKey) {
+				lastKey = keys[i];
+				lastCell = Insert(lastKey);
+			}
+			pointCells[i] = lastCell;
+		}
+
+		// Count the points of each cell per chunk, then scatter each chunk into cell order from its own cursors. A chunk's points
+		// follow those of earlier chunks in every cell, so the result is the same for any chunk count and there is one chunk per thread.
+		auto cells = cellKeys.size();
+		auto chunks = std::clamp<std::size_t>(count / ChunkSize, 1, Parallel::GetThreadCount());
+		auto grain = (count + chunks - 1) / chunks;
+		cursor.assign(chunks * cells, 0);
+		Parallel::For(0, count, grain, [&](std::size_t begin, std::size_t end) {
+			auto counts = cursor.data() + begin / grain * cells;
+			for (auto i = begin; i < end; i++)
+				counts[pointCells[i]]++;
+		});
+
+		uint32_t offset = 0;
+		for (std::size_t cell = 0; cell < cells; cell++) {
+			cellStart[cell] = offset;
+			for (std::size_t chunk = 0; chunk < chunks; chunk++)
+				offset += std::exchange(cursor[chunk * cells + cell], offset);
+		}
+		cellStart.emplace_back(offset);
+		sortedIndices.resize(count);
+		sortedPoints.resize(count);
+		Parallel::For(0, count, grain, [&](std::size_t begin, std::size_t end) {
+			auto cursors = cursor.data() + begin / grain * cells;
+			for (auto i = begin; i < end; i++) {
+				auto position = cursors[pointCells[i]]++;
+				sortedIndices[position] = static_cast<uint32_t>(i);
+				sortedPoints[position] = points[i];
+			}
+		});
+	}
+
+	/**
+	 * Gets the cell a point is in.
+	 * @param point The point.
+	 * @return The integer cell coordinates.
+	 */
+	Cell GetCell(const Vector<T, N> &point) const {
+		Cell cell;
+		for (std::size_t i = 0; i < N; i++)
+			cell[i] = Floor(point[i] * invCellSize);
+		return cell;
+	}
+
+	/**
+	 * Calls a function for every point in a cell.
+	 * @tparam Func Invocable as func(index, point).
+	 * @param cell The cell coordinates.
+	 * @param func The function.
+	 */
+	template<typename Func>
+	void ForEachInCell(const Cell &cell, Func &&func) const {
+		auto id = Find(Key(cell));
+		if (id == Invalid)
+			return;
+		for (auto i = cellStart[id]; i < cellStart[id + 1]; i++)
+			func(sortedIndices[i], sortedPoints[i]);
+	}
+
+	/**
+	 * Calls a function for every point within a distance of a point, visiting each cell the distance overlaps.
+	 * @tparam Func Invocable as func(index, distance2).
+	 * @param center The point.
+	 * @param radius The distance, points at exactly this distance are included.
+	 * @param func The function.
+	 */
+	template<typename Func>
+	void Query(const Vector<T, N> &center, T radius, Func &&func) const {
+		auto radius2 = radius * radius;
+		ForEachCellIn(GetCell(center - Vector<T, N>(radius)), GetCell(center + Vector<T, N>(radius)), [&](uint32_t id) {
+			for (auto i = cellStart[id]; i < cellStart[id + 1]; i++) {
+				auto distance2 = center.Distance2(sortedPoints[i]);
+				if (distance2 <= radius2)
+					func(sortedIndices[i], distance2);
+			}
+		});
+	}
+
+	/**
+	 * Finds every point within a distance of a point.
+	 * @param center The point.
+	 * @param radius The distance, points at exactly this distance are included.
+	 * @return The indices of the points found, in no particular order.
+	 */
+	std::vector<uint32_t> Query(const Vector<T, N> &center, T radius) const {
+		std::vector<uint32_t> result;
+		Query(center, radius, [&](uint32_t index, T) { result.emplace_back(index); });
+		return result;
+	}
+
+	/**
+	 * Calls a function once for every pair of points within a distance of each other. Each cell is paired with itself and
+	 * with the half of its neighbours that come after it, so no pair of cells is visited twice.
+	 * @tparam Func Invocable as func(indexA, indexB, distance2).
+	 * @param radius The distance, pairs at exactly this distance are included.
+	 * @param func The function.
+	 */
+	template<typename Func>
+	void ForEachPair(T radius, Func &&func) const {
+		auto radius2 = radius * radius;
+		auto reach = static_cast<int32_t>(std::ceil(radius * invCellSize));
+		for (uint32_t id = 0; id < cellKeys.size(); id++) {
+			auto begin = cellStart[id], end = cellStart[id + 1];
+			for (auto i = begin; i < end; i++) {
+				for (auto j = i + 1; j < end; j++) {
+					auto distance2 = sortedPoints[i].Distance2(sortedPoints[j]);
+					if (distance2 <= radius2)
+						func(sortedIndices[i], sortedIndices[j], distance2);
+				}
+			}
+
+			auto cell = Unkey(cellKeys[id]);
+			ForEachOffset(reach, [&](const Cell &offset) {
+				auto other = Find(Key(cell + offset));
+				if (other == Invalid)
+					return;
+				for (auto i = begin; i < end; i++) {
+					for (auto j = cellStart[other]; j < cellStart[other + 1]; j++) {
+						auto distance2 = sortedPoints[i].Distance2(sortedPoints[j]);
+						if (distance2 <= radius2)
+							func(sortedIndices[i], sortedIndices[j], distance2);
+					}
+				}
+			});
+		}
+	}
+
+	T GetCellSize() const { return cellSize; }
+	/// Point indices in cell order, reordering particles by this between frames keeps rebuilds and queries cache friendly.
+	const std::vector<uint32_t> &GetOrder() const { return sortedIndices; }
+	std::size_t GetCellCount() const { return cellKeys.size(); }
+	std::size_t size() const { return sortedIndices.size(); }
+
+private:
+	struct Slot {
+		uint64_t key = 0;
+		uint32_t cell = 0;
+		/// The build the slot was written in, slots from older builds count as empty so the table never needs clearing.
+		uint32_t generation = 0;
+	};
+
+	/// Points ahead of the current one whose table slot is prefetched while finding cells, a few cells' worth in cell ordered input.
+	static constexpr uint32_t PrefetchDistance = 64;
+	/// The fewest points a chunk of a build is given, smaller builds run as one chunk.
+	static constexpr std::size_t ChunkSize = 1 << 16;
+	/// Bits per coordinate in a packed key, coordinates are kept modulo this many bits.
+	static constexpr uint32_t KeyBits = N == 2 ? 32 : 21;
+	static constexpr uint64_t KeyMask = (uint64_t(1) << KeyBits) - 1;
+
+	/**
+	 * Rounds down without a library call, so loops using it vectorize. Values past the int32 range are clamped to it first
+	 * and NaN goes to the lowest cell, so the conversion is always defined.
+	 */
+	static int32_t Floor(T x) {
+		// The upper bound is the largest float below 2^31, the comparisons are written so NaN takes the lower bound.
+		x = x > static_cast<T>(-2147483648.0) ? x : static_cast<T>(-2147483648.0);
+		x = x < static_cast<T>(2147483520.0) ? x : static_cast<T>(2147483520.0);
+		auto i = static_cast<int32_t>(x);
+		return i - static_cast<int32_t>(x < static_cast<T>(i));
+	}
+
+	/**
+	 * Packs cell coordinates into a key. Cells further apart than 2^21 in three dimensions share keys, that only merges
+	 * their points into one cell and every query still checks distances.
+	 */
+	static uint64_t Key(const Cell &cell) {
+		uint64_t key = 0;
+		for (std::size_t i = 0; i < N; i++)
+			key |= (static_cast<uint64_t>(static_cast<uint32_t>(cell[i])) & KeyMask) << (i * KeyBits);
+		return key;
+	}
+
+	static Cell Unkey(uint64_t key) {
+		Cell cell;
+		for (std::size_t i = 0; i < N; i++) {
+			// Shift the coordinate to the top of the word and back so it is sign extended.
+			auto bits = static_cast<int64_t>(((key >> (i * KeyBits)) & KeyMask) << (64 - KeyBits));
+			cell[i] = static_cast<int32_t>(bits >> (64 - KeyBits));
+		}
+		return cell;
+	}
+
+	/**
+	 * Multiplicative hashing, the top bits of the product mix every bit of the key.
+	 */
+	std::size_t Hash(uint64_t key) const {
+		return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> (64 - tableBits));
+	}
+
+	uint32_t Find(uint64_t key) const {
+		if (slots.empty())
+			return Invalid;
+		auto mask = slots.size() - 1;
+		for (auto i = Hash(key);; i = (i + 1) & mask) {
+			const auto &slot = slots[i];
+			if (slot.generation != generation)
+				return Invalid;
+			if (slot.key == key)
+				return slot.cell;
+		}
+	}
+
+	/**
+	 * Finds the cell for a key, adding an empty cell if there is none.
+	 */
+	uint32_t Insert(uint64_t key) {
+		if ((cellKeys.size() + 1) * 2 > slots.size())
+			Rehash();
+		auto mask = slots.size() - 1;
+		for (auto i = Hash(key);; i = (i + 1) & mask) {
+			auto &slot = slots[i];
+			if (slot.generation != generation) {
+				auto cell = static_cast<uint32_t>(cellKeys.size());
+				slot = {key, cell, generation};
+				cellKeys.emplace_back(key);
+				cellStart.emplace_back(0);
+				return cell;
+			}
+			if (slot.key == key)
+				return slot.cell;
+		}
+	}
+
+	/**
+	 * Doubles the table and reinserts the cells of the current build.
+	 */
+	void Rehash() {
+		tableBits = std::max<uint32_t>(tableBits + 1, 10);
+		slots.assign(std::size_t(1) << tableBits, Slot());
+		auto mask = slots.size() - 1;
+		for (uint32_t cell = 0; cell < cellKeys.size(); cell++) {
+			auto i = Hash(cellKeys[cell]);
+			while (slots[i].generation == generation)
+				i = (i + 1) & mask;
+			slots[i] = {cellKeys[cell], cell, generation};
+		}
+	}
+
+	template<typename Func>
+	void ForEachCellIn(const Cell &min, const Cell &max, Func &&func) const {
+		Cell cell = min;
+		while (true) {
+			auto id = Find(Key(cell));
+			if (id != Invalid)
+				func(id);
+			std::size_t i = 0;
+			for (; i < N && cell[i] == max[i]; i++)
+				cell[i] = min[i];
+			if (i == N)
+				return;
+			cell[i]++;
+		}
+	}
+
+	/**
+	 * Calls a function for each cell offset within reach that is after the origin, comparing the last axis first.
+	 */
+	template<typename Func>
+	static void ForEachOffset(int32_t reach, Func &&func) {
+		Cell offset(-reach);
+		while (true) {
+			for (auto i = N; i-- > 0;) {
+				if (offset[i] != 0) {
+					if (offset[i] > 0)
+						func(offset);
+					break;
+				}
+			}
+			std::size_t i = 0;
+			for (; i < N && offset[i] == reach; i++)
+				offset[i] = -reach;
+			if (i == N)
+				return;
+			offset[i]++;
+		}
+	}
+
+	T cellSize;
+	T invCellSize;
+
+	std::vector<Slot> slots;
+	uint32_t tableBits = 0;
+	uint32_t generation = 0;
+
+	/// The packed key of each cell, in the order cells were first seen.
+	std::vector<uint64_t> cellKeys;
+	/// The first sorted position of each cell, with one extra entry holding the point count.
+	std::vector<uint32_t> cellStart;
+	std::vector<uint64_t> keys;
+	std::vector<uint32_t> pointCells;
+	/// The point count and then the next write position of each cell, one row per build chunk.
+	std::vector<uint32_t> cursor;
+	std::vector<uint32_t> sortedIndices;
+	std::vector<Vector<T, N>> sortedPoints;
+};
+
+using SpatialHashGrid2f = SpatialHashGrid<float, 2>;
+using SpatialHashGrid3f = SpatialHashGrid<float, 3>;
+}
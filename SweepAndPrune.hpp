@@ -0,0 +1,351 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <unordered_set>
+#include <vector>
+
+#include "AABB.hpp"
+#include "Parallel.hpp"
+
+namespace MathsCPP {
+/**
+ * @brief An incremental sweep and prune broadphase over axis aligned boxes.
+ * Box endpoints are kept sorted along every axis, each update re-sorts them with an insertion sort which is close to linear
+ * when boxes move a little between frames. Endpoints swapping past each other mark the only pairs whose overlap may have changed,
+ * so each update reports the pairs that started and stopped overlapping without testing every pair.
+ * Pairs follow AABB::Intersects, boxes that only touch do not overlap and zero width boxes are found like any other.
+ * @tparam T The value type.
+ * @tparam N Number of dimensions.
+ */
+template<typename T, std::size_t N>
+class SweepAndPrune {
+public:
+	using Handle = uint32_t;
+
+	struct Pair {
+		Handle a, b;
+	};
+
+	/**
+	 * Adds a box, it is sorted in and its pairs are reported by the next Update.
+	 * @param box The box.
+	 * @return The handle used to move or remove the box.
+	 */
+	Handle Add(const AABB<T, N> &box) {
+		Handle handle;
+		if (!freeHandles.empty()) {
+			handle = freeHandles.back();
+			freeHandles.pop_back();
+			bodies[handle] = {box, AABB<T, N>::Empty};
+			alive[handle] = true;
+		} else {
+			handle = static_cast<Handle>(bodies.size());
+			bodies.push_back({box, AABB<T, N>::Empty});
+			alive.emplace_back(true);
+		}
+
+		for (auto &axis : axes) {
+			axis.push_back({T(), handle << 1, Empty, Empty});
+			axis.push_back({T(), (handle << 1) | 1, Empty, Empty});
+		}
+		added++;
+		return handle;
+	}
+
+	template<std::size_t N1 = N, typename = std::enable_if_t<N1 == 2>>
+	Handle Add(const Rectangle<T> &rect) {
+		return Add(AABB<T, N>(rect));
+	}
+
+	/**
+	 * Removes a box, its pairs are reported as removed by the next Update. Handles that are not alive are ignored,
+	 * so removing a box twice cannot hand its handle out twice.
+	 * @param handle The box handle.
+	 */
+	void Remove(Handle handle) {
+		if (handle >= alive.size() || !alive[handle])
+			return;
+		alive[handle] = false;
+		removed.emplace_back(handle);
+	}
+
+	/**
+	 * Moves a box, the endpoints are re-sorted by the next Update.
+	 * @param handle The box handle.
+	 * @param box The new box.
+	 */
+	void Move(Handle handle, const AABB<T, N> &box) {
+		bodies[handle].box = box;
+	}
+
+	template<std::size_t N1 = N, typename = std::enable_if_t<N1 == 2>>
+	void Move(Handle handle, const Rectangle<T> &rect) {
+		Move(handle, AABB<T, N>(rect));
+	}
+
+	/**
+	 * Re-sorts the endpoints and finds the pairs that changed since the last update.
+	 * Axes are sorted concurrently when there are enough boxes for it to pay off.
+	 */
+	void Update() {
+		addedPairs.clear();
+		removedPairs.clear();
+
+		if (!removed.empty())
+			Prune();
+
+		auto endpoints = axes[0].size();
+		if (added * 16 > endpoints) {
+			Rebuild();
+		} else {
+			auto sort = [this](std::size_t begin, std::size_t end) {
+				for (auto axis = begin; axis < end; axis++)
+					Sort(axis);
+			};
+			if (endpoints >= ParallelThreshold)
+				Parallel::For(0, N, 1, sort);
+			else
+				sort(0, N);
+
+			for (const auto &candidates : axisCandidates) {
+				for (auto key : candidates)
+					RefreshPair(key);
+			}
+		}
+		for (auto &body : bodies)
+			body.previous = body.box;
+		added = 0;
+	}
+
+	const std::vector<Pair> &GetAddedPairs() const { return addedPairs; }
+	const std::vector<Pair> &GetRemovedPairs() const { return removedPairs; }
+
+	/**
+	 * Calls a function for every overlapping pair.
+	 * @tparam Func Invocable as func(Pair).
+	 * @param func The function.
+	 */
+	template<typename Func>
+	void ForEachPair(Func &&func) const {
+		for (auto key : pairs)
+			func(Unpack(key));
+	}
+
+	bool HasPair(Handle a, Handle b) const { return pairs.count(Pack(a, b)) != 0; }
+	std::size_t GetPairCount() const { return pairs.size(); }
+	const AABB<T, N> &GetBox(Handle handle) const { return bodies[handle].box; }
+
+private:
+	/// Endpoints across all boxes before axes are sorted on separate threads.
+	static constexpr std::size_t ParallelThreshold = 8192;
+	/// Endpoints ahead of the current one whose body is prefetched while refreshing values.
+	static constexpr std::size_t PrefetchDistance = 8;
+
+	struct Body {
+		AABB<T, N> box;
+		/// The box as of the last update, pairs overlapping in these are exactly the current pair set.
+		AABB<T, N> previous;
+	};
+
+	struct Interval {
+		T min, max;
+
+		bool Intersects(const Interval &other) const { return (min < other.max) & (other.min < max); }
+	};
+
+	static constexpr Interval Empty = {std::numeric_limits<T>::max(), std::numeric_limits<T>::lowest()};
+	static constexpr uint32_t Inactive = ~uint32_t(0);
+
+	struct Endpoint {
+		T value;
+		/// The box handle shifted left by one, with the low bit set for a max endpoint.
+		uint32_t id;
+		/// The box extent on the next axis now and as of the last update, this rejects most swaps without reading the boxes.
+		Interval next, previous;
+	};
+
+	/**
+	 * Orders endpoints by value, at equal values max endpoints go first so touching boxes are apart on the axis,
+	 * the order between one box's min and another's max then matches AABB::Intersects exactly.
+	 */
+	static bool Less(const Endpoint &a, const Endpoint &b) {
+		return a.value < b.value || (a.value == b.value && (a.id & 1) > (b.id & 1));
+	}
+
+	static uint64_t Pack(Handle a, Handle b) {
+		if (a > b)
+			std::swap(a, b);
+		return (static_cast<uint64_t>(a) << 32) | b;
+	}
+
+	static Pair Unpack(uint64_t key) {
+		return {static_cast<Handle>(key >> 32), static_cast<Handle>(key)};
+	}
+
+	/**
+	 * Reads the value and next axis extent of an endpoint from its box.
+	 */
+	void RefreshValue(Endpoint &endpoint, std::size_t axis) const {
+		auto next = (axis + 1) % N;
+		const auto &box = bodies[endpoint.id >> 1].box;
+		endpoint.value = (endpoint.id & 1) ? box.max[axis] : box.min[axis];
+		endpoint.previous = endpoint.next;
+		endpoint.next = {box.min[next], box.max[next]};
+	}
+
+	void RefreshValues(std::size_t axis) {
+		for (auto &endpoint : axes[axis])
+			RefreshValue(endpoint, axis);
+	}
+
+	/**
+	 * Refreshes the endpoint values of an axis and insertion sorts them in the same pass, everything below the current
+	 * endpoint is already refreshed. The endpoints are in sorted order rather than body order, so body reads are fetched ahead.
+	 */
+	void Sort(std::size_t axis) {
+		auto &endpoints = axes[axis];
+		auto &candidates = axisCandidates[axis];
+		candidates.clear();
+
+		for (std::size_t i = 0; i < endpoints.size(); i++) {
+			if (i + PrefetchDistance < endpoints.size())
+				Maths::Prefetch(&bodies[endpoints[i + PrefetchDistance].id >> 1]);
+			RefreshValue(endpoints[i], axis);
+			if (i > 0 && Less(endpoints[i], endpoints[i - 1]))
+				(endpoints[i].id & 1) ? Sink<true>(endpoints, i, candidates) : Sink<false>(endpoints, i, candidates);
+		}
+	}
+
+	/**
+	 * Moves endpoint i down to its sorted place, collecting the pairs it passes whose overlap may have changed.
+	 * A min moving below a max starts two boxes overlapping on this axis, which only matters if they now overlap fully.
+	 * A max moving below a min stops them overlapping, which only matters if they overlapped fully last update.
+	 * The cheap tests are combined without branching, so only the rare pairs that pass them branch.
+	 */
+	template<bool Max>
+	void Sink(std::vector<Endpoint> &endpoints, std::size_t i, std::vector<uint64_t> &candidates) const {
+		auto endpoint = endpoints[i];
+		auto handle = endpoint.id >> 1;
+		const auto &interval = Max ? endpoint.previous : endpoint.next;
+		auto j = i;
+		do {
+			const auto &other = endpoints[j - 1];
+			auto otherHandle = other.id >> 1;
+			if ((((other.id & 1) != 0) != Max) & interval.Intersects(Max ? other.previous : other.next) & (handle != otherHandle)) {
+				auto changed = Max ? bodies[handle].previous.Intersects(bodies[otherHandle].previous) : bodies[handle].box.Intersects(bodies[otherHandle].box);
+				if (changed)
+					candidates.emplace_back(Pack(handle, otherHandle));
+			}
+			endpoints[j] = other;
+		} while (--j > 0 && Less(endpoint, endpoints[j - 1]));
+		endpoints[j] = endpoint;
+	}
+
+	void RefreshPair(uint64_t key) {
+		auto pair = Unpack(key);
+		auto overlap = bodies[pair.a].box.Intersects(bodies[pair.b].box);
+		auto it = pairs.find(key);
+		if (overlap && it == pairs.end()) {
+			pairs.emplace(key);
+			addedPairs.emplace_back(pair);
+		} else if (!overlap && it != pairs.end()) {
+			pairs.erase(it);
+			removedPairs.emplace_back(pair);
+		}
+	}
+
+	/**
+	 * Drops the endpoints and pairs of removed boxes, then recycles their handles.
+	 */
+	void Prune() {
+		for (auto &axis : axes) {
+			axis.erase(std::remove_if(axis.begin(), axis.end(), [this](const Endpoint &endpoint) {
+				return !alive[endpoint.id >> 1];
+			}), axis.end());
+		}
+		for (auto it = pairs.begin(); it != pairs.end();) {
+			auto pair = Unpack(*it);
+			if (alive[pair.a] && alive[pair.b]) {
+				++it;
+				continue;
+			}
+			removedPairs.emplace_back(pair);
+			it = pairs.erase(it);
+		}
+		freeHandles.insert(freeHandles.end(), removed.begin(), removed.end());
+		removed.clear();
+	}
+
+	/**
+	 * Fully sorts every axis and sweeps the first to find all pairs, used when too many boxes were added for insertion sorting.
+	 */
+	void Rebuild() {
+		auto sort = [this](std::size_t begin, std::size_t end) {
+			for (auto axis = begin; axis < end; axis++) {
+				RefreshValues(axis);
+				std::sort(axes[axis].begin(), axes[axis].end(), Less);
+			}
+		};
+		if (axes[0].size() >= ParallelThreshold)
+			Parallel::For(0, N, 1, sort);
+		else
+			sort(0, N);
+
+		std::unordered_set<uint64_t> found;
+		found.reserve(pairs.size());
+		std::vector<Handle> active;
+		std::vector<uint32_t> activeIndex(bodies.size(), Inactive);
+		for (const auto &endpoint : axes[0]) {
+			auto handle = endpoint.id >> 1;
+			if (endpoint.id & 1) {
+				// A box no wider than zero on the axis reaches its max first and was never made active.
+				if (activeIndex[handle] == Inactive)
+					continue;
+				auto last = active.back();
+				active[activeIndex[handle]] = last;
+				activeIndex[last] = activeIndex[handle];
+				activeIndex[handle] = Inactive;
+				active.pop_back();
+				continue;
+			}
+			const auto &box = bodies[handle].box;
+			for (auto other : active) {
+				if (box.Intersects(bodies[other].box))
+					found.emplace(Pack(handle, other));
+			}
+			// Its max has already been passed, so it overlaps no box whose min comes later.
+			if (!(box.min[0] < box.max[0]))
+				continue;
+			activeIndex[handle] = static_cast<uint32_t>(active.size());
+			active.emplace_back(handle);
+		}
+
+		for (auto key : pairs) {
+			if (found.count(key) == 0)
+				removedPairs.emplace_back(Unpack(key));
+		}
+		for (auto key : found) {
+			if (pairs.count(key) == 0)
+				addedPairs.emplace_back(Unpack(key));
+		}
+		pairs = std::move(found);
+	}
+
+	std::vector<Body> bodies;
+	std::vector<uint8_t> alive;
+	std::vector<Handle> freeHandles;
+	std::vector<Handle> removed;
+	std::size_t added = 0;
+
+	std::array<std::vector<Endpoint>, N> axes;
+	std::array<std::vector<uint64_t>, N> axisCandidates;
+
+	std::unordered_set<uint64_t> pairs;
+	std::vector<Pair> addedPairs;
+	std::vector<Pair> removedPairs;
+};
+
+using SweepAndPrune2f = SweepAndPrune<float, 2>;
+using SweepAndPrune3f = SweepAndPrune<float, 3>;
+}
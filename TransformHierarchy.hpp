@@ -0,0 +1,327 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "Matrix.hpp"
+#include "Parallel.hpp"
+#include "Quaternion.hpp"
+
+namespace MathsCPP {
+/**
+ * @brief A scene graph of translation, rotation and scale transforms that keeps a local to world matrix for every node.
+ * Components are held in a structure of arrays layout in breadth first order, so nodes are sorted by depth, every parent comes
+ * before its children and the children of a node are contiguous.
+ * Setting a component marks the node dirty, and Update only recomputes the world matrices of dirty nodes and their descendants.
+ * Update walks one depth level at a time: a level only reads the level above it, so levels with many changes are split across cores.
+ * Changed nodes are composed from their components a block at a time, in loops that vectorize across nodes.
+ * @tparam T The value type.
+ */
+template<typename T>
+class TransformHierarchy {
+public:
+	/// The parent of root nodes.
+	static constexpr uint32_t NoParent = ~uint32_t(0);
+
+	TransformHierarchy() = default;
+
+	/**
+	 * Adds a node, its world matrix is valid after the next Update.
+	 * @param parent The parent node, must already be added, or NoParent for a root.
+	 * @param translation The local translation.
+	 * @param rotation The local rotation, must be normalized.
+	 * @param scale The local scale.
+	 * @return The node, nodes are numbered from zero in the order they are added.
+	 */
+	uint32_t Add(uint32_t parent = NoParent, const Vector<T, 3> &translation = {}, const Quaternion<T> &rotation = {},
+		const Vector<T, 3> &scale = Vector<T, 3>(1)) {
+		auto node = static_cast<uint32_t>(slots.size());
+		auto slot = node;
+		auto parentSlot = parent == NoParent ? NoParent : slots[parent];
+		auto depth = parent == NoParent ? 0 : depths[parentSlot] + 1;
+		slots.emplace_back(slot);
+		nodes.emplace_back(node);
+		parents.emplace_back(parentSlot);
+		depths.emplace_back(depth);
+		dirty.emplace_back(0);
+		changed.emplace_back(0);
+		worlds.emplace_back();
+		tx.emplace_back(), ty.emplace_back(), tz.emplace_back();
+		rx.emplace_back(), ry.emplace_back(), rz.emplace_back(), rw.emplace_back();
+		sx.emplace_back(), sy.emplace_back(), sz.emplace_back();
+		SetComponents(slot, translation, rotation, scale);
+		sorted = false;
+		return node;
+	}
+
+	void Reserve(std::size_t size) {
+		slots.reserve(size), nodes.reserve(size), parents.reserve(size), depths.reserve(size);
+		dirty.reserve(size), changed.reserve(size), worlds.reserve(size);
+		tx.reserve(size), ty.reserve(size), tz.reserve(size);
+		rx.reserve(size), ry.reserve(size), rz.reserve(size), rw.reserve(size);
+		sx.reserve(size), sy.reserve(size), sz.reserve(size);
+	}
+
+	std::size_t size() const { return slots.size(); }
+
+	uint32_t GetParent(uint32_t node) const {
+		auto parent = parents[slots[node]];
+		return parent == NoParent ? NoParent : nodes[parent];
+	}
+
+	Vector<T, 3> GetTranslation(uint32_t node) const {
+		auto slot = slots[node];
+		return {tx[slot], ty[slot], tz[slot]};
+	}
+
+	Quaternion<T> GetRotation(uint32_t node) const {
+		auto slot = slots[node];
+		return {rx[slot], ry[slot], rz[slot], rw[slot]};
+	}
+
+	Vector<T, 3> GetScale(uint32_t node) const {
+		auto slot = slots[node];
+		return {sx[slot], sy[slot], sz[slot]};
+	}
+
+	void SetTranslation(uint32_t node, const Vector<T, 3> &translation) {
+		auto slot = slots[node];
+		tx[slot] = translation.x, ty[slot] = translation.y, tz[slot] = translation.z;
+		MarkDirty(slot);
+	}
+
+	void SetRotation(uint32_t node, const Quaternion<T> &rotation) {
+		auto slot = slots[node];
+		rx[slot] = rotation.x, ry[slot] = rotation.y, rz[slot] = rotation.z, rw[slot] = rotation.w;
+		MarkDirty(slot);
+	}
+
+	void SetScale(uint32_t node, const Vector<T, 3> &scale) {
+		auto slot = slots[node];
+		sx[slot] = scale.x, sy[slot] = scale.y, sz[slot] = scale.z;
+		MarkDirty(slot);
+	}
+
+	void SetLocal(uint32_t node, const Vector<T, 3> &translation, const Quaternion<T> &rotation, const Vector<T, 3> &scale) {
+		SetComponents(slots[node], translation, rotation, scale);
+	}
+
+	/**
+	 * Gets the local to world matrix of a node as of the last Update, it transforms column vectors as Matrix * Vector does.
+	 * @param node The node.
+	 * @return The world matrix.
+	 */
+	const Matrix<T, 4, 4> &GetWorld(uint32_t node) const { return worlds[slots[node]]; }
+
+	/**
+	 * Tests if the world matrix of a node was recomputed by the last Update.
+	 * @param node The node.
+	 * @return If the node or one of its ancestors was dirty.
+	 */
+	bool IsChanged(uint32_t node) const { return changed[slots[node]] != 0; }
+
+	/**
+	 * Recomputes the world matrices of dirty nodes and everything below them, then clears the dirty marks.
+	 * The work is proportional to the number of recomputed nodes, unchanged parts of the scene are never visited.
+	 */
+	void Update() {
+		if (!sorted)
+			Sort();
+		// After a large update clearing every flag is cheaper than scattering over the list.
+		if (changedSlots.size() > changed.size() / 16) {
+			std::fill(changed.begin(), changed.end(), uint8_t(0));
+		} else {
+			for (auto slot : changedSlots)
+				changed[slot] = 0;
+		}
+		changedSlots.clear();
+		std::sort(dirtySlots.begin(), dirtySlots.end());
+
+		// Each level updates the dirty nodes on it merged with the children of the nodes changed on the level above.
+		work.clear();
+		auto dirtyNext = dirtySlots.begin();
+		for (std::size_t level = 0; level + 1 < levels.size(); level++) {
+			auto dirtyEnd = std::lower_bound(dirtyNext, dirtySlots.end(), levels[level + 1]);
+			if (work.empty() && dirtyNext == dirtyEnd) {
+				if (dirtyEnd == dirtySlots.end())
+					break;
+				continue;
+			}
+			merged.clear();
+			std::set_union(work.begin(), work.end(), dirtyNext, dirtyEnd, std::back_inserter(merged));
+			dirtyNext = dirtyEnd;
+
+			Parallel::For(0, merged.size(), ParallelGrain, [this](std::size_t begin, std::size_t end) {
+				UpdateNodes(merged.data() + begin, end - begin);
+			});
+			// Children of one node are contiguous and follow the order of their parents, so the next level's work stays sorted.
+			work.clear();
+			for (auto slot : merged) {
+				for (auto child = childBegin[slot]; child < childBegin[slot + 1]; child++)
+					work.emplace_back(child);
+			}
+			changedSlots.insert(changedSlots.end(), merged.begin(), merged.end());
+		}
+		dirtySlots.clear();
+	}
+
+private:
+	/// Nodes per chunk when a level is split across cores.
+	static constexpr std::size_t ParallelGrain = 1 << 14;
+	/// Nodes whose components are gathered and composed together.
+	static constexpr std::size_t Block = 64;
+
+	void MarkDirty(uint32_t slot) {
+		if (!dirty[slot]) {
+			dirty[slot] = 1;
+			dirtySlots.emplace_back(slot);
+		}
+	}
+
+	void SetComponents(uint32_t slot, const Vector<T, 3> &translation, const Quaternion<T> &rotation, const Vector<T, 3> &scale) {
+		tx[slot] = translation.x, ty[slot] = translation.y, tz[slot] = translation.z;
+		rx[slot] = rotation.x, ry[slot] = rotation.y, rz[slot] = rotation.z, rw[slot] = rotation.w;
+		sx[slot] = scale.x, sy[slot] = scale.y, sz[slot] = scale.z;
+		MarkDirty(slot);
+	}
+
+	/**
+	 * Moves the nodes into breadth first order, roots first and then the children of each node together in the order of their parents.
+	 * Within one parent, children keep the order they were added.
+	 */
+	void Sort() {
+		auto count = static_cast<uint32_t>(slots.size());
+		std::vector<uint32_t> offsets(count + 2), children(count), order;
+		for (auto parent : parents) {
+			if (parent != NoParent)
+				offsets[parent + 2]++;
+		}
+		for (std::size_t slot = 2; slot < offsets.size(); slot++)
+			offsets[slot] += offsets[slot - 1];
+		order.reserve(count);
+		for (uint32_t slot = 0; slot < count; slot++) {
+			if (parents[slot] == NoParent)
+				order.emplace_back(slot);
+			else
+				children[offsets[parents[slot] + 1]++] = slot;
+		}
+		childBegin.assign(count + 1, 0);
+		childBegin[0] = static_cast<uint32_t>(order.size());
+		for (uint32_t i = 0; i < count; i++) {
+			auto slot = order[i];
+			order.insert(order.end(), children.begin() + offsets[slot], children.begin() + offsets[slot + 1]);
+			childBegin[i + 1] = static_cast<uint32_t>(order.size());
+		}
+
+		std::vector<uint32_t> remap(count);
+		for (uint32_t i = 0; i < count; i++)
+			remap[order[i]] = i;
+		auto permute = [&](auto &values) {
+			std::remove_reference_t<decltype(values)> result(values.size());
+			for (uint32_t i = 0; i < count; i++)
+				result[i] = values[order[i]];
+			values.swap(result);
+		};
+		for (auto &parent : parents)
+			parent = parent == NoParent ? NoParent : remap[parent];
+		permute(parents), permute(depths), permute(nodes), permute(dirty), permute(changed), permute(worlds);
+		permute(tx), permute(ty), permute(tz);
+		permute(rx), permute(ry), permute(rz), permute(rw);
+		permute(sx), permute(sy), permute(sz);
+		for (uint32_t slot = 0; slot < count; slot++)
+			slots[nodes[slot]] = slot;
+		for (auto &slot : dirtySlots)
+			slot = remap[slot];
+		for (auto &slot : changedSlots)
+			slot = remap[slot];
+
+		levels.assign(depths.back() + 2, 0);
+		for (auto depth : depths)
+			levels[depth + 1]++;
+		for (std::size_t level = 1; level < levels.size(); level++)
+			levels[level] += levels[level - 1];
+		sorted = true;
+	}
+
+	/**
+	 * Recomputes the world matrices of a list of nodes whose parents are already up to date.
+	 */
+	void UpdateNodes(const uint32_t *indices, std::size_t count) {
+		T local[12][Block];
+		for (std::size_t first = 0; first < count; first += Block) {
+			auto n = std::min(count - first, Block);
+			// Sparse updates touch scattered slots, so the next block's components and matrices are fetched while this one is composed.
+			for (auto i = first + Block; i < std::min(count, first + 2 * Block); i++) {
+				auto slot = indices[i];
+				Maths::Prefetch(&worlds[slot]);
+				for (auto source : {&tx, &ty, &tz, &rx, &ry, &rz, &rw, &sx, &sy, &sz})
+					Maths::Prefetch(source->data() + slot);
+			}
+			Compose(indices + first, n, local);
+			for (std::size_t i = 0; i < n; i++) {
+				auto slot = indices[first + i];
+				auto &world = worlds[slot];
+				auto parent = parents[slot];
+				if (parent == NoParent) {
+					for (std::size_t j = 0; j < 3; j++) {
+						for (std::size_t k = 0; k < 4; k++)
+							world[j][k] = local[j * 4 + k][i];
+					}
+				} else {
+					// Both matrices are affine, so the bottom rows take no part in the product.
+					const auto &p = worlds[parent];
+					for (std::size_t j = 0; j < 3; j++) {
+						for (std::size_t k = 0; k < 4; k++)
+							world[j][k] = p[j][0] * local[k][i] + p[j][1] * local[4 + k][i] + p[j][2] * local[8 + k][i];
+						world[j][3] += p[j][3];
+					}
+				}
+				world[3] = {0, 0, 0, 1};
+				changed[slot] = 1;
+				dirty[slot] = 0;
+			}
+		}
+	}
+
+	/**
+	 * Composes translation * rotation * scale for a list of nodes, row j column k of node i goes to local[j * 4 + k][i].
+	 */
+	void Compose(const uint32_t *indices, std::size_t count, T (&local)[12][Block]) const {
+		T components[10][Block];
+		const std::vector<T> *sources[10] = {&tx, &ty, &tz, &rx, &ry, &rz, &rw, &sx, &sy, &sz};
+		for (std::size_t c = 0; c < 10; c++) {
+			auto source = sources[c]->data();
+			for (std::size_t i = 0; i < count; i++)
+				components[c][i] = source[indices[i]];
+		}
+		for (std::size_t i = 0; i < count; i++) {
+			Detail::ComposeTRS(components[0][i], components[1][i], components[2][i], components[3][i], components[4][i], components[5][i],
+				components[6][i], components[7][i], components[8][i], components[9][i], &local[0][i], Block);
+		}
+	}
+
+	/// The slot of each node, and the node in each slot.
+	std::vector<uint32_t> slots, nodes;
+	/// The slot of the parent of each slot, or NoParent.
+	std::vector<uint32_t> parents;
+	std::vector<uint32_t> depths;
+	std::vector<uint8_t> dirty, changed;
+	std::vector<Matrix<T, 4, 4>> worlds;
+	std::vector<T> tx, ty, tz;
+	std::vector<T> rx, ry, rz, rw;
+	std::vector<T> sx, sy, sz;
+	/// The first child of each slot, the children of a slot end where those of the next slot begin.
+	std::vector<uint32_t> childBegin;
+	/// The first slot of each depth, followed by the node count.
+	std::vector<uint32_t> levels;
+	std::vector<uint32_t> dirtySlots, changedSlots;
+	/// The nodes to update on the current level, and the same merged with the dirty nodes of the level.
+	std::vector<uint32_t> work, merged;
+	bool sorted = true;
+};
+
+using TransformHierarchyf = TransformHierarchy<float>;
+using TransformHierarchyd = TransformHierarchy<double>;
+}
@@ -2,11 +2,14 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <ostream>
 
+#include "Half.hpp"
 #include "Maths.hpp"
+#include "Parallel.hpp"
 
 namespace MathsCPP {
-template<typename T, std::size_t N, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+template<typename T, std::size_t N, typename = std::enable_if_t<is_number_v<T>>>
 class VectorBase {
 protected:
 	constexpr VectorBase() = default;
@@ -61,30 +64,30 @@ template<typename T, std::size_t N>
 class Vector : public VectorBase<T, N> {
 public:
 	constexpr Vector() = default;
-	template<typename ...Args, typename = std::enable_if_t<sizeof...(Args) <= N && std::conjunction_v<std::is_arithmetic<Args>...>>>
+	template<typename ...Args, typename = std::enable_if_t<sizeof...(Args) <= N && std::conjunction_v<is_number<Args>...>>>
 	constexpr Vector(Args... args) : VectorBase<T, N>(static_cast<T>(args)...) {}
 	
-	template<typename T1, int ...S1>
+	template<typename T1, std::size_t ...S1>
 	constexpr explicit Vector(T1 s, std::index_sequence<S1...>) : VectorBase<T, N>(s + (0 * S1)...) {}
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr explicit Vector(T1 s) : Vector(s, std::make_index_sequence<N>()) {}
 
-	template<typename T1, std::size_t N1, int ...S1, typename... Args>
+	template<typename T1, std::size_t N1, std::size_t ...S1, typename... Args>
 	constexpr explicit Vector(const Vector<T1, N1> &v, std::index_sequence<S1...>, Args... args) : VectorBase<T, N>(v[S1]..., args...) {}
 	template<typename T1, std::size_t N1, typename... Args, typename = std::enable_if_t<(N1 < N) && sizeof...(Args) == (N - N1)>>
 	constexpr explicit Vector(const Vector<T1, N1> &v, Args... args) : Vector(v, std::make_index_sequence<N1>(), args...) {}
 
-	template<typename T1, typename T2, std::size_t N1, std::size_t N2, int ...S1, int ...S2>
+	template<typename T1, typename T2, std::size_t N1, std::size_t N2, std::size_t ...S1, std::size_t ...S2>
 	constexpr Vector(const Vector<T1, N1> &v1, const Vector<T2, N2> &v2, std::index_sequence<S1...>, std::index_sequence<S2...>) : VectorBase<T, N>(v1[S1]..., v2[S2]...) {}
 	template<typename T1, typename T2, std::size_t N1, std::size_t N2, typename = std::enable_if_t<N1 + N2 == N>>
 	constexpr Vector(const Vector<T1, N1> &v1, const Vector<T2, N2> &v2) : Vector(v1, v2, std::make_index_sequence<N1>(), std::make_index_sequence<N2>()) {}
 
-	template<typename T1, std::size_t N1, int ...S1, int ...S2>
+	template<typename T1, std::size_t N1, std::size_t ...S1, std::size_t ...S2>
 	constexpr explicit Vector(const Vector<T1, N1> &v, std::index_sequence<S1...>, std::index_sequence<S2...>) : VectorBase<T, N>(v[S1]..., (0 * S2)...) {}
 	template<typename T1, std::size_t N1, typename = std::enable_if_t<(N1 < N)>>
 	constexpr explicit Vector(const Vector<T1, N1> &v) : Vector(v, std::make_index_sequence<N1>(), std::make_index_sequence<N - N1>()) {} // Vector(v, Vector<T1, N - N1>())
 
-	//template<typename T1, std::size_t N1, int ...S1>
+	//template<typename T1, std::size_t N1, std::size_t ...S1>
 	//constexpr explicit Vector(const Vector<T1, N1> &v, std::index_sequence<S1...>) : VectorBase<T, N>(v[S1]...) {}
 	//template<typename T1, std::size_t N1, typename = std::enable_if_t<N1 >= N>>
 	//constexpr explicit Vector(const Vector<T1, N1> &v) : Vector(v, std::make_index_sequence<N>()) {}
@@ -112,14 +115,14 @@ public:
 	auto end() { return &at(0) + N; }
 	auto end() const { return &at(0) + N; }
 
-	template<typename = std::enable_if_t<N >= 2>>
+	template<std::size_t N1 = N, typename = std::enable_if_t<N1 >= 2>>
 	constexpr const Vector<T, 2> &xy() const { return *reinterpret_cast<const Vector<T, 2> *>(this); }
-	template<typename = std::enable_if_t<N >= 2>>
+	template<std::size_t N1 = N, typename = std::enable_if_t<N1 >= 2>>
 	constexpr Vector<T, 2> &xy() { return *reinterpret_cast<Vector<T, 2> *>(this); }
 	
-	template<typename = std::enable_if_t<N >= 3>>
+	template<std::size_t N1 = N, typename = std::enable_if_t<N1 >= 3>>
 	constexpr const Vector<T, 3> &xyz() const { return *reinterpret_cast<const Vector<T, 3> *>(this); }
-	template<typename = std::enable_if_t<N >= 3>>
+	template<std::size_t N1 = N, typename = std::enable_if_t<N1 >= 3>>
 	constexpr Vector<T, 3> &xyz() { return *reinterpret_cast<Vector<T, 3> *>(this); }
 
 	template<std::size_t ...I>
@@ -150,7 +153,8 @@ public:
 	 * @return The length.
 	 */
 	auto Length() const {
-		return std::sqrt(Length2());
+		using std::sqrt;
+		return sqrt(Length2());
 	}
 
 	/**
@@ -161,12 +165,32 @@ public:
 		return *this / Length();
 	}
 
+	/**
+	 * Gets the length of this vector using Maths::Fast::Sqrt.
+	 * @tparam P The precision.
+	 * @return The length.
+	 */
+	template<Maths::Precision P = Maths::Precision::Medium>
+	auto LengthFast() const {
+		return Maths::Fast::Sqrt<P>(Length2());
+	}
+
+	/**
+	 * Gets the unit vector of this vector, multiplying by Maths::Fast::Rsqrt instead of dividing by the length.
+	 * @tparam P The precision.
+	 * @return The normalized vector.
+	 */
+	template<Maths::Precision P = Maths::Precision::Medium>
+	auto NormalizeFast() const {
+		return *this * Maths::Fast::Rsqrt<P>(Length2());
+	}
+
 	/**
 	 * Calculates the cross product of the this vector and another vector.
 	 * @param other The other vector.
 	 * @return The cross product.
 	 */
-	template<typename = std::enable_if_t<N == 2 || N == 3>>
+	template<std::size_t N1 = N, typename = std::enable_if_t<N1 == 2 || N1 == 3>>
 	constexpr auto Cross(const Vector &other) const {
 		if constexpr (N == 2) {
 			return at(0) * other[1] - at(1) * other[0];
@@ -193,6 +217,17 @@ public:
 		return (other - *this).Length();
 	}
 
+	/**
+	 * Gets the distance between this vector and another vector using Maths::Fast::Sqrt.
+	 * @tparam P The precision.
+	 * @param other The other vector.
+	 * @return The distance.
+	 */
+	template<Maths::Precision P = Maths::Precision::Medium>
+	auto DistanceFast(const Vector &other) const {
+		return (other - *this).template LengthFast<P>();
+	}
+
 	/**
 	 * Gets the vector distance between this vector and another vector.
 	 * @param other The other vector.
@@ -208,8 +243,9 @@ public:
 	 * @return The angle, in radians.
 	 */
 	T Uangle(const Vector &other) const {
+		using std::acos;
 		const T d = Dot(other);
-		return d > 1 ? 0 : std::acos(d < -1 ? -1 : d);
+		return d > 1 ? 0 : acos(d < -1 ? -1 : d);
 	}
 	
 	/**
@@ -221,6 +257,28 @@ public:
 		return Normalize().Uangle(other.Normalize());
 	}
 
+	/**
+	 * Calculates the angle between this vector and another vector using Maths::Fast::Acos.
+	 * @tparam P The precision.
+	 * @param other The other vector.
+	 * @return The angle, in radians.
+	 */
+	template<Maths::Precision P = Maths::Precision::Medium>
+	T UangleFast(const Vector &other) const {
+		return Maths::Fast::Acos<P>(std::clamp<T>(Dot(other), -1, 1));
+	}
+
+	/**
+	 * Calculates the normalized angle between this vector and another vector, normalizing with Maths::Fast::Rsqrt first.
+	 * @tparam P The precision.
+	 * @param other The other vector.
+	 * @return The angle, in radians.
+	 */
+	template<Maths::Precision P = Maths::Precision::Medium>
+	T AngleFast(const Vector &other) const {
+		return NormalizeFast<P>().template UangleFast<P>(other.template NormalizeFast<P>());
+	}
+
 	template<typename T1>
 	constexpr auto Lerp(const Vector &other, T1 c) const {
 		return *this * (1 - c) + other * c;
@@ -233,8 +291,25 @@ public:
 	
 	template<typename T1, typename T2>
 	T Slerp(const Vector<T1, N> &other, T2 t) const {
+		using std::sin;
 		T th = Uangle(other);
-		return th == 0 ? *this : *this * (std::sin(th * (1 - t)) / std::sin(th)) + other * (std::sin(th * t) / std::sin(th));
+		return th == 0 ? *this : *this * (sin(th * (1 - t)) / sin(th)) + other * (sin(th * t) / sin(th));
+	}
+
+	/**
+	 * Calculates the spherical interpolation between this unit vector and another using Maths::Fast.
+	 * @tparam P The precision.
+	 * @param other The other unit vector.
+	 * @param t The progression.
+	 * @return The interpolated vector.
+	 */
+	template<Maths::Precision P = Maths::Precision::Medium, typename T2>
+	Vector SlerpFast(const Vector &other, T2 t) const {
+		T th = UangleFast<P>(other);
+		if (th == 0)
+			return *this;
+		auto invSin = 1 / Maths::Fast::Sin<P>(th);
+		return *this * (Maths::Fast::Sin<P>(th * (1 - t)) * invSin) + other * (Maths::Fast::Sin<P>(th * t) * invSin);
 	}
 
 	/**
@@ -242,9 +317,10 @@ public:
 	 * @return The absolute value of this vector.
 	 */
 	Vector Abs() const {
+		using std::abs;
 		Vector result;
 		for (std::size_t i = 0; i < N; i++)
-			result[i] = std::abs(at(i));
+			result[i] = abs(at(i));
 		return result;
 	}
 	
@@ -279,11 +355,11 @@ public:
 	 * @return The lowest vector.
 	 */
 	template<typename T1>
-	constexpr auto Min(const Vector<T1, N> &other) {
+	constexpr auto Min(const Vector<T1, N> &other) const {
 		using THighestP = decltype(at(0) + other[0]);
 		Vector<THighestP, N> result;
 		for (std::size_t i = 0; i < N; i++)
-			result[i] = std::min<THighestP>(at(i), other[1]);
+			result[i] = std::min<THighestP>(at(i), other[i]);
 		return result;
 	}
 	
@@ -294,11 +370,11 @@ public:
 	 * @return The maximum vector.
 	 */
 	template<typename T1>
-	constexpr auto Max(const Vector<T1, N> &other) {
+	constexpr auto Max(const Vector<T1, N> &other) const {
 		using THighestP = decltype(at(0) + other[0]);
 		Vector<THighestP, N> result;
 		for (std::size_t i = 0; i < N; i++)
-			result[i] = std::max<THighestP>(at(i), other[1]);
+			result[i] = std::max<THighestP>(at(i), other[i]);
 		return result;
 	}
 
@@ -308,10 +384,18 @@ public:
 	 * @param a The angle to rotate by, in radians.
 	 * @return The rotated vector.
 	 */
-	template<typename T1, typename = std::enable_if_t<N == 2>>
+	template<typename T1, std::size_t N1 = N, typename = std::enable_if_t<N1 == 2>>
 	Vector Rotate(T1 a) const {
-		const auto s = std::sin(a);
-		const auto c = std::cos(a);
+		using std::sin, std::cos;
+		const auto s = sin(a);
+		const auto c = cos(a);
+		return {at(0) * c - at(1) * s, at(0) * s + at(1) * c};
+	}
+
+	template<Maths::Precision P = Maths::Precision::Medium, typename T1, std::size_t N1 = N, typename = std::enable_if_t<N1 == 2>>
+	Vector RotateFast(T1 a) const {
+		T s, c;
+		Maths::Fast::SinCos<P>(static_cast<T>(a), s, c);
 		return {at(0) * c - at(1) * s, at(0) * s + at(1) * c};
 	}
 
@@ -322,7 +406,7 @@ public:
 	 * @param v3 The third triangle vertex.
 	 * @return If this vector is in a triangle.
 	 */
-	template<typename = std::enable_if_t<N == 2>>
+	template<std::size_t N1 = N, typename = std::enable_if_t<N1 == 2>>
 	constexpr bool InTriangle(const Vector &v1, const Vector &v2, const Vector &v3) const {
 		auto b1 = ((at(0) - v2[0]) * (v1[1] - v2[1]) - (v1[0] - v2[1]) * (at(1) - v2[1])) < 0;
 		auto b2 = ((at(0) - v3[0]) * (v2[1] - v3[1]) - (v2[0] - v3[1]) * (at(1) - v3[1])) < 0;
@@ -334,7 +418,7 @@ public:
 	 * Converts from rectangular to spherical coordinates, this vector is in cartesian (x, y).
 	 * @return The polar coordinates (radius, theta).
 	 */
-	template<typename = std::enable_if_t<N == 2 || N == 3>>
+	template<std::size_t N1 = N, typename = std::enable_if_t<N1 == 2 || N1 == 3>>
 	auto CartesianToPolar() const {
 		if constexpr (N == 2) {
 			auto radius = std::sqrt(at(0) * at(0) + at(1) * at(1));
@@ -352,11 +436,11 @@ public:
 	 * Converts from spherical to rectangular coordinates, this vector is in polar (radius, theta).
 	 * @return The cartesian coordinates (x, y).
 	 */
-	template<typename = std::enable_if_t<N == 2 || N == 3>>
+	template<std::size_t N1 = N, typename = std::enable_if_t<N1 == 2 || N1 == 3>>
 	auto PolarToCartesian() const {
 		if constexpr (N == 2) {
 			auto x1 = at(0) * std::cos(at(1));
-			auto y1 = at(0) * std::sin(at(0));
+			auto y1 = at(0) * std::sin(at(1));
 			return Vector<decltype(x1), N>(x1, y1);
 		} else if constexpr (N == 3) {
 			auto x1 = at(0) * std::sin(at(2)) * std::cos(at(1));
@@ -366,10 +450,105 @@ public:
 		}
 	}
 
+	/**
+	 * Converts from rectangular to spherical coordinates using Maths::Fast, this vector is in cartesian (x, y).
+	 * @tparam P The precision.
+	 * @return The polar coordinates (radius, theta).
+	 */
+	template<Maths::Precision P = Maths::Precision::Medium, std::size_t N1 = N, typename = std::enable_if_t<N1 == 2 || N1 == 3>>
+	Vector CartesianToPolarFast() const {
+		auto planar = at(0) * at(0) + at(1) * at(1);
+		if constexpr (N == 2) {
+			return {Maths::Fast::Sqrt<P>(planar), Maths::Fast::Atan2<P>(at(1), at(0))};
+		} else if constexpr (N == 3) {
+			return {Maths::Fast::Sqrt<P>(planar + at(2) * at(2)), Maths::Fast::Atan2<P>(at(1), at(0)), Maths::Fast::Atan2<P>(Maths::Fast::Sqrt<P>(planar), at(2))};
+		}
+	}
+
+	/**
+	 * Converts from spherical to rectangular coordinates using Maths::Fast, this vector is in polar (radius, theta).
+	 * @tparam P The precision.
+	 * @return The cartesian coordinates (x, y).
+	 */
+	template<Maths::Precision P = Maths::Precision::Medium, std::size_t N1 = N, typename = std::enable_if_t<N1 == 2 || N1 == 3>>
+	Vector PolarToCartesianFast() const {
+		T sinTheta, cosTheta;
+		Maths::Fast::SinCos<P>(at(1), sinTheta, cosTheta);
+		if constexpr (N == 2) {
+			return {at(0) * cosTheta, at(0) * sinTheta};
+		} else if constexpr (N == 3) {
+			T sinPhi, cosPhi;
+			Maths::Fast::SinCos<P>(at(2), sinPhi, cosPhi);
+			return {at(0) * sinPhi * cosTheta, at(0) * sinPhi * sinTheta, at(0) * cosPhi};
+		}
+	}
+
+	/**
+	 * Converts many vectors from rectangular to spherical coordinates, as CartesianToPolar does for one.
+	 * Vectors are split into component arrays a block at a time so the Maths::Fast kernels vectorize.
+	 * Radii match the scalar results exactly and angles are within 2 ulp of pi of them.
+	 * @param cartesian The cartesian coordinates.
+	 * @param polar The polar coordinates, the same size as cartesian, it may be the same memory.
+	 */
+	template<std::size_t N1 = N, typename = std::enable_if_t<(N1 == 2 || N1 == 3) && std::is_floating_point_v<T>>>
+	static void CartesianToPolar(Span<const Vector> cartesian, Span<Vector> polar) {
+		ForEachBlock(cartesian, polar, [](T (&values)[N][BatchBlock]) {
+			T radius[BatchBlock], planar[BatchBlock];
+			for (std::size_t i = 0; i < BatchBlock; i++) {
+				planar[i] = values[0][i] * values[0][i] + values[1][i] * values[1][i];
+				radius[i] = planar[i];
+				if constexpr (N == 3)
+					radius[i] += values[2][i] * values[2][i];
+			}
+			BlockSqrt(radius);
+			if constexpr (N == 3) {
+				BlockSqrt(planar);
+				for (std::size_t i = 0; i < BatchBlock; i++)
+					values[2][i] = Maths::Fast::Atan2<Maths::Precision::High>(planar[i], values[2][i]);
+			}
+			for (std::size_t i = 0; i < BatchBlock; i++) {
+				values[1][i] = Maths::Fast::Atan2<Maths::Precision::High>(values[1][i], values[0][i]);
+				values[0][i] = radius[i];
+			}
+		});
+	}
+
+	/**
+	 * Converts many vectors from spherical to rectangular coordinates, as PolarToCartesian does for one.
+	 * Components are within 2 ulp of the radius of the scalar results.
+	 * @param polar The polar coordinates.
+	 * @param cartesian The cartesian coordinates, the same size as polar, it may be the same memory.
+	 */
+	template<std::size_t N1 = N, typename = std::enable_if_t<(N1 == 2 || N1 == 3) && std::is_floating_point_v<T>>>
+	static void PolarToCartesian(Span<const Vector> polar, Span<Vector> cartesian) {
+		ForEachBlock(polar, cartesian, [](T (&values)[N][BatchBlock]) {
+			// One SinCos per loop, two in the same loop stop it inlining and so stop the loop vectorizing.
+			T sinTheta[BatchBlock], cosTheta[BatchBlock];
+			for (std::size_t i = 0; i < BatchBlock; i++)
+				Maths::Fast::SinCos<Maths::Precision::High>(values[1][i], sinTheta[i], cosTheta[i]);
+			if constexpr (N == 2) {
+				for (std::size_t i = 0; i < BatchBlock; i++) {
+					values[1][i] = values[0][i] * sinTheta[i];
+					values[0][i] = values[0][i] * cosTheta[i];
+				}
+			} else {
+				for (std::size_t i = 0; i < BatchBlock; i++) {
+					T sinPhi, cosPhi;
+					Maths::Fast::SinCos<Maths::Precision::High>(values[2][i], sinPhi, cosPhi);
+					auto radius = values[0][i];
+					values[0][i] = radius * sinPhi * cosTheta[i];
+					values[1][i] = radius * sinPhi * sinTheta[i];
+					values[2][i] = radius * cosPhi;
+				}
+			}
+		});
+	}
+
 	template<typename T1>
 	constexpr friend auto operator==(const Vector &lhs, const Vector<T1, N> &rhs) {
+		using std::abs;
 		for (std::size_t i = 0; i < N; i++) {
-			if (std::abs(lhs[i] - rhs[i]) > 0.0001f)
+			if (abs(lhs[i] - rhs[i]) > 0.0001f)
 				return false;
 		}
 		return true;
@@ -377,8 +556,9 @@ public:
 
 	template<typename T1>
 	constexpr friend auto operator!=(const Vector &lhs, const Vector<T1, N> &rhs) {
+		using std::abs;
 		for (std::size_t i = 0; i < N; i++) {
-			if (std::abs(lhs[i] - rhs[i]) <= 0.0001f)
+			if (abs(lhs[i] - rhs[i]) <= 0.0001f)
 				return true;
 		}
 		return false;
@@ -398,7 +578,7 @@ public:
 		return result;
 	}
 
-	template<typename = std::enable_if_t<std::is_integral_v<T>>>
+	template<typename T1 = T, typename = std::enable_if_t<std::is_integral_v<T1>>>
 	constexpr friend auto operator~(const Vector &lhs) {
 		Vector result;
 		for (std::size_t i = 0; i < N; i++)
@@ -406,7 +586,7 @@ public:
 		return result;
 	}
 
-	template<typename = std::enable_if_t<std::is_integral_v<T>>>
+	template<typename T1 = T, typename = std::enable_if_t<std::is_integral_v<T1>>>
 	constexpr friend auto operator!(const Vector &lhs) {
 		Vector result;
 		for (std::size_t i = 0; i < N; i++)
@@ -494,7 +674,7 @@ public:
 		return result;
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator*(const Vector &lhs, T1 rhs) {
 		Vector<decltype(lhs[0] * rhs), N> result;
 		for (std::size_t i = 0; i < N; i++)
@@ -502,7 +682,7 @@ public:
 		return result;
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator/(const Vector &lhs, T1 rhs) {
 		Vector<decltype(lhs[0] / rhs), N> result;
 		for (std::size_t i = 0; i < N; i++)
@@ -558,7 +738,7 @@ public:
 		return result;
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator*(T1 lhs, const Vector &rhs) {
 		Vector<decltype(lhs *rhs[0]), N> result;
 		for (std::size_t i = 0; i < N; i++)
@@ -566,7 +746,7 @@ public:
 		return result;
 	}
 
-	template<typename T1, typename = std::enable_if_t<std::is_arithmetic_v<T1>>>
+	template<typename T1, typename = std::enable_if_t<is_number_v<T1>>>
 	constexpr friend auto operator/(T1 lhs, const Vector &rhs) {
 		Vector<decltype(lhs / rhs[0]), N> result;
 		for (std::size_t i = 0; i < N; i++)
@@ -687,6 +867,61 @@ public:
 	static const Vector Down;
 	static const Vector Front;
 	static const Vector Back;
+
+private:
+	/// Vectors converted per pass of the component array kernels, small enough for the arrays to stay on the stack.
+	static constexpr std::size_t BatchBlock = 64;
+	/// A whole number of blocks, so only the last chunk runs a partial block.
+	static constexpr std::size_t BatchGrain = 1 << 14;
+
+	/**
+	 * Runs a kernel over component arrays, copying each block of vectors in and out. Lanes past the end of the input
+	 * keep values from earlier blocks, so kernels always run over whole blocks. The arrays live outside the
+	 * block loop, declaring them inside left kernel loops in a shape GCC would not vectorize.
+	 */
+	template<typename Kernel>
+	static void ForEachBlock(Span<const Vector> input, Span<Vector> output, Kernel &&kernel) {
+		Parallel::For(0, input.size(), BatchGrain, [&](std::size_t begin, std::size_t end) {
+			T values[N][BatchBlock]{};
+			for (auto block = begin; block < end; block += BatchBlock) {
+				auto count = std::min(BatchBlock, end - block);
+				for (std::size_t i = 0; i < count; i++) {
+					for (std::size_t j = 0; j < N; j++)
+						values[j][i] = input[block + i][j];
+				}
+				kernel(values);
+				for (std::size_t i = 0; i < count; i++) {
+					for (std::size_t j = 0; j < N; j++)
+						output[block + i][j] = values[j][i];
+				}
+			}
+		});
+	}
+
+	/**
+	 * Takes the square root of a block in place, with packed instructions where std::sqrt would stay scalar to set errno.
+	 */
+	static void BlockSqrt(T (&values)[BatchBlock]) {
+#ifdef MATHSCPP_SSE2
+		if constexpr (std::is_same_v<T, float>) {
+			for (std::size_t i = 0; i < BatchBlock; i += 4)
+				_mm_storeu_ps(values + i, _mm_sqrt_ps(_mm_loadu_ps(values + i)));
+			return;
+		} else if constexpr (std::is_same_v<T, double>) {
+			for (std::size_t i = 0; i < BatchBlock; i += 2)
+				_mm_storeu_pd(values + i, _mm_sqrt_pd(_mm_loadu_pd(values + i)));
+			return;
+		}
+#endif
+		for (auto &value : values)
+			value = std::sqrt(value);
+	}
+};
+
+template<typename T, std::size_t N>
+struct ArrayTraits<Vector<T, N>> {
+	using Value = T;
+	static constexpr std::size_t Count = N;
 };
 
 template<typename T, std::size_t N>
@@ -717,26 +952,26 @@ using Vector2f = Vector<float, 2>;
 using Vector2d = Vector<double, 2>;
 using Vector2i = Vector<int32_t, 2>;
 using Vector2ui = Vector<uint32_t, 2>;
+using Vector2h = Vector<Half, 2>;
 
 using Vector3f = Vector<float, 3>;
 using Vector3d = Vector<double, 3>;
 using Vector3i = Vector<int32_t, 3>;
 using Vector3ui = Vector<uint32_t, 3>;
+using Vector3h = Vector<Half, 3>;
 
 using Vector4f = Vector<float, 4>;
 using Vector4d = Vector<double, 4>;
 using Vector4i = Vector<int32_t, 4>;
 using Vector4ui = Vector<uint32_t, 4>;
+using Vector4h = Vector<Half, 4>;
 }
 
 namespace std {
 template<typename T, size_t N>
 struct hash<MathsCPP::Vector<T, N>> {
 	size_t operator()(const MathsCPP::Vector<T, N> &vector) const noexcept {
-		size_t seed = 0;
-		for (size_t i = 0; i < N; i++)
-			MathsCPP::Maths::HashCombine(seed, vector[i]);
-		return seed;
+		return static_cast<size_t>(MathsCPP::Maths::HashValues<T, N>(vector.begin()));
 	}
 };
 }
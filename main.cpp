@@ -1,4 +1,7 @@
-﻿#include <iostream>
+﻿#include <bitset>
+#include <iostream>
+#include <random>
+#include <sstream>
 
 #include "Logger.hpp"
 #include "Vector.hpp"
@@ -7,6 +10,21 @@
 #include "Quaternion.hpp"
 #include "Rectangle.hpp"
 #include "Duration.hpp"
+#include "QuadTree.hpp"
+#include "RectanglePacker.hpp"
+#include "SweepAndPrune.hpp"
+#include "BVH.hpp"
+#include "KDTree.hpp"
+#include "SpatialHashGrid.hpp"
+#include "Mesh.hpp"
+#include "Expression.hpp"
+#include "Fixed.hpp"
+#include "Skinning.hpp"
+#include "TransformHierarchy.hpp"
+#include "AffineMatrix.hpp"
+#include "Decomposition.hpp"
+#include "SparseMatrix.hpp"
+#include "Reduce.hpp"
 
 int main(int argc, char *argv[]) {
 	using namespace MathsCPP;
@@ -32,6 +50,809 @@ int main(int argc, char *argv[]) {
 
 		auto right = Vector<double, 3>::Right;
 	}
+	{
+		std::mt19937 random(1);
+		std::uniform_int_distribution<int32_t> side(4, 64);
+		std::vector<Vector2i> sizes(100000);
+		for (auto &size : sizes)
+			size = Vector2i(side(random), side(random));
+
+		RectanglePacker packer(Vector2i(4096, 4096), 1, true, 16);
+		auto start = Duration<Microseconds>::Now();
+		auto placements = packer.Insert(sizes);
+		auto elapsed = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Packed ", placements.size(), " rectangles into ", packer.GetPageCount(), " pages, occupancy ", packer.GetOccupancy(), " in ",
+			elapsed.Cast<Milliseconds, float>(), "ms");
+
+		// Empty sizes are rejected, and a rectangle the size of the page fits because its padding would fall past the edge.
+		RectanglePacker edge(Vector2i(64, 64), 2);
+		auto empty = edge.Insert(Vector2i(0, 5));
+		auto negative = edge.Insert(Vector2i(-1, 3));
+		auto full = edge.Insert(Vector2i(64, 64));
+		WRITE_DEBUG("Packer edges: empty ", empty.has_value(), ", negative ", negative.has_value(), ", full page ", full.has_value(), ", then full ",
+			edge.Insert(Vector2i(1, 1)).has_value());
+	}
+	{
+		// A rolling heightfield viewed from above one edge, traced one ray at a time and in packets of eight.
+		const int32_t grid = 256, width = 512, height = 512;
+		auto heightAt = [](int32_t x, int32_t y) { return 4.0f * std::sin(x * 0.05f) * std::cos(y * 0.07f); };
+		std::vector<Vector3f> vertices;
+		for (int32_t y = 0; y < grid; y++) {
+			for (int32_t x = 0; x < grid; x++) {
+				Vector3f a(x, heightAt(x, y), y), b(x + 1, heightAt(x + 1, y), y), c(x, heightAt(x, y + 1), y + 1), d(x + 1, heightAt(x + 1, y + 1), y + 1);
+				vertices.insert(vertices.end(), {a, b, c, b, d, c});
+			}
+		}
+
+		auto start = Duration<Microseconds>::Now();
+		MeshBVHf mesh(vertices);
+		auto elapsed = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Built BVH over ", mesh.GetTriangleCount(), " triangles in ", elapsed.Cast<Milliseconds, float>(), "ms");
+
+		Vector3f eye(grid / 2.0f, 60.0f, -20.0f);
+		auto direction = [&](int32_t x, int32_t y) { return Vector3f((x - width / 2) / float(width), -0.3f + (y - height / 2) / float(height) * 0.6f, 1.0f); };
+		std::size_t hits = 0;
+		start = Duration<Microseconds>::Now();
+		for (int32_t y = 0; y < height; y++) {
+			for (int32_t x = 0; x < width; x++)
+				hits += mesh.Raycast(Rayf(eye, direction(x, y))).has_value();
+		}
+		elapsed = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Single rays: ", width * height / elapsed.Cast<Microseconds, float>(), " Mrays/s, ", hits, " hits");
+
+		hits = 0;
+		start = Duration<Microseconds>::Now();
+		for (int32_t y = 0; y < height; y += 2) {
+			for (int32_t x = 0; x < width; x += 4) {
+				RayPacket8f packet;
+				for (int32_t k = 0; k < 8; k++)
+					packet.Set(k, Rayf(eye, direction(x + (k & 3), y + (k >> 2))));
+				auto packetHits = mesh.Raycast(packet);
+				for (auto triangle : packetHits.triangle)
+					hits += triangle != MeshBVHf::Invalid;
+			}
+		}
+		elapsed = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Packets of 8: ", width * height / elapsed.Cast<Microseconds, float>(), " Mrays/s, ", hits, " hits");
+	}
+	{
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> position(-200.0f, 200.0f), extent(0.0f, 5.0f);
+		AABBArray3f boxes;
+		boxes.Reserve(1 << 20);
+		for (std::size_t i = 0; i < 1 << 20; i++) {
+			Vector3f center(position(random), position(random), position(random)), half(extent(random), extent(random), extent(random));
+			boxes.Add(AABB3f(center - half, center + half));
+		}
+
+		auto frustum = Frustumf::FromMatrix(Matrix4x4f::PerspectiveMatrix(1.2f, 1.5f, 0.5f, 150.0f));
+		std::vector<uint64_t> visible(boxes.GetMaskSize());
+		auto start = Duration<Microseconds>::Now();
+		frustum.Intersects(boxes, visible);
+		auto elapsed = Duration<Microseconds>::Now() - start;
+		std::size_t count = 0;
+		for (auto word : visible)
+			count += std::bitset<64>(word).count();
+		WRITE_DEBUG("Culled ", boxes.size(), " boxes to ", count, " in ", elapsed.Cast<Milliseconds, float>(), "ms");
+	}
+	{
+		// Particles are reordered by cell after the first build, as a simulation would between frames.
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> position(0.0f, 100.0f);
+		std::vector<Vector3f> particles(1 << 20);
+		for (auto &particle : particles)
+			particle = Vector3f(position(random), position(random), position(random));
+
+		SpatialHashGrid3f grid(2.0f);
+		grid.Build(particles);
+		std::vector<Vector3f> reordered(particles.size());
+		for (std::size_t i = 0; i < particles.size(); i++)
+			reordered[i] = particles[grid.GetOrder()[i]];
+
+		auto start = Duration<Microseconds>::Now();
+		grid.Build(reordered);
+		auto elapsed = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Hashed ", grid.size(), " particles into ", grid.GetCellCount(), " cells in ", elapsed.Cast<Milliseconds, float>(), "ms");
+	}
+	{
+		// Integer grid coordinates are the worst case for per element combining, compare against it for speed and bucket spread.
+		std::vector<Vector3f> keys;
+		for (int32_t z = 0; z < 128; z++) {
+			for (int32_t y = 0; y < 128; y++) {
+				for (int32_t x = 0; x < 64; x++)
+					keys.emplace_back(x, y, z);
+			}
+		}
+		auto combine = [](const Vector3f &key) {
+			std::size_t seed = 0;
+			for (auto value : key)
+				Maths::HashCombine(seed, value);
+			return seed;
+		};
+		auto measure = [&](const char *name, auto &&hash) {
+			const std::size_t buckets = std::size_t(1) << 20;
+			std::vector<uint8_t> used(buckets);
+			std::size_t sum = 0, occupied = 0;
+			auto start = Duration<Microseconds>::Now();
+			for (const auto &key : keys)
+				sum += hash(key);
+			auto elapsed = Duration<Microseconds>::Now() - start;
+			for (const auto &key : keys)
+				occupied += !std::exchange(used[hash(key) & (buckets - 1)], 1);
+			// Uniform hashing fills 1 - e^(-n/m) of the buckets.
+			auto expected = buckets * (1.0 - std::exp(-double(keys.size()) / buckets));
+			WRITE_DEBUG(name, ": ", keys.size() / elapsed.Cast<Microseconds, float>(), " Mhash/s, ", occupied, " of ", std::size_t(expected),
+				" expected buckets used (", sum % 10, ")");
+		};
+		measure("HashCombine Vector3f", combine);
+		measure("std::hash Vector3f", std::hash<Vector3f>());
+
+		std::vector<Matrix4x4f> matrices(1 << 18, Matrix4x4f(1.0f));
+		for (std::size_t i = 0; i < matrices.size(); i++)
+			matrices[i][3] = Vector4f(float(i % 64), float(i / 64 % 64), float(i / 4096), 1.0f);
+		std::size_t sum = 0;
+		auto start = Duration<Microseconds>::Now();
+		for (const auto &matrix : matrices)
+			sum += std::hash<Matrix4x4f>()(matrix);
+		auto elapsed = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("std::hash Matrix4x4f: ", matrices.size() / elapsed.Cast<Microseconds, float>(), " Mhash/s (", sum % 10, ")");
+	}
+	{
+		// A triangle soup over a 1024x1024 heightfield, each interior grid vertex is shared by six triangles.
+		const uint32_t size = 1024;
+		auto height = [](uint32_t x, uint32_t y) { return std::sin(x * 0.05f) * std::cos(y * 0.05f); };
+		std::vector<Vector3f> soup;
+		soup.reserve(std::size_t(size - 1) * (size - 1) * 6);
+		for (uint32_t y = 0; y + 1 < size; y++) {
+			for (uint32_t x = 0; x + 1 < size; x++) {
+				for (auto [dx, dy] : {std::pair(0, 0), {1, 0}, {0, 1}, {1, 0}, {1, 1}, {0, 1}})
+					soup.emplace_back(float(x + dx), float(y + dy), height(x + dx, y + dy));
+			}
+		}
+
+		auto start = Duration<Microseconds>::Now();
+		auto remap = Mesh::WeldVertices(soup, 1e-4f);
+		auto elapsed = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Welded ", soup.size(), " vertices to ", *std::max_element(remap.begin(), remap.end()) + 1, " in ", elapsed.Cast<Milliseconds, float>(), "ms");
+	}
+	{
+		// Feature vectors small enough to stay in cache, so the cost is the temporaries rather than memory.
+		using Feature = Vector<float, 64>;
+		std::vector<Feature> a(256, Feature(1.0f)), b(256, Feature(2.0f)), c(256, Feature(0.5f)), result(256);
+		auto measure = [&](const char *name, auto &&func) {
+			auto start = Duration<Microseconds>::Now();
+			for (uint32_t repeat = 0; repeat < 1000; repeat++) {
+				for (std::size_t i = 0; i < result.size(); i++)
+					result[i] = func(i);
+			}
+			auto elapsed = Duration<Microseconds>::Now() - start;
+			WRITE_DEBUG(name, " a * s + b - c: ", elapsed.Cast<Milliseconds, float>(), "ms (", result[0][0], ")");
+		};
+		measure("Eager", [&](std::size_t i) { return a[i] * 2.0f + b[i] - c[i]; });
+		measure("Lazy", [&](std::size_t i) { return Feature(Lazy(a[i]) * 2.0f + b[i] - c[i]); });
+	}
+	{
+		// Each row gives nanoseconds per value and the largest error against the standard library, relative for rsqrt.
+		using P = Maths::Precision;
+		std::vector<float> angles(1 << 20), ratios(1 << 20), positives(1 << 20), results(1 << 20);
+		for (std::size_t i = 0; i < angles.size(); i++) {
+			angles[i] = -100.0f + 200.0f * i / angles.size();
+			ratios[i] = -1.0f + 2.0f * i / ratios.size();
+			positives[i] = 1e-3f + 1e3f * i / positives.size();
+		}
+		auto measure = [&](const std::vector<float> &inputs, auto &&func, auto &&reference, bool relative) {
+			auto start = Duration<Microseconds>::Now();
+			for (std::size_t i = 0; i < inputs.size(); i++)
+				results[i] = func(inputs[i]);
+			auto elapsed = Duration<Microseconds>::Now() - start;
+			double error = 0;
+			for (std::size_t i = 0; i < inputs.size(); i++) {
+				double expected = reference(double(inputs[i]));
+				error = std::max(error, std::abs(results[i] - expected) / (relative ? expected : 1.0));
+			}
+			std::ostringstream cell;
+			cell << std::setprecision(3) << 1000.0f * elapsed.Cast<Microseconds, float>() / inputs.size() << "ns " << error;
+			return cell.str();
+		};
+		auto row = [&](const char *name, const std::vector<float> &inputs, auto &&reference, bool relative, auto &&standard, auto &&low, auto &&medium, auto &&high) {
+			WRITE_DEBUG(std::setw(6), name, " | std ", measure(inputs, standard, reference, relative), " | Low ", measure(inputs, low, reference, relative),
+				" | Medium ", measure(inputs, medium, reference, relative), " | High ", measure(inputs, high, reference, relative));
+		};
+		row("rsqrt", positives, [](double x) { return 1 / std::sqrt(x); }, true, [](float x) { return 1 / std::sqrt(x); },
+			[](float x) { return Maths::Fast::Rsqrt<P::Low>(x); }, [](float x) { return Maths::Fast::Rsqrt<P::Medium>(x); },
+			[](float x) { return Maths::Fast::Rsqrt<P::High>(x); });
+		row("sin", angles, [](double x) { return std::sin(x); }, false, [](float x) { return std::sin(x); },
+			[](float x) { return Maths::Fast::Sin<P::Low>(x); }, [](float x) { return Maths::Fast::Sin<P::Medium>(x); },
+			[](float x) { return Maths::Fast::Sin<P::High>(x); });
+		row("cos", angles, [](double x) { return std::cos(x); }, false, [](float x) { return std::cos(x); },
+			[](float x) { return Maths::Fast::Cos<P::Low>(x); }, [](float x) { return Maths::Fast::Cos<P::Medium>(x); },
+			[](float x) { return Maths::Fast::Cos<P::High>(x); });
+		row("atan2", angles, [](double x) { return std::atan2(x, 0.5); }, false, [](float x) { return std::atan2(x, 0.5f); },
+			[](float x) { return Maths::Fast::Atan2<P::Low>(x, 0.5f); }, [](float x) { return Maths::Fast::Atan2<P::Medium>(x, 0.5f); },
+			[](float x) { return Maths::Fast::Atan2<P::High>(x, 0.5f); });
+		row("acos", ratios, [](double x) { return std::acos(x); }, false, [](float x) { return std::acos(x); },
+			[](float x) { return Maths::Fast::Acos<P::Low>(x); }, [](float x) { return Maths::Fast::Acos<P::Medium>(x); },
+			[](float x) { return Maths::Fast::Acos<P::High>(x); });
+	}
+	{
+		// Radar style samples, converted one vector at a time and then as a batch.
+		std::mt19937 random(2);
+		std::uniform_real_distribution<float> coordinate(-1000.0f, 1000.0f);
+		std::vector<Vector3f> samples(1 << 22), polar(samples.size()), cartesian(samples.size());
+		for (auto &sample : samples)
+			sample = Vector3f(coordinate(random), coordinate(random), coordinate(random));
+
+		auto start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < samples.size(); i++)
+			polar[i] = samples[i].CartesianToPolar();
+		for (std::size_t i = 0; i < samples.size(); i++)
+			cartesian[i] = polar[i].PolarToCartesian();
+		auto scalar = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		Vector3f::CartesianToPolar(samples, polar);
+		Vector3f::PolarToCartesian(polar, cartesian);
+		auto batch = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Polar round trip of ", samples.size(), " samples: scalar ", scalar.Cast<Milliseconds, float>(), "ms, batch ",
+			batch.Cast<Milliseconds, float>(), "ms (", cartesian[0], " vs ", samples[0], ")");
+	}
+	{
+		// Double precision positions narrowed for upload, one vector at a time and then through copy_cast.
+		std::vector<Vector3d> positions(1 << 22);
+		for (std::size_t i = 0; i < positions.size(); i++)
+			positions[i] = Vector3d(i * 0.25, -0.5 * i, 1.0 / (i + 1));
+		std::vector<Vector3f> narrowed(positions.size());
+		std::vector<uint16_t> halves(positions.size() * 3);
+
+		auto start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < positions.size(); i++)
+			narrowed[i] = Vector3f(positions[i]);
+		auto scalar = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		copy_cast(Span<const Vector3d>(positions), Span<Vector3f>(narrowed));
+		auto packed = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		Maths::PackHalf(&narrowed[0][0], halves.data(), halves.size());
+		Maths::UnpackHalf(halves.data(), &narrowed[0][0], halves.size());
+		auto half = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Narrowing ", positions.size(), " vectors: scalar ", scalar.Cast<Milliseconds, float>(), "ms, copy_cast ",
+			packed.Cast<Milliseconds, float>(), "ms, half round trip ", half.Cast<Milliseconds, float>(), "ms (", narrowed[1], ")");
+	}
+	{
+		// Normals kept in half precision take half the memory, arrays of them pack and unpack in one pass.
+		std::vector<Vector3f> normals(1 << 22);
+		for (std::size_t i = 0; i < normals.size(); i++)
+			normals[i] = Vector3f(std::cos(i * 0.001f), std::sin(i * 0.001f), 0.5f).Normalize();
+		std::vector<Vector3h> halves(normals.size());
+		std::vector<Vector<BFloat16, 3>> bfloats(normals.size());
+		std::vector<Vector3f> unpacked(normals.size());
+
+		auto start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < normals.size(); i++)
+			halves[i] = normals[i];
+		auto scalar = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		copy_cast(Span<const Vector3f>(normals), Span<Vector3h>(halves));
+		copy_cast(Span<const Vector3h>(halves), Span<Vector3f>(unpacked));
+		auto half = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		copy_cast(Span<const Vector3f>(normals), Span<Vector<BFloat16, 3>>(bfloats));
+		copy_cast(Span<const Vector<BFloat16, 3>>(bfloats), Span<Vector3f>(unpacked));
+		auto bfloat = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Packing ", normals.size(), " normals: scalar half ", scalar.Cast<Milliseconds, float>(), "ms, half round trip ",
+			half.Cast<Milliseconds, float>(), "ms, bfloat16 round trip ", bfloat.Cast<Milliseconds, float>(), "ms (", halves[1000], " dot ",
+			halves[1000].Dot(halves[2000]), ")");
+	}
+	{
+		// Fixed point angles give the same sines on every machine, the batch runs them four at a time.
+		std::vector<Fixed16x16> angles(1 << 22);
+		for (std::size_t i = 0; i < angles.size(); i++)
+			angles[i] = Fixed16x16::FromRaw(static_cast<int32_t>(i * 2654435761u) >> 10);
+		std::vector<Fixed16x16> sines(angles.size()), cosines(angles.size());
+		std::vector<float> floats(angles.size()), floatSines(angles.size());
+		for (std::size_t i = 0; i < angles.size(); i++)
+			floats[i] = static_cast<float>(angles[i]);
+
+		auto start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < angles.size(); i++) {
+			sines[i] = sin(angles[i]);
+			cosines[i] = cos(angles[i]);
+		}
+		auto scalar = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		Fixed16x16::SinCos(angles, sines, cosines);
+		auto batch = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < floats.size(); i++)
+			floatSines[i] = std::sin(floats[i]) + std::cos(floats[i]);
+		auto single = Duration<Microseconds>::Now() - start;
+		Vector<Fixed16x16, 3> direction(3, 4, 12);
+		// Sums past the range wrap, 30000 + 5000 is 35000 - 65536, and negating the lowest value gives it back.
+		auto lowest = std::numeric_limits<Fixed16x16>::lowest();
+		auto wrapped = Fixed16x16(30000) + Fixed16x16(5000);
+		WRITE_DEBUG("Fixed wrapping: 30000 + 5000 = ", wrapped, ", -lowest == lowest ", -lowest == lowest, ", lowest - 1 = ", lowest - Fixed16x16(1),
+			", 40000 = ", Fixed16x16(40000), ", 1e10 = ", Fixed16x16(1e10));
+		WRITE_DEBUG("Fixed sin and cos of ", angles.size(), " angles: scalar ", scalar.Cast<Milliseconds, float>(), "ms, batch ",
+			batch.Cast<Milliseconds, float>(), "ms, float ", single.Cast<Milliseconds, float>(), "ms (", sines[1], " vs ", std::sin(floats[1]),
+			", direction ", direction.Normalize(), ")");
+	}
+	{
+		// A million vertices with four influences each, blending bone matrices per vertex and then through the skinning kernels.
+		std::vector<DualQuaternionf> bones(64);
+		std::vector<Matrix<float, 4, 4>> matrices(bones.size());
+		for (std::size_t b = 0; b < bones.size(); b++) {
+			bones[b] = DualQuaternionf(Quaternionf(Vector3f(0.1f * b, 0.02f * b, -0.05f * b)), Vector3f(0.0f, 0.1f * b, 0.0f));
+			matrices[b] = bones[b].ToMatrix();
+		}
+		VertexStreamsf bindPose, skinned;
+		SkinWeights<float, 4> weights;
+		bindPose.Reserve(1 << 20);
+		weights.Reserve(1 << 20);
+		for (uint32_t i = 0; i < (1 << 20); i++) {
+			auto bone = static_cast<uint16_t>(i % 61);
+			bindPose.Add(Vector3f(std::cos(i * 0.001f), 0.0001f * i, std::sin(i * 0.001f)), Vector3f(std::cos(i * 0.001f), 0.0f, std::sin(i * 0.001f)));
+			weights.Add({bone, static_cast<uint16_t>(bone + 1), static_cast<uint16_t>(bone + 2), static_cast<uint16_t>(bone + 3)}, {0.4f, 0.3f, 0.2f, 0.1f});
+		}
+		std::vector<Vector3f> positions(bindPose.size());
+
+		auto start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < bindPose.size(); i++) {
+			Matrix<float, 4, 4> blended;
+			for (std::size_t j = 0; j < 4; j++)
+				blended = blended + matrices[weights.bones[j][i]] * weights.weights[j][i];
+			positions[i] = blended * bindPose.GetPosition(i);
+		}
+		auto scalar = Duration<Microseconds>::Now() - start;
+		skinned.Resize(bindPose.size());
+		start = Duration<Microseconds>::Now();
+		Skinning::LinearBlend(Span<const Matrix<float, 4, 4>>(matrices), weights, bindPose, skinned);
+		auto linear = Duration<Microseconds>::Now() - start;
+		auto linearPosition = skinned.GetPosition(1000);
+		start = Duration<Microseconds>::Now();
+		Skinning::DualQuaternionBlend(Span<const DualQuaternionf>(bones), weights, bindPose, skinned);
+		auto dual = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Skinning ", bindPose.size(), " vertices: scalar matrices ", scalar.Cast<Milliseconds, float>(), "ms, linear blend ",
+			linear.Cast<Milliseconds, float>(), "ms, dual quaternion ", dual.Cast<Milliseconds, float>(), "ms (", positions[1000], " vs ", linearPosition,
+			" vs ", skinned.GetPosition(1000), ")");
+	}
+	{
+		// Half a million nodes in groups of eight children, then one frame where every twentieth leaf turns.
+		TransformHierarchyf hierarchy;
+		hierarchy.Reserve(500000);
+		for (uint32_t i = 0; i < 500000; i++)
+			hierarchy.Add(i < 8 ? TransformHierarchyf::NoParent : i / 8 - 1, Vector3f(1.0f, 0.0f, 0.0f), Quaternionf(Vector3f(0.0f, 0.001f * i, 0.0f)));
+		auto start = Duration<Microseconds>::Now();
+		hierarchy.Update();
+		auto full = Duration<Microseconds>::Now() - start;
+		// Node i has children from 8 * (i + 1), so every node from firstLeaf on is a leaf.
+		const uint32_t firstLeaf = 500000 / 8 - 1;
+		for (uint32_t i = firstLeaf; i < hierarchy.size(); i += 20)
+			hierarchy.SetRotation(i, Quaternionf(Vector3f(0.0f, 0.002f * i, 0.0f)));
+		start = Duration<Microseconds>::Now();
+		hierarchy.Update();
+		auto partial = Duration<Microseconds>::Now() - start;
+		std::size_t changed = 0;
+		for (uint32_t i = 0; i < hierarchy.size(); i++)
+			changed += hierarchy.IsChanged(i);
+		WRITE_DEBUG("Transform hierarchy of ", hierarchy.size(), " nodes: first update ", full.Cast<Milliseconds, float>(), "ms, 5% of leaves moved ",
+			partial.Cast<Milliseconds, float>(), "ms against a 1ms target for ", changed, " changed (", hierarchy.GetWorld(499999) * Vector3f(), ")");
+	}
+	{
+		// A million transforms, built through matrix products, built directly, then split again.
+		std::vector<Vector3f> translations(1000000), scales(1000000);
+		std::vector<Quaternionf> rotations(1000000);
+		for (std::size_t i = 0; i < translations.size(); i++) {
+			translations[i] = {0.001f * i, 1.0f, -2.0f};
+			rotations[i] = Quaternionf(Vector3f(0.0001f * i, 0.0002f * i, 0.0003f * i));
+			scales[i] = {1.0f + 0.000001f * i, 2.0f, 0.5f};
+		}
+		std::vector<Matrix<float, 4, 4>> matrices(translations.size());
+		auto start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < matrices.size(); i++) {
+			Matrix<float, 4, 4> scale;
+			for (std::size_t j = 0; j < 3; j++)
+				scale[j][j] = scales[i][j];
+			scale[3][3] = 1.0f;
+			matrices[i] = rotations[i].ToRotationMatrix() * scale;
+			for (std::size_t j = 0; j < 3; j++)
+				matrices[i][j][3] = translations[i][j];
+		}
+		auto generic = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		Matrix<float, 4, 4>::FromTRS(Span<const Vector3f>(translations), Span<const Quaternionf>(rotations), Span<const Vector3f>(scales),
+			Span<Matrix<float, 4, 4>>(matrices));
+		auto fused = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < matrices.size(); i++)
+			matrices[i].Decompose(translations[i], rotations[i], scales[i]);
+		auto decompose = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		Matrix<float, 4, 4>::Decompose(Span<const Matrix<float, 4, 4>>(matrices), Span<Vector3f>(translations), Span<Quaternionf>(rotations),
+			Span<Vector3f>(scales));
+		auto batchDecompose = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("TRS ", matrices.size(), " matrices: products ", generic.Cast<Milliseconds, float>(), "ms, fused ", fused.Cast<Milliseconds, float>(),
+			"ms, decompose ", decompose.Cast<Milliseconds, float>(), "ms, batch decompose ", batchDecompose.Cast<Milliseconds, float>(), "ms (",
+			rotations[123456], ", ", scales[123456], ")");
+	}
+	{
+		// A million transforms inverted as 4x4 matrices, as affine transforms, and as rigid transforms.
+		std::vector<AffineMatrixf> affines(1000000);
+		std::vector<Matrix<float, 4, 4>> matrices(affines.size());
+		for (std::size_t i = 0; i < affines.size(); i++) {
+			affines[i] = AffineMatrixf::FromTRS(Vector3f(0.001f * i, 1.0f, -2.0f), Quaternionf(Vector3f(0.0001f * i, 0.0002f * i, 0.0003f * i)));
+			matrices[i] = affines[i].ToMatrix();
+		}
+		auto start = Duration<Microseconds>::Now();
+		for (auto &matrix : matrices)
+			matrix = matrix.Inverse();
+		auto full = Duration<Microseconds>::Now() - start;
+		std::vector<AffineMatrixf> inverses(affines.size());
+		start = Duration<Microseconds>::Now();
+		AffineMatrixf::Inverse(Span<const AffineMatrixf>(affines), Span<AffineMatrixf>(inverses));
+		auto affine = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < affines.size(); i++)
+			inverses[i] = affines[i].RigidInverse();
+		auto rigid = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Inverse of ", affines.size(), " transforms: 4x4 ", full.Cast<Milliseconds, float>(), "ms, affine ", affine.Cast<Milliseconds, float>(),
+			"ms, rigid ", rigid.Cast<Milliseconds, float>(), "ms (", matrices[123456] * Vector3f(), " vs ", inverses[123456] * Vector3f(), ")");
+	}
+	{
+		// Principal axes of a quarter million covariance matrices, one at a time and batched, then their polar decompositions.
+		std::vector<Matrix3x3f> matrices(250000), covariances(matrices.size());
+		for (std::size_t i = 0; i < matrices.size(); i++) {
+			auto f = 0.001f * i;
+			matrices[i] = Matrix3x3f(Vector3f(1.0f + std::sin(f), 0.2f, 0.1f * f), Vector3f(0.3f, 2.0f, std::cos(f)), Vector3f(0.5f, -0.4f, 0.7f));
+			covariances[i] = matrices[i].Transpose() * matrices[i];
+		}
+		std::vector<SymmetricEigen<float>> eigens(matrices.size());
+		auto start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < covariances.size(); i++)
+			eigens[i] = SymmetricEigen<float>::Compute(covariances[i]);
+		auto scalar = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		SymmetricEigen<float>::Compute(Span<const Matrix3x3f>(covariances), Span<SymmetricEigen<float>>(eigens));
+		auto batch = Duration<Microseconds>::Now() - start;
+		std::vector<SingularValueDecomposition<float>> svds(matrices.size());
+		start = Duration<Microseconds>::Now();
+		SingularValueDecomposition<float>::Compute(Span<const Matrix3x3f>(matrices), Span<SingularValueDecomposition<float>>(svds));
+		auto svd = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Eigen of ", covariances.size(), " matrices: scalar ", scalar.Cast<Milliseconds, float>(), "ms, batch ", batch.Cast<Milliseconds, float>(),
+			"ms, SVD batch ", svd.Cast<Milliseconds, float>(), "ms (", eigens[1234].values, ", ", svds[1234].GetPolarRotation(), ")");
+	}
+	{
+		// Singular inputs, where rotations that should be the identity have nothing to zero and used to collapse to zero.
+		std::vector<Matrix3x3f> singular = {
+			Matrix3x3f(),
+			Matrix3x3f(Vector3f(2.0f, 0.0f, 0.0f), Vector3f(), Vector3f()),
+			Matrix3x3f(Vector3f(-1.0f, 0.5f, 2.0f), Vector3f(-2.0f, 1.0f, 4.0f), Vector3f(-3.0f, 1.5f, 6.0f)),
+			Matrix3x3f(Vector3f(2.0f, 0.0f, 0.0f), Vector3f(0.0f, 3.0f, 0.0f), Vector3f()),
+			Matrix3x3f(Vector3f(1.0f, 2.0f, 3.0f), Vector3f(0.0f, 1.0f, 1.0f), Vector3f(1.0f, 3.0f, 4.0f))
+		};
+		std::vector<SingularValueDecomposition<float>> svds(singular.size());
+		SingularValueDecomposition<float>::Compute(Span<const Matrix3x3f>(singular), Span<SingularValueDecomposition<float>>(svds));
+		float error = 0.0f, rotation = 0.0f;
+		for (std::size_t i = 0; i < singular.size(); i++) {
+			auto rebuilt = svds[i].ToMatrix();
+			for (std::size_t j = 0; j < 3; j++) {
+				for (std::size_t k = 0; k < 3; k++)
+					error = std::max(error, std::abs(rebuilt[j][k] - singular[i][j][k]));
+			}
+			rotation = std::max(rotation, std::abs(svds[i].GetPolarRotation().Length() - 1.0f));
+		}
+		WRITE_DEBUG("SVD of zero, rank 1 and rank 2 matrices: rebuild error ", error, ", polar rotation length error ", rotation);
+	}
+	{
+		// Small dense systems as in constraint solvers, through the general inverse, one factorization at a time and batched.
+		using Matrix6x6d = Matrix<double, 6, 6>;
+		using Vector6d = Vector<double, 6>;
+		std::vector<Matrix6x6d> matrices(50000);
+		std::vector<Vector6d> vectors(matrices.size()), solutions(matrices.size());
+		for (std::size_t i = 0; i < matrices.size(); i++) {
+			for (std::size_t j = 0; j < 6; j++) {
+				for (std::size_t k = 0; k <= j; k++)
+					matrices[i][j][k] = matrices[i][k][j] = j == k ? 8.0 + std::sin(0.01 * i) : std::cos(0.1 * (i + 7 * j + k));
+				vectors[i][j] = std::sin(0.001 * i + j);
+			}
+		}
+		// One indefinite and one singular system, which the batches report as failed.
+		matrices[777][2][2] = -8.0;
+		matrices[4321] = Matrix6x6d();
+		std::unique_ptr<bool[]> valid(new bool[matrices.size()]);
+		auto start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < matrices.size(); i++)
+			solutions[i] = matrices[i].Inverse() * vectors[i];
+		auto inverse = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < matrices.size(); i++)
+			solutions[i] = Cholesky<double, 6>(matrices[i]).Solve(vectors[i]);
+		auto scalar = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		Cholesky<double, 6>::Solve(Span<const Matrix6x6d>(matrices), Span<const Vector6d>(vectors), Span<Vector6d>(solutions),
+			Span<bool>(valid.get(), matrices.size()));
+		auto batch = Duration<Microseconds>::Now() - start;
+		auto notPositiveDefinite = std::count(valid.get(), valid.get() + matrices.size(), false);
+		LDLT<double, 6>::Solve(Span<const Matrix6x6d>(matrices), Span<const Vector6d>(vectors), Span<Vector6d>(solutions),
+			Span<bool>(valid.get(), matrices.size()));
+		auto singular = std::count(valid.get(), valid.get() + matrices.size(), false);
+		start = Duration<Microseconds>::Now();
+		HouseholderQR<double, 6, 6>::Solve(Span<const Matrix6x6d>(matrices), Span<const Vector6d>(vectors), Span<Vector6d>(solutions),
+			Span<bool>(valid.get(), matrices.size()));
+		auto qr = Duration<Microseconds>::Now() - start;
+		auto rankDeficient = std::count(valid.get(), valid.get() + matrices.size(), false);
+		WRITE_DEBUG("Solve of ", matrices.size(), " 6x6 systems: inverse ", inverse.Cast<Milliseconds, float>(), "ms, Cholesky ", scalar.Cast<Milliseconds, float>(),
+			"ms, Cholesky batch ", batch.Cast<Milliseconds, float>(), "ms, QR batch ", qr.Cast<Milliseconds, float>(), "ms (", solutions[1234], ", ", notPositiveDefinite, " not positive definite, ", singular, " singular, ",
+			rankDeficient, " rank deficient)");
+	}
+	{
+		// A Poisson problem on a square grid with the five point stencil, built from unordered entries then solved.
+		const uint32_t width = 256;
+		std::vector<SparseMatrix<double>::Triplet> triplets;
+		for (uint32_t y = 0; y < width; y++) {
+			for (uint32_t x = 0; x < width; x++) {
+				auto i = y * width + x;
+				triplets.push_back({i, i, 4.0});
+				if (x > 0)
+					triplets.push_back({i, i - 1, -1.0});
+				if (x + 1 < width)
+					triplets.push_back({i, i + 1, -1.0});
+				if (y > 0)
+					triplets.push_back({i, i - width, -1.0});
+				if (y + 1 < width)
+					triplets.push_back({i, i + width, -1.0});
+			}
+		}
+		auto start = Duration<Microseconds>::Now();
+		SparseMatrix<double> poisson(width * width, width * width, triplets);
+		auto build = Duration<Microseconds>::Now() - start;
+		std::vector<double> b(poisson.GetRows(), 1.0), x(poisson.GetRows()), y(poisson.GetRows());
+		start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < 100; i++)
+			poisson.Multiply(b, y);
+		auto spmv = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		auto result = ConjugateGradient<double>::Solve(poisson, b, x, 1e-8, 5000);
+		auto solve = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Poisson with ", poisson.GetRows(), " unknowns: build ", build.Cast<Milliseconds, float>(), "ms, 100 SpMV ", spmv.Cast<Milliseconds, float>(),
+			"ms, CG ", solve.Cast<Milliseconds, float>(), "ms (", result.iterations, " iterations, residual ", result.residual, ", centre ", x[width * width / 2 + width / 2], ")");
+	}
+	{
+		// Many small loops show the cost of handing chunks to the pool, the sum is the same whatever the thread count.
+		std::vector<double> values(1 << 22);
+		for (std::size_t i = 0; i < values.size(); i++)
+			values[i] = std::sin(0.37 * i) * 1e8;
+		std::atomic<std::size_t> chunks(0);
+		auto start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < 10000; i++)
+			Parallel::For(0, 64, 1, [&](std::size_t, std::size_t) { chunks++; });
+		auto loops = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		auto sum = Parallel::Reduce(0, values.size(), 1 << 14, 0.0, [&](std::size_t begin, std::size_t end) {
+			double sum = 0;
+			for (auto i = begin; i < end; i++)
+				sum += values[i];
+			return sum;
+		}, [](double lhs, double rhs) { return lhs + rhs; });
+		auto reduce = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Parallel on ", Parallel::GetThreadCount(), " threads: 10000 loops of 64 chunks ", loops.Cast<Milliseconds, float>(), "ms, reduce of ", values.size(),
+			" values ", reduce.Cast<Milliseconds, float>(), "ms (", chunks.load(), ", ", std::setprecision(17), sum, std::setprecision(6), ")");
+	}
+	{
+		// Scene statistics over four million points far from the origin, where a running float sum loses most of its digits.
+		std::vector<Vector3f> points(1 << 22);
+		for (std::size_t i = 0; i < points.size(); i++)
+			points[i] = Vector3f(1000.0f + std::sin(0.1f * i), 0.001f * std::cos(0.3f * i), 1e6f + std::sin(0.7f * i));
+		auto start = Duration<Microseconds>::Now();
+		Vector3f running;
+		for (const auto &point : points)
+			running += point;
+		auto loop = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		auto pairwise = Reduce::Sum(Span<const Vector3f>(points));
+		auto sum = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		auto kahan = Reduce::Sum(Span<const Vector3f>(points), Summation::Kahan);
+		auto compensated = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		auto bounds = Reduce::Bounds(Span<const Vector3f>(points));
+		auto box = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		auto covariance = Reduce::Covariance(Span<const Vector3f>(points));
+		auto spread = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Reduce of ", points.size(), " points: loop ", loop.Cast<Milliseconds, float>(), "ms, sum ", sum.Cast<Milliseconds, float>(), "ms, Kahan ",
+			compensated.Cast<Milliseconds, float>(), "ms, bounds ", box.Cast<Milliseconds, float>(), "ms, covariance ", spread.Cast<Milliseconds, float>(), "ms (",
+			running / static_cast<float>(points.size()), " vs ", kahan / static_cast<float>(points.size()), ", ", pairwise[0] - kahan[0], ", ", bounds.min, ", ",
+			covariance[0][0], ")");
+	}
+	{
+		// Zero width boxes and boxes sharing an edge, pairs must match AABB::Intersects.
+		SweepAndPrune2f degenerate;
+		auto line = degenerate.Add(Rectanglef(5.0f, 5.0f, 0.0f, 2.0f));
+		auto thin = degenerate.Add(AABB2f(Vector2f(1.0f, 1.0f), Vector2f(1.0f, 2.0f)));
+		auto square = degenerate.Add(AABB2f(Vector2f(0.0f, 0.0f), Vector2f(3.0f, 3.0f)));
+		auto beside = degenerate.Add(AABB2f(Vector2f(3.0f, 0.0f), Vector2f(6.0f, 3.0f)));
+		degenerate.Update();
+		WRITE_DEBUG("Sweep and prune degenerate boxes: ", degenerate.GetPairCount(), " pairs, thin in square ", degenerate.HasPair(thin, square),
+			", line in square ", degenerate.HasPair(line, square), ", touching ", degenerate.HasPair(square, beside), " vs Intersects ",
+			degenerate.GetBox(square).Intersects(degenerate.GetBox(beside)));
+		// Removing a box twice must not free its handle twice.
+		degenerate.Remove(beside);
+		degenerate.Remove(beside);
+		degenerate.Update();
+		auto first = degenerate.Add(Rectanglef(10.0f, 10.0f, 1.0f, 1.0f));
+		auto second = degenerate.Add(Rectanglef(20.0f, 20.0f, 1.0f, 1.0f));
+		WRITE_DEBUG("Sweep and prune double remove: handles ", first, " and ", second, first != second ? " differ" : " collide");
+	}
+	{
+		// Fifty thousand bodies drifting for a second of frames at 60 Hz, only the first update sorts from scratch.
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> position(0.0f, 1000.0f), extent(0.5f, 2.0f), velocity(-0.05f, 0.05f);
+		std::vector<AABB3f> boxes(50000);
+		std::vector<Vector3f> velocities(boxes.size());
+		SweepAndPrune3f broadphase;
+		for (std::size_t i = 0; i < boxes.size(); i++) {
+			Vector3f center(position(random), position(random), position(random)), half(extent(random), extent(random), extent(random));
+			boxes[i] = AABB3f(center - half, center + half);
+			velocities[i] = Vector3f(velocity(random), velocity(random), velocity(random));
+			broadphase.Add(boxes[i]);
+		}
+		auto start = Duration<Microseconds>::Now();
+		broadphase.Update();
+		auto build = Duration<Microseconds>::Now() - start;
+		std::size_t changes = 0;
+		start = Duration<Microseconds>::Now();
+		for (std::size_t frame = 0; frame < 60; frame++) {
+			for (std::size_t i = 0; i < boxes.size(); i++) {
+				boxes[i] = AABB3f(boxes[i].min + velocities[i], boxes[i].max + velocities[i]);
+				broadphase.Move(static_cast<SweepAndPrune3f::Handle>(i), boxes[i]);
+			}
+			broadphase.Update();
+			changes += broadphase.GetAddedPairs().size() + broadphase.GetRemovedPairs().size();
+		}
+		auto frames = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("Sweep and prune of ", boxes.size(), " bodies: first update ", build.Cast<Milliseconds, float>(), "ms, ", frames.Cast<Milliseconds, float>() / 60.0f,
+			"ms per frame against a 16.7ms budget (", broadphase.GetPairCount(), " pairs, ", changes, " changes)");
+	}
+	{
+		// A million points, nearest neighbours for a hundred thousand queries one at a time and batched, checked against a linear scan.
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> position(0.0f, 100.0f);
+		std::vector<Vector3f> points(1000000), queries(100000);
+		for (auto &point : points)
+			point = Vector3f(position(random), position(random), position(random));
+		for (auto &query : queries)
+			query = Vector3f(position(random), position(random), position(random));
+		auto start = Duration<Microseconds>::Now();
+		KDTree3f tree(points);
+		auto build = Duration<Microseconds>::Now() - start;
+		constexpr std::size_t K = 8;
+		std::vector<KDTree3f::Neighbour> single(queries.size() * K), batch(queries.size() * K);
+		start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < queries.size(); i++)
+			tree.Nearest(queries[i], Span<KDTree3f::Neighbour>(single.data() + i * K, K));
+		auto nearest = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		tree.Nearest(Span<const Vector3f>(queries), K, Span<KDTree3f::Neighbour>(batch));
+		auto batched = Duration<Microseconds>::Now() - start;
+		std::size_t mismatches = 0;
+		for (std::size_t i = 0; i < queries.size(); i += 10000) {
+			uint32_t closest = 0;
+			for (uint32_t j = 1; j < points.size(); j++) {
+				if ((points[j] - queries[i]).Length2() < (points[closest] - queries[i]).Length2())
+					closest = j;
+			}
+			mismatches += single[i * K].index != closest || batch[i * K].index != closest;
+		}
+		auto inRadius = tree.Radius(Vector3f(50.0f, 50.0f, 50.0f), 5.0f).size();
+		auto inBox = tree.Query(AABB3f(Vector3f(10.0f, 10.0f, 10.0f), Vector3f(20.0f, 20.0f, 20.0f))).size();
+		WRITE_DEBUG("KDTree of ", points.size(), " points: build ", build.Cast<Milliseconds, float>(), "ms, ", queries.size(), " nearest ", K, " ",
+			nearest.Cast<Milliseconds, float>(), "ms, batched ", batched.Cast<Milliseconds, float>(), "ms (", mismatches, " mismatches, ", inRadius, " in radius, ",
+			inBox, " in box)");
+	}
+	{
+		// A hundred thousand rectangles in a loose quadtree, small region queries checked against a linear scan, then every rectangle moved.
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> position(0.0f, 10000.0f), extent(1.0f, 20.0f), step(-2.0f, 2.0f);
+		std::vector<Rectanglef> rects(100000), regions(100000);
+		std::vector<Vector2f> points(regions.size());
+		for (auto &rect : rects)
+			rect = Rectanglef(position(random), position(random), extent(random), extent(random));
+		for (std::size_t i = 0; i < regions.size(); i++) {
+			points[i] = Vector2f(position(random), position(random));
+			regions[i] = Rectanglef(points[i].x, points[i].y, 50.0f, 50.0f);
+		}
+		QuadTreef tree(Rectanglef(0.0f, 0.0f, 10000.0f, 10000.0f));
+		std::vector<QuadTreef::Handle> handles(rects.size());
+		auto start = Duration<Microseconds>::Now();
+		for (std::size_t i = 0; i < rects.size(); i++)
+			handles[i] = tree.Insert(rects[i]);
+		auto insert = Duration<Microseconds>::Now() - start;
+		std::size_t found = 0;
+		start = Duration<Microseconds>::Now();
+		for (const auto &region : regions)
+			tree.Query(region, [&](QuadTreef::Handle) { found++; });
+		auto query = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		for (const auto &point : points)
+			tree.Query(point, [&](QuadTreef::Handle) { found++; });
+		auto pointQuery = Duration<Microseconds>::Now() - start;
+		std::size_t mismatches = 0;
+		for (std::size_t i = 0; i < regions.size(); i += 1000) {
+			std::size_t expected = 0, actual = 0;
+			for (const auto &rect : rects)
+				expected += rect.Intersects(regions[i]) + rect.Contains(points[i]);
+			tree.Query(regions[i], [&](QuadTreef::Handle) { actual++; });
+			tree.Query(points[i], [&](QuadTreef::Handle) { actual++; });
+			mismatches += expected != actual;
+		}
+		start = Duration<Microseconds>::Now();
+		for (std::size_t frame = 0; frame < 10; frame++) {
+			for (std::size_t i = 0; i < rects.size(); i++) {
+				rects[i].x += step(random);
+				rects[i].y += step(random);
+				tree.Move(handles[i], rects[i]);
+			}
+		}
+		auto move = Duration<Microseconds>::Now() - start;
+		WRITE_DEBUG("QuadTree of ", rects.size(), " rectangles: insert ", insert.Cast<Milliseconds, float>(), "ms, ", 1000.0f * query.Cast<Microseconds, float>() / regions.size(),
+			"ns per region, ", 1000.0f * pointQuery.Cast<Microseconds, float>() / points.size(), "ns per point, ", 1000.0f * move.Cast<Microseconds, float>() / (10 * rects.size()), "ns per move (", found, " found, ", mismatches, " mismatches)");
+	}
+	{
+		// One rectangle against a hundred thousand, scalar tests against the batch mask and index list, which must agree.
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> position(0.0f, 1000.0f), extent(1.0f, 50.0f);
+		std::vector<Rectanglef> rects(100000), tests(1000);
+		for (auto &rect : rects)
+			rect = Rectanglef(position(random), position(random), extent(random), extent(random));
+		for (auto &test : tests)
+			test = Rectanglef(position(random), position(random), 20.0f, 20.0f);
+		RectangleArrayf array(rects);
+		std::vector<uint64_t> expected(array.GetMaskSize()), mask(array.GetMaskSize());
+		std::vector<uint32_t> indices;
+		std::size_t scalarHits = 0, maskHits = 0, compactHits = 0, mismatches = 0;
+		auto start = Duration<Microseconds>::Now();
+		for (const auto &test : tests) {
+			std::fill(expected.begin(), expected.end(), 0);
+			for (std::size_t i = 0; i < rects.size(); i++) {
+				if (rects[i].Intersects(test)) {
+					expected[i / 64] |= uint64_t(1) << (i % 64);
+					scalarHits++;
+				}
+			}
+		}
+		auto scalar = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		for (const auto &test : tests) {
+			array.Intersects(test, mask);
+			for (auto word : mask)
+				maskHits += std::bitset<64>(word).count();
+		}
+		auto masked = Duration<Microseconds>::Now() - start;
+		start = Duration<Microseconds>::Now();
+		for (const auto &test : tests) {
+			indices.clear();
+			compactHits += array.Intersects(test, indices);
+		}
+		auto compacted = Duration<Microseconds>::Now() - start;
+		// The last test's results, plus both containment tests, compared entry by entry.
+		mismatches += mask != expected;
+		for (auto index : indices)
+			mismatches += !rects[index].Intersects(tests.back());
+		Vector2f point(500.0f, 500.0f);
+		array.Contains(point, mask);
+		indices.clear();
+		array.Contains(tests[0], indices);
+		std::size_t containing = 0;
+		for (std::size_t i = 0, next = 0; i < rects.size(); i++) {
+			mismatches += rects[i].Contains(point) != (((mask[i / 64] >> (i % 64)) & 1) != 0);
+			auto contains = rects[i].Contains(tests[0]);
+			mismatches += contains != (next < indices.size() && indices[next] == i);
+			next += contains;
+			containing += contains;
+		}
+		WRITE_DEBUG("Rectangle tests of ", tests.size(), "x", rects.size(), ": scalar ", scalar.Cast<Milliseconds, float>(), "ms, mask ", masked.Cast<Milliseconds, float>(),
+			"ms, compact ", compacted.Cast<Milliseconds, float>(), "ms (", scalarHits, " vs ", maskHits, " vs ", compactHits, " hits, ", containing, " containing, ",
+			mismatches, " mismatches)");
+	}
 	/*{
 		Rectanglef ten(0, 0, 10, 10);
 	}